@@ -0,0 +1,208 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_pages) : capacity_(num_pages), frames_(num_pages) {}
+
+ARCReplacer::~ARCReplacer() = default;
+
+bool ARCReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock latch(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  // Evict from T1 while it is above its target, falling back to the other list when every frame there is pinned.
+  if (!t1_.empty() && t1_.size() > p_) {
+    return EvictFrom(&t1_, Location::EVICTED_T1, frame_id) || EvictFrom(&t2_, Location::EVICTED_T2, frame_id);
+  }
+  return EvictFrom(&t2_, Location::EVICTED_T2, frame_id) || EvictFrom(&t1_, Location::EVICTED_T1, frame_id);
+}
+
+void ARCReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    frame.evictable_ = false;
+    size_--;
+  }
+}
+
+void ARCReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  // A frame that was never reported as loaded is treated as a page seen once.
+  if (frame.location_ != Location::T1 && frame.location_ != Location::T2) {
+    MoveToFront(frame_id, Location::T1);
+  }
+  frame.evictable_ = true;
+  size_++;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  FrameInfo &frame = frames_[frame_id];
+  // A hit on a resident page, whichever list it is in, makes it frequent.
+  if (frame.location_ == Location::T1 || frame.location_ == Location::T2) {
+    MoveToFront(frame_id, Location::T2);
+  }
+}
+
+void ARCReplacer::RecordLoad(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock latch(latch_);
+  if (RemoveGhost(&b1_, page_id)) {
+    // Recently evicted from T1: recency deserves more room.
+    size_t delta = std::max<size_t>(1, b2_.size() / std::max<size_t>(1, b1_.size() + 1));
+    p_ = std::min(capacity_, p_ + delta);
+    MoveToFront(frame_id, Location::T2);
+  } else if (RemoveGhost(&b2_, page_id)) {
+    // Recently evicted from T2: frequency deserves more room.
+    size_t delta = std::max<size_t>(1, b1_.size() / std::max<size_t>(1, b2_.size() + 1));
+    p_ = p_ > delta ? p_ - delta : 0;
+    MoveToFront(frame_id, Location::T2);
+  } else {
+    MoveToFront(frame_id, Location::T1);
+  }
+}
+
+void ARCReplacer::RecordEviction(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock latch(latch_);
+  FrameInfo &frame = frames_[frame_id];
+  // The buffer pool may also evict a frame it claimed without Victim, in which case it is still on T1 or T2.
+  Location location = frame.location_;
+  Detach(frame_id);
+  if (location == Location::T1 || location == Location::EVICTED_T1) {
+    AddGhost(&b1_, page_id);
+  } else if (location == Location::T2 || location == Location::EVICTED_T2) {
+    AddGhost(&b2_, page_id);
+  }
+  if (frame.evictable_) {
+    frame.evictable_ = false;
+    size_--;
+  }
+}
+
+void ARCReplacer::EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) {
+  std::scoped_lock latch(latch_);
+  // Same preference as Victim. Evictions shift the balance between the lists, so this is an approximation.
+  std::list<frame_id_t> *first = &t2_;
+  std::list<frame_id_t> *second = &t1_;
+  if (!t1_.empty() && t1_.size() > p_) {
+    std::swap(first, second);
+  }
+  for (const auto *list : {first, second}) {
+    for (auto it = list->rbegin(); it != list->rend() && candidates->size() < max_candidates; ++it) {
+      if (frames_[*it].evictable_) {
+        candidates->push_back(*it);
+      }
+    }
+  }
+}
+
+void ARCReplacer::SetCapacity(size_t num_pages) {
+  std::scoped_lock latch(latch_);
+  if (num_pages > frames_.size()) {
+    frames_.resize(num_pages);
+  }
+  capacity_ = num_pages;
+  p_ = std::min(p_, capacity_);
+  // A smaller cache remembers fewer evicted pages.
+  while (t1_.size() + b1_.size() > capacity_ && !b1_.empty()) {
+    PopGhost(&b1_);
+  }
+  while (t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * capacity_ && !b2_.empty()) {
+    PopGhost(&b2_);
+  }
+}
+
+size_t ARCReplacer::Size() {
+  std::scoped_lock latch(latch_);
+  return size_;
+}
+
+size_t ARCReplacer::GetTarget() {
+  std::scoped_lock latch(latch_);
+  return p_;
+}
+
+void ARCReplacer::MoveToFront(frame_id_t frame_id, Location location) {
+  Detach(frame_id);
+  FrameInfo &frame = frames_[frame_id];
+  std::list<frame_id_t> &list = location == Location::T1 ? t1_ : t2_;
+  list.push_front(frame_id);
+  frame.pos_ = list.begin();
+  frame.location_ = location;
+}
+
+void ARCReplacer::Detach(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.location_ == Location::T1) {
+    t1_.erase(frame.pos_);
+  } else if (frame.location_ == Location::T2) {
+    t2_.erase(frame.pos_);
+  }
+  frame.location_ = Location::NONE;
+}
+
+bool ARCReplacer::EvictFrom(std::list<frame_id_t> *list, Location evicted_from, frame_id_t *frame_id) {
+  for (auto it = list->rbegin(); it != list->rend(); ++it) {
+    FrameInfo &frame = frames_[*it];
+    if (frame.evictable_) {
+      *frame_id = *it;
+      list->erase(std::next(it).base());
+      frame.location_ = evicted_from;
+      frame.evictable_ = false;
+      size_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ARCReplacer::AddGhost(std::list<page_id_t> *ghost, page_id_t page_id) {
+  RemoveGhost(&b1_, page_id);
+  RemoveGhost(&b2_, page_id);
+  ghost->push_front(page_id);
+  ghosts_[page_id] = {ghost, ghost->begin()};
+  // L1 = T1 + B1 holds at most c pages and L1 + L2 at most 2c, as in the paper.
+  while (t1_.size() + b1_.size() > capacity_ && !b1_.empty()) {
+    PopGhost(&b1_);
+  }
+  while (t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * capacity_ && !b2_.empty()) {
+    PopGhost(&b2_);
+  }
+}
+
+bool ARCReplacer::RemoveGhost(std::list<page_id_t> *ghost, page_id_t page_id) {
+  auto it = ghosts_.find(page_id);
+  if (it == ghosts_.end() || it->second.list_ != ghost) {
+    return false;
+  }
+  ghost->erase(it->second.pos_);
+  ghosts_.erase(it);
+  return true;
+}
+
+void ARCReplacer::PopGhost(std::list<page_id_t> *ghost) {
+  ghosts_.erase(ghost->back());
+  ghost->pop_back();
+}
+
+}  // namespace bustub
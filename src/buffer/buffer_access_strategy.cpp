@@ -0,0 +1,29 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+namespace bustub {
+
+BufferAccessStrategy::BufferAccessStrategy(size_t ring_size) : ring_(ring_size) {
+  BUSTUB_ASSERT(ring_size > 0, "a buffer access strategy needs at least one frame");
+}
+
+BufferAccessStrategy::Slot *BufferAccessStrategy::NextSlot() {
+  Slot *slot = &ring_[current_];
+  current_ = (current_ + 1) % ring_.size();
+  return slot;
+}
+
+void BufferAccessStrategy::PutBackSlot() { current_ = (current_ + ring_.size() - 1) % ring_.size(); }
+
+}  // namespace bustub
@@ -0,0 +1,1081 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
+    : num_instances_(num_instances),
+      instance_index_(instance_index),
+      chunks_(std::make_unique<std::atomic<FrameChunk *>[]>(BUFFER_POOL_MAX_CHUNKS)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
+  BUSTUB_ASSERT(pool_size > 0, "The buffer pool needs at least one frame.");
+  // The first chunk holds the whole initial pool. Chunks backed by huge pages cover whole huge pages.
+  const bool huge_pages = buffer_pool_huge_pages.load();
+  const size_t min_chunk_frames = huge_pages ? FrameArena::HUGE_PAGE_SIZE / PAGE_SIZE : 1;
+  while (chunk_frames_ < pool_size || chunk_frames_ < min_chunk_frames) {
+    chunk_frames_ <<= 1;
+    chunk_shift_++;
+  }
+  // The shards of a parallel buffer pool are spread over the NUMA nodes; a standalone pool keeps default placement.
+  const int num_nodes = FrameArena::NumNumaNodes();
+  const int numa_node = buffer_pool_numa_binding.load() && num_instances > 1 && num_nodes > 1
+                            ? static_cast<int>(instance_index % static_cast<uint32_t>(num_nodes))
+                            : -1;
+  arena_ = std::make_unique<FrameArena>(GetMaxPoolSize() * PAGE_SIZE, huge_pages, numa_node);
+  // Frames are read into and written from directly, which a disk manager doing direct I/O needs aligned.
+  BUSTUB_ASSERT(reinterpret_cast<uintptr_t>(arena_->Base()) % DIRECT_IO_ALIGNMENT == 0,
+                "Frames must be aligned for direct I/O.");
+  switch (replacer_type) {
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacerType::LRUK:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+    case ReplacerType::ARC:
+      replacer_ = new ARCReplacer(pool_size);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+  }
+  lazy_replacer_sync_ = replacer_->AllowsPinnedFrames();
+
+  // Initially, every page is in the free list.
+  ResizePool(pool_size);
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopPageCleaner();
+  StopPrefetcher();
+  for (size_t c = 0; c < num_chunks_; ++c) {
+    FrameChunk *chunk = chunks_[c].load();
+    for (size_t i = 0; i < chunk_frames_; ++i) {
+      chunk->pages_[i].~Page();
+    }
+    ::operator delete(chunk->pages_);
+    delete chunk;
+  }
+  delete replacer_;
+}
+
+bool BufferPoolManagerInstance::ResizePool(size_t pool_size) {
+  if (pool_size == 0 || pool_size > GetMaxPoolSize()) {
+    return false;
+  }
+  StagedPageCompressor compressor(this);
+  std::scoped_lock latch(latch_);
+  const size_t old_size = pool_size_.load();
+  if (pool_size >= old_size) {
+    // Everything indexed by frame id must be large enough before the first new frame becomes reachable.
+    while (num_chunks_ * chunk_frames_ < pool_size) {
+      AddChunk();
+    }
+    page_table_.Reserve(pool_size);
+    {
+      std::scoped_lock guard(replacer_latch_);
+      replacer_->SetCapacity(pool_size);
+    }
+    pool_size_ = pool_size;
+    for (size_t i = old_size; i < pool_size; ++i) {
+      auto frame_id = static_cast<frame_id_t>(i);
+      if (Released(frame_id)) {
+        Released(frame_id) = false;
+        free_list_.push_back(frame_id);
+      } else {
+        // A frame that was retiring when the pool shrank is simply back in use.
+        retiring_frames_--;
+        SyncReplacer(frame_id);
+      }
+    }
+    return true;
+  }
+
+  // Shrinking: from here on SyncReplacer keeps the frames above the new size out of the replacer.
+  pool_size_ = pool_size;
+  {
+    std::scoped_lock guard(replacer_latch_);
+    replacer_->SetCapacity(pool_size);
+  }
+  for (size_t i = pool_size; i < old_size; ++i) {
+    retiring_frames_++;
+  }
+  for (auto it = free_list_.begin(); it != free_list_.end();) {
+    if (static_cast<size_t>(*it) >= pool_size) {
+      ReleaseFrame(*it);
+      it = free_list_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ReleaseRetiringFrames();
+  return true;
+}
+
+size_t BufferPoolManagerInstance::GetFramesInUse() {
+  std::scoped_lock latch(latch_);
+  return pool_size_.load() + retiring_frames_;
+}
+
+void BufferPoolManagerInstance::AddChunk() {
+  auto *chunk = new FrameChunk();
+  chunk->data_ = arena_->Commit(num_chunks_ * chunk_frames_ * PAGE_SIZE, chunk_frames_ * PAGE_SIZE);
+  chunk->pages_ = static_cast<Page *>(::operator new(chunk_frames_ * sizeof(Page)));
+  chunk->cleaned_ = std::make_unique<std::atomic<bool>[]>(chunk_frames_);
+  chunk->released_ = std::make_unique<bool[]>(chunk_frames_);
+  for (size_t i = 0; i < chunk_frames_; ++i) {
+    new (&chunk->pages_[i]) Page(chunk->data_ + i * PAGE_SIZE);
+    chunk->pages_[i].pin_count_ = -1;
+    chunk->cleaned_[i] = false;
+    chunk->released_[i] = true;
+  }
+  chunks_[num_chunks_].store(chunk, std::memory_order_release);
+  num_chunks_++;
+}
+
+bool BufferPoolManagerInstance::TryReleaseFrame(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) < pool_size_.load() || Released(frame_id)) {
+    return false;
+  }
+  int unpinned = 0;
+  if (!Frame(frame_id)->pin_count_.compare_exchange_strong(unpinned, -1)) {
+    return false;
+  }
+  SyncReplacer(frame_id);
+  EvictFrame(frame_id);
+  ReleaseFrame(frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::ReleaseRetiringFrames() {
+  const size_t num_frames = num_chunks_ * chunk_frames_;
+  for (size_t i = pool_size_.load(); retiring_frames_ > 0 && i < num_frames; ++i) {
+    TryReleaseFrame(static_cast<frame_id_t>(i));
+  }
+}
+
+void BufferPoolManagerInstance::ReleaseFrame(frame_id_t frame_id) {
+  Page *page = Frame(frame_id);
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  Cleaned(frame_id) = false;
+  // The mapping stays, so the data pointer stays valid; the next write to it faults in a zeroed page.
+  arena_->Discard(page->GetData(), PAGE_SIZE);
+  Released(frame_id) = true;
+  retiring_frames_--;
+}
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id) { return FetchPageImpl(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it immediately.
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first.
+  // 2.     If R is dirty, write it back to the disk.
+  // 3.     Delete R from the page table and insert P.
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  // Hits are only timed now and then; everything else is timed from here on.
+  BufferPoolStats::TimePoint hit_start = stats_.StartTimer(true);
+  frame_id_t frame_id;
+  bool resident = page_table_.Find(page_id, &frame_id);
+  if (resident && TryPin(frame_id, page_id)) {
+    replacer_->RecordAccess(frame_id);
+    stats_.Add(BufferPoolStats::Counter::HIT);
+    stats_.Record(BufferPoolStats::Latency::FETCH_HIT, hit_start);
+    return Frame(frame_id);
+  }
+  if (resident) {
+    // The frame is being loaded or evicted; the pin has to wait for the latch holder.
+    stats_.Add(BufferPoolStats::Counter::PIN_WAIT);
+  }
+  BufferPoolStats::TimePoint start = hit_start == BufferPoolStats::TimePoint() ? stats_.StartTimer(false) : hit_start;
+
+  StagedPageCompressor compressor(this);
+  std::unique_lock<std::mutex> latch(latch_);
+  ValidatePageId(page_id);
+  if (PinResident(&latch, page_id, &frame_id)) {
+    replacer_->RecordAccess(frame_id);
+    stats_.Add(BufferPoolStats::Counter::HIT);
+    stats_.Record(BufferPoolStats::Latency::FETCH_HIT, hit_start);
+    return Frame(frame_id);
+  }
+
+  std::unique_lock<std::mutex> ring_latch;
+  BufferAccessStrategy::Slot *slot = NextRingSlot(strategy, &ring_latch);
+  if (!GetFreeFrame(slot, &frame_id)) {
+    return nullptr;
+  }
+  if (slot != nullptr) {
+    *slot = {this, frame_id, page_id};
+  }
+
+  if (!LoadFrame(frame_id, page_id)) {
+    return nullptr;
+  }
+  // Publishing the pin count makes the frame visible to lock-free readers.
+  Frame(frame_id)->pin_count_ = 1;
+  if (lazy_replacer_sync_) {
+    SyncReplacer(frame_id);
+  }
+  stats_.Add(BufferPoolStats::Counter::MISS);
+  stats_.Record(BufferPoolStats::Latency::FETCH_MISS, start);
+  return Frame(frame_id);
+}
+
+std::vector<Page *> BufferPoolManagerInstance::FetchPagesImpl(const std::vector<page_id_t> &page_ids) {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  // Positions in page_ids ordered by page id, so that the occurrences of a page are next to each other.
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  auto is_repeat = [&](size_t i) { return i > 0 && page_ids[order[i]] == page_ids[order[i - 1]]; };
+
+  // Pin the resident pages without the latch, the way a FetchPage hit does.
+  std::vector<size_t> misses;
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (is_repeat(i)) {
+      continue;
+    }
+    frame_id_t frame_id;
+    if (page_table_.Find(page_ids[order[i]], &frame_id) && TryPin(frame_id, page_ids[order[i]])) {
+      replacer_->RecordAccess(frame_id);
+      stats_.Add(BufferPoolStats::Counter::HIT);
+      pages[order[i]] = Frame(frame_id);
+    } else {
+      misses.push_back(order[i]);
+    }
+  }
+
+  if (!misses.empty()) {
+    StagedPageCompressor compressor(this);
+    std::unique_lock<std::mutex> latch(latch_);
+    while (!misses.empty()) {
+      std::vector<std::pair<frame_id_t, page_id_t>> loads;
+      std::vector<size_t> load_indexes;
+      // Pages another batch is loading. They are waited for once this batch is loaded, so that two batches never wait
+      // for each other's frames.
+      std::vector<size_t> loading;
+      for (size_t index : misses) {
+        page_id_t page_id = page_ids[index];
+        ValidatePageId(page_id);
+        frame_id_t frame_id;
+        if (page_table_.Find(page_id, &frame_id)) {
+          if (TryPin(frame_id, page_id)) {
+            replacer_->RecordAccess(frame_id);
+            stats_.Add(BufferPoolStats::Counter::HIT);
+            pages[index] = Frame(frame_id);
+          } else {
+            loading.push_back(index);
+          }
+          continue;
+        }
+        if (!GetFreeFrame(nullptr, &frame_id)) {
+          break;
+        }
+        loads.emplace_back(frame_id, page_id);
+        load_indexes.push_back(index);
+      }
+      std::vector<bool> loaded = LoadFrames(&latch, loads, 1);
+      for (size_t i = 0; i < loads.size(); ++i) {
+        if (loaded[i]) {
+          stats_.Add(BufferPoolStats::Counter::MISS);
+          pages[load_indexes[i]] = Frame(loads[i].first);
+        }
+      }
+      // A page another batch was loading goes round again if that load failed, or if the page was evicted again
+      // before this batch got to pin it. A page this batch failed to load, or found no frame for, is left nullptr.
+      misses.clear();
+      for (size_t index : loading) {
+        frame_id_t frame_id;
+        if (PinResident(&latch, page_ids[index], &frame_id)) {
+          replacer_->RecordAccess(frame_id);
+          stats_.Add(BufferPoolStats::Counter::HIT);
+          pages[index] = Frame(frame_id);
+        } else {
+          misses.push_back(index);
+        }
+      }
+    }
+  }
+
+  // Repeated ids share the frame of their first occurrence, which is pinned already, and take a pin of their own.
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (is_repeat(i) && pages[order[i - 1]] != nullptr) {
+      pages[order[i]] = pages[order[i - 1]];
+      pages[order[i]]->pin_count_++;
+    }
+  }
+  return pages;
+}
+
+bool BufferPoolManagerInstance::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    // A lock-free lookup can miss while the table is being modified; the latched one is exact.
+    std::scoped_lock latch(latch_);
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+  }
+
+  Page *page = Frame(frame_id);
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+    // The dirty flag must be visible before the frame can become a victim.
+    if (is_dirty) {
+      page->is_dirty_ = true;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+
+  if (pin_count == 1) {
+    PinTransition(frame_id);
+    if (static_cast<size_t>(frame_id) >= pool_size_.load()) {
+      // The last pin of a frame a shrink could not release is gone.
+      StagedPageCompressor compressor(this);
+      std::scoped_lock latch(latch_);
+      TryReleaseFrame(frame_id);
+    }
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::FlushPageImpl(page_id_t page_id) {
+  // Make sure you call DiskManager::WritePage!
+  frame_id_t frame_id;
+  {
+    std::scoped_lock latch(latch_);
+    if (page_id == INVALID_PAGE_ID || !page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+    if (!PinForFlush(frame_id)) {
+      // The frame is being loaded, so the page on disk is the current one.
+      return true;
+    }
+  }
+  // The page is written from a copy taken under its read latch, as a writer may hold a pin meanwhile. The copy is
+  // taken without latch_, since a latch holder may be waiting for latch_.
+  alignas(DIRECT_IO_ALIGNMENT) char copy[PAGE_SIZE];
+  bool dirty;
+  if (!CopyForFlush(frame_id, copy, &dirty)) {
+    UnpinForFlush(frame_id);
+    return false;
+  }
+  disk_manager_->WritePage(page_id, copy);
+  UnpinForFlush(frame_id);
+  return true;
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id) {
+  return NewPageImpl(page_id, nullptr, INVALID_PAGE_ID);
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) {
+  // 0.   Make sure you call AllocatePage!
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  // 3.   Update P's metadata, zero out memory and add P to the page table.
+  // 4.   Set the page ID output parameter. Return a pointer to P.
+  BufferPoolStats::TimePoint start = stats_.StartTimer(false);
+  StagedPageCompressor compressor(this);
+  std::scoped_lock latch(latch_);
+  frame_id_t free_frame;
+  std::unique_lock<std::mutex> ring_latch;
+  BufferAccessStrategy::Slot *slot = NextRingSlot(strategy, &ring_latch);
+  if (!GetFreeFrame(slot, &free_frame)) {
+    return nullptr;
+  }
+  *page_id = AllocatePage(hint);
+  if (slot != nullptr) {
+    *slot = {this, free_frame, *page_id};
+  }
+
+  Page *victim_page = Frame(free_frame);
+  victim_page->ResetMemory();
+  victim_page->page_id_ = *page_id;
+  victim_page->is_dirty_ = true;
+  replacer_->RecordLoad(free_frame, *page_id);
+  page_table_.Insert(*page_id, free_frame);
+  victim_page->pin_count_ = 1;
+  if (lazy_replacer_sync_) {
+    SyncReplacer(free_frame);
+  }
+  stats_.Record(BufferPoolStats::Latency::NEW_PAGE, start);
+  return victim_page;
+}
+
+bool BufferPoolManagerInstance::DeletePageImpl(page_id_t page_id) {
+  // 0.   Make sure you call DiskManager::DeallocatePage!
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  std::scoped_lock latch(latch_);
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->Erase(page_id);
+  }
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    disk_manager_->DeallocatePage(page_id);
+    return true;
+  }
+
+  // Claiming the frame fails if somebody holds a pin, including one taken without the latch.
+  Page *page = Frame(frame_id);
+  int unpinned = 0;
+  if (!page->pin_count_.compare_exchange_strong(unpinned, -1)) {
+    return false;
+  }
+
+  disk_manager_->DeallocatePage(page_id);
+  page_table_.Remove(page_id);
+  SyncReplacer(frame_id);
+  FreeFrame(frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::FreeFrame(frame_id_t frame_id) {
+  Page *page = Frame(frame_id);
+  page->ResetMemory();
+  page->is_dirty_ = false;
+  page->page_id_ = INVALID_PAGE_ID;
+  Cleaned(frame_id) = false;
+  if (static_cast<size_t>(frame_id) >= pool_size_.load()) {
+    ReleaseFrame(frame_id);
+  } else {
+    free_list_.push_back(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::FlushAllPagesImpl() {
+  // A pin keeps each dirty frame from being evicted until the batch is on disk. As in FlushPage, the pages are
+  // copied under their read latch, without latch_.
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty;
+  {
+    std::scoped_lock latch(latch_);
+    page_table_.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+      if (Frame(frame_id)->IsDirty() && PinForFlush(frame_id)) {
+        dirty.emplace_back(page_id, frame_id);
+      }
+    });
+  }
+  std::unique_ptr<char, decltype(&std::free)> copies(
+      static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, std::max<size_t>(dirty.size(), 1) * PAGE_SIZE)),
+      &std::free);
+  std::vector<std::pair<page_id_t, char *>> writes;
+  for (const auto &[page_id, frame_id] : dirty) {
+    char *copy = copies.get() + writes.size() * PAGE_SIZE;
+    bool is_dirty;
+    // A write-latched page stays dirty, for the next flush or its eviction to write.
+    if (CopyForFlush(frame_id, copy, &is_dirty) && is_dirty) {
+      writes.emplace_back(page_id, copy);
+    }
+  }
+  disk_manager_->WritePages(&writes);
+  for (const auto &[page_id, frame_id] : dirty) {
+    UnpinForFlush(frame_id);
+  }
+}
+
+bool BufferPoolManagerInstance::PinResident(std::unique_lock<std::mutex> *latch, page_id_t page_id,
+                                            frame_id_t *frame_id) {
+  // Under latch_, a frame in the page table only fails to pin while a batch load of its page is in flight.
+  while (page_table_.Find(page_id, frame_id)) {
+    if (TryPin(*frame_id, page_id)) {
+      return true;
+    }
+    load_cv_.wait(*latch);
+  }
+  return false;
+}
+
+bool BufferPoolManagerInstance::TryPin(frame_id_t frame_id, page_id_t page_id) {
+  Page *page = Frame(frame_id);
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+
+  // Holding a pin keeps the frame from being recycled, so page_id_ is stable from here on.
+  if (page->page_id_ != page_id) {
+    if (page->pin_count_.fetch_sub(1) == 1) {
+      PinTransition(frame_id);
+    }
+    return false;
+  }
+  if (pin_count == 0) {
+    PinTransition(frame_id);
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::SyncReplacer(frame_id_t frame_id) {
+  // Pin counts change without the latch, so a later transition may overtake an earlier one. Reading the current
+  // pin count under replacer_latch_ means the last sync after the last transition always leaves the right state.
+  std::scoped_lock guard(replacer_latch_);
+  int pin_count = Frame(frame_id)->pin_count_.load();
+  bool evictable = lazy_replacer_sync_ ? pin_count >= 0 : pin_count == 0;
+  if (evictable && static_cast<size_t>(frame_id) < pool_size_.load()) {
+    replacer_->Unpin(frame_id);
+  } else {
+    replacer_->Pin(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::PinTransition(frame_id_t frame_id) {
+  if (!lazy_replacer_sync_) {
+    SyncReplacer(frame_id);
+  }
+}
+
+bool BufferPoolManagerInstance::GetFreeFrame(BufferAccessStrategy::Slot *slot, frame_id_t *frame_id) {
+  // Frames that retired while pinned are released as soon as they are unpinned; catch the ones whose last pin was
+  // dropped without going through UnpinPage.
+  if (retiring_frames_ > 0) {
+    ReleaseRetiringFrames();
+  }
+
+  // Recycle the ring frame if it still holds the page the strategy put there and nobody has it pinned. Frames only
+  // change pages under latch_, so the page id check cannot race.
+  if (slot != nullptr && HoldsRingPage(*slot)) {
+    int unpinned = 0;
+    if (Frame(slot->frame_id_)->pin_count_.compare_exchange_strong(unpinned, -1)) {
+      SyncReplacer(slot->frame_id_);
+      EvictFrame(slot->frame_id_);
+      *frame_id = slot->frame_id_;
+      return true;
+    }
+  }
+
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+
+  frame_id_t victim;
+  bool claimed = false;
+  {
+    std::scoped_lock guard(replacer_latch_);
+    // Pinned victims the search passed over. With a lazy replacer sync they go back in once the search is over, so
+    // that it still ends when every frame is pinned.
+    std::vector<frame_id_t> skipped;
+    while (!claimed && replacer_->Victim(&victim)) {
+      // A retiring frame is released by TryReleaseFrame once it is unpinned.
+      if (static_cast<size_t>(victim) >= pool_size_.load()) {
+        continue;
+      }
+      // A victim can have been pinned without the latch since it last became evictable. Such a frame is skipped;
+      // with an eager replacer sync, SyncReplacer hands it back to the replacer once it is unpinned again.
+      int unpinned = 0;
+      claimed = Frame(victim)->pin_count_.compare_exchange_strong(unpinned, -1);
+      if (!claimed && lazy_replacer_sync_) {
+        skipped.push_back(victim);
+      }
+    }
+    for (frame_id_t frame_id : skipped) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+  if (!claimed) {
+    return false;
+  }
+
+  EvictFrame(victim);
+  *frame_id = victim;
+  return true;
+}
+
+BufferAccessStrategy::Slot *BufferPoolManagerInstance::NextRingSlot(BufferAccessStrategy *strategy,
+                                                                  std::unique_lock<std::mutex> *ring_latch) {
+  if (strategy == nullptr) {
+    return nullptr;
+  }
+  *ring_latch = std::unique_lock<std::mutex>(strategy->latch_);
+  return strategy->NextSlot();
+}
+
+bool BufferPoolManagerInstance::HoldsRingPage(const BufferAccessStrategy::Slot &slot) const {
+  return slot.owner_ == this && static_cast<size_t>(slot.frame_id_) < pool_size_.load() &&
+         Frame(slot.frame_id_)->page_id_ == slot.page_id_;
+}
+
+bool BufferPoolManagerInstance::LoadFrame(frame_id_t frame_id, page_id_t page_id) {
+  Page *page = Frame(frame_id);
+  page->ResetMemory();
+  page->is_dirty_ = false;
+  page->page_id_ = page_id;
+  if (!TakeFromCompressedTier(page_id, page->GetData()) && !disk_manager_->ReadPage(page_id, page->GetData())) {
+    FreeFrame(frame_id);
+    return false;
+  }
+  replacer_->RecordLoad(frame_id, page_id);
+  page_table_.Insert(page_id, frame_id);
+  return true;
+}
+
+std::vector<bool> BufferPoolManagerInstance::LoadFrames(std::unique_lock<std::mutex> *latch,
+                                                        const std::vector<std::pair<frame_id_t, page_id_t>> &frames,
+                                                        int pin_count) {
+  std::vector<DiskRequest> reads;
+  // The future of the read of each frame; invalid for a frame that was taken from the compressed tier.
+  std::vector<std::future<bool>> done(frames.size());
+  reads.reserve(frames.size());
+  for (size_t i = 0; i < frames.size(); ++i) {
+    const auto &[frame_id, page_id] = frames[i];
+    Page *page = Frame(frame_id);
+    page->ResetMemory();
+    page->is_dirty_ = false;
+    page->page_id_ = page_id;
+    // The claimed frame cannot be pinned, but mapping it keeps other callers from loading the page a second time.
+    page_table_.Insert(page_id, frame_id);
+    if (!TakeFromCompressedTier(page_id, page->GetData())) {
+      reads.push_back({false, page->GetData(), page_id, DiskScheduler::CreatePromise()});
+      done[i] = reads.back().callback_.get_future();
+    }
+  }
+  if (!reads.empty()) {
+    latch->unlock();
+    GetDiskScheduler()->Schedule(&reads);
+    for (auto &read : done) {
+      if (read.valid()) {
+        read.wait();
+      }
+    }
+    latch->lock();
+  }
+  std::vector<bool> loaded(frames.size());
+  for (size_t i = 0; i < frames.size(); ++i) {
+    const auto &[frame_id, page_id] = frames[i];
+    loaded[i] = !done[i].valid() || done[i].get();
+    if (!loaded[i]) {
+      page_table_.Remove(page_id);
+      FreeFrame(frame_id);
+      continue;
+    }
+    replacer_->RecordLoad(frame_id, page_id);
+    // Publishing the pin count makes the frame visible to lock-free readers.
+    Frame(frame_id)->pin_count_ = pin_count;
+    if (pin_count == 0 || lazy_replacer_sync_) {
+      SyncReplacer(frame_id);
+    }
+  }
+  load_cv_.notify_all();
+  return loaded;
+}
+
+void BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id) {
+  Page *page = Frame(frame_id);
+  stats_.Add(BufferPoolStats::Counter::EVICTION);
+  replacer_->RecordEviction(frame_id, page->GetPageId());
+  page_table_.Remove(page->GetPageId());
+  if (page->IsDirty()) {
+    FlushFrame(frame_id);
+    sync_victim_flushes_++;
+    // The cleaner is falling behind; wake it up rather than waiting for its next round.
+    cleaner_cv_.notify_one();
+  } else if (Cleaned(frame_id)) {
+    avoided_victim_flushes_++;
+  }
+  Cleaned(frame_id) = false;
+  // Only the copy is taken under latch_; the page is compressed once the caller releases it.
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->Stage(page->GetPageId(), page->GetData());
+  }
+}
+
+void BufferPoolManagerInstance::CompressStagedPages() {
+  std::shared_ptr<CompressedPageCache> tier = std::atomic_load(&compressed_tier_);
+  if (tier != nullptr) {
+    tier->CompressStaged();
+  }
+}
+
+bool BufferPoolManagerInstance::TakeFromCompressedTier(page_id_t page_id, char *page_data) {
+  if (compressed_tier_ == nullptr || !compressed_tier_->Take(page_id, page_data)) {
+    return false;
+  }
+  stats_.Add(BufferPoolStats::Counter::COMPRESSED_HIT);
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushFrame(frame_id_t frame_id) {
+  Page *page = Frame(frame_id);
+  if (page->is_dirty_.exchange(false)) {
+    stats_.Add(BufferPoolStats::Counter::DIRTY_WRITE_BACK);
+  }
+  // The frame is claimed, so nobody can change the page while it is written, and it is written in place: the frames
+  // are aligned for direct I/O. The bytes the checksum is stamped over are put back afterwards, so that the compressed
+  // tier still gets the frame as it was.
+  char trailer[PAGE_CHECKSUM_SIZE];
+  memcpy(trailer, page->GetData() + PAGE_DATA_SIZE, PAGE_CHECKSUM_SIZE);
+  disk_manager_->WritePage(page->GetPageId(), page->GetData());
+  memcpy(page->GetData() + PAGE_DATA_SIZE, trailer, PAGE_CHECKSUM_SIZE);
+}
+
+bool BufferPoolManagerInstance::PinForFlush(frame_id_t frame_id) {
+  Page *page = Frame(frame_id);
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  return true;
+}
+
+void BufferPoolManagerInstance::UnpinForFlush(frame_id_t frame_id) {
+  // A victim search that saw our pin dropped the frame from the replacer; SyncReplacer puts it back.
+  if (Frame(frame_id)->pin_count_.fetch_sub(1) == 1) {
+    PinTransition(frame_id);
+  }
+}
+
+bool BufferPoolManagerInstance::CopyForFlush(frame_id_t frame_id, char *copy, bool *dirty) {
+  Page *page = Frame(frame_id);
+  if (!page->TryRLatch()) {
+    return false;
+  }
+  // Clear the flag first so that a concurrent writer holding a pin re-dirties the page instead of being lost.
+  *dirty = page->is_dirty_.exchange(false);
+  if (*dirty) {
+    stats_.Add(BufferPoolStats::Counter::DIRTY_WRITE_BACK);
+  }
+  memcpy(copy, page->GetData(), PAGE_SIZE);
+  page->RUnlatch();
+  return true;
+}
+
+void BufferPoolManagerInstance::RunPageCleaner(size_t clean_target) {
+  StopPageCleaner();
+  {
+    std::scoped_lock guard(cleaner_latch_);
+    cleaner_stop_ = false;
+  }
+  page_cleaner_ = std::thread(&BufferPoolManagerInstance::PageCleanerLoop, this, clean_target);
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  if (!page_cleaner_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock guard(cleaner_latch_);
+    cleaner_stop_ = true;
+  }
+  cleaner_cv_.notify_all();
+  page_cleaner_.join();
+}
+
+PageCleanerStats BufferPoolManagerInstance::GetPageCleanerStats() {
+  PageCleanerStats stats;
+  stats.pages_cleaned_ = pages_cleaned_.load();
+  stats.sync_victim_flushes_ = sync_victim_flushes_.load();
+  stats.avoided_victim_flushes_ = avoided_victim_flushes_.load();
+  return stats;
+}
+
+BufferPoolStatsSnapshot BufferPoolManagerInstance::GetStats() {
+  BufferPoolStatsSnapshot snapshot = stats_.Snapshot();
+  std::scoped_lock latch(latch_);
+  snapshot.free_list_length_ = free_list_.size();
+  if (compressed_tier_ != nullptr) {
+    snapshot.compressed_bytes_ = compressed_tier_->GetSizeBytes();
+    snapshot.compressed_pages_ = compressed_tier_->GetNumPages();
+  }
+  return snapshot;
+}
+
+void BufferPoolManagerInstance::SetCompressedTierCapacity(size_t capacity_bytes) {
+  std::scoped_lock latch(latch_);
+  if (capacity_bytes == 0) {
+    std::atomic_store(&compressed_tier_, std::shared_ptr<CompressedPageCache>());
+  } else if (compressed_tier_ == nullptr) {
+    std::atomic_store(&compressed_tier_, std::make_shared<CompressedPageCache>(capacity_bytes));
+  } else {
+    compressed_tier_->SetCapacity(capacity_bytes);
+  }
+}
+
+std::vector<page_id_t> BufferPoolManagerInstance::GetResidentPageIds() {
+  std::scoped_lock latch(latch_);
+  const auto pool_size = static_cast<frame_id_t>(pool_size_.load());
+  std::vector<page_id_t> page_ids;
+  std::vector<bool> listed(pool_size, false);
+  auto list = [&](frame_id_t frame_id) {
+    // Under latch_, a pin count of -1 only marks free and released frames, and frames that are being loaded.
+    Page *page = Frame(frame_id);
+    if (!listed[frame_id] && page->pin_count_.load() >= 0 && page->page_id_ != INVALID_PAGE_ID) {
+      page_ids.push_back(page->page_id_);
+      listed[frame_id] = true;
+    }
+  };
+
+  for (frame_id_t frame_id = 0; frame_id < pool_size; ++frame_id) {
+    if (Frame(frame_id)->pin_count_.load() > 0) {
+      list(frame_id);
+    }
+  }
+  std::vector<frame_id_t> candidates;
+  {
+    std::scoped_lock guard(replacer_latch_);
+    replacer_->EvictionCandidates(pool_size, &candidates);
+  }
+  for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+    if (*it < pool_size) {
+      list(*it);
+    }
+  }
+  // Frames the replacer does not predict, such as ring frames, go last.
+  for (frame_id_t frame_id = 0; frame_id < pool_size; ++frame_id) {
+    list(frame_id);
+  }
+  return page_ids;
+}
+
+void BufferPoolManagerInstance::ResetStats() { stats_.Reset(); }
+
+void BufferPoolManagerInstance::PageCleanerLoop(size_t clean_target) {
+  std::unique_lock<std::mutex> guard(cleaner_latch_);
+  while (!cleaner_stop_) {
+    guard.unlock();
+    CleanEvictionCandidates(clean_target);
+    guard.lock();
+    cleaner_cv_.wait_for(guard, page_cleaner_interval, [this] { return cleaner_stop_; });
+  }
+}
+
+void BufferPoolManagerInstance::CleanEvictionCandidates(size_t clean_target) {
+  std::vector<frame_id_t> candidates;
+  {
+    std::scoped_lock guard(replacer_latch_);
+    replacer_->EvictionCandidates(clean_target, &candidates);
+  }
+
+  // The pages are copied out under their read latch and written together afterwards, so that no latch is held
+  // across the write and no latch is waited for while holding another. The copies are aligned for direct I/O.
+  std::unique_ptr<char, decltype(&std::free)> copies(
+      static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, std::max<size_t>(candidates.size(), 1) * PAGE_SIZE)),
+      &std::free);
+  std::vector<std::pair<page_id_t, char *>> writes;
+  std::vector<frame_id_t> cleaned;
+  for (frame_id_t frame_id : candidates) {
+    Page *page = Frame(frame_id);
+    if (!page->IsDirty()) {
+      continue;
+    }
+    // Pin the frame so that it cannot be evicted, and reloaded from disk, before the copy is written, but bypass
+    // TryPin: the replacer must keep the frame where it is, or cleaning it would make it look recently used. A frame
+    // that is in use or owned by a latch holder is skipped.
+    int unpinned = 0;
+    if (!page->pin_count_.compare_exchange_strong(unpinned, 1)) {
+      continue;
+    }
+    char *copy = copies.get() + writes.size() * PAGE_SIZE;
+    bool dirty;
+    if (!CopyForFlush(frame_id, copy, &dirty)) {
+      UnpinForFlush(frame_id);
+      continue;
+    }
+    writes.emplace_back(page->GetPageId(), copy);
+    cleaned.push_back(frame_id);
+  }
+  if (writes.empty()) {
+    return;
+  }
+  GetDiskScheduler()->ScheduleWrites(&writes).wait();
+  disk_manager_->Sync();
+
+  for (frame_id_t frame_id : cleaned) {
+    Cleaned(frame_id) = true;
+    pages_cleaned_++;
+    UnpinForFlush(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPagesImpl(const std::vector<page_id_t> &page_ids,
+                                                  BufferAccessStrategy *strategy, PrefetchTracker *tracker) {
+  if (tracker == nullptr && strategy != nullptr) {
+    tracker = &strategy->prefetches_;
+  }
+  // Prefetches are hints; a scan that runs far ahead must not build up an unbounded backlog.
+  QueuePrefetches(page_ids, strategy, tracker, true);
+}
+
+size_t BufferPoolManagerInstance::QueuePrefetches(const std::vector<page_id_t> &page_ids,
+                                                  BufferAccessStrategy *strategy, PrefetchTracker *tracker,
+                                                  bool capped) {
+  std::scoped_lock guard(prefetch_latch_);
+  if (prefetch_stop_) {
+    // StopPrefetcher is waiting for the thread to exit.
+    return 0;
+  }
+  if (!prefetcher_.joinable()) {
+    prefetcher_ = std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+  }
+  size_t queued = 0;
+  for (page_id_t page_id : page_ids) {
+    if (capped && prefetch_queue_.size() >= pool_size_.load()) {
+      break;
+    }
+    size_t sequence = tracker != nullptr ? tracker->Begin(page_id) : 0;
+    prefetch_queue_.push_back({page_id, strategy, tracker, sequence});
+    queued++;
+  }
+  prefetch_cv_.notify_one();
+  return queued;
+}
+
+void BufferPoolManagerInstance::StopPrefetcher() {
+  std::thread prefetcher;
+  {
+    std::scoped_lock guard(prefetch_latch_);
+    if (!prefetcher_.joinable()) {
+      return;
+    }
+    prefetch_stop_ = true;
+    FinishPrefetches({prefetch_queue_.begin(), prefetch_queue_.end()});
+    prefetch_queue_.clear();
+    prefetcher = std::move(prefetcher_);
+  }
+  prefetch_cv_.notify_all();
+  // The batch the thread is loading, if any, is finished before it exits.
+  prefetcher.join();
+  std::scoped_lock guard(prefetch_latch_);
+  prefetch_stop_ = false;
+}
+
+void BufferPoolManagerInstance::FinishPrefetches(const std::vector<PrefetchRequest> &requests) {
+  for (const auto &request : requests) {
+    if (request.tracker_ != nullptr) {
+      request.tracker_->Finish();
+    }
+  }
+}
+
+size_t BufferPoolManagerInstance::WarmUpImpl(const std::vector<page_id_t> &page_ids) {
+  // The disk manager counts the pages in the file as allocated, so they are read back like prefetched pages. The
+  // caller keeps them to the size of the pool.
+  return QueuePrefetches(page_ids, nullptr, nullptr, false);
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  std::unique_lock<std::mutex> guard(prefetch_latch_);
+  std::vector<PrefetchRequest> batch;
+  while (true) {
+    prefetch_cv_.wait(guard, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_stop_) {
+      return;
+    }
+    // Take as many requests as the disk scheduler keeps in flight, so that their reads overlap.
+    while (!prefetch_queue_.empty() && batch.size() < DISK_SCHEDULER_QUEUE_DEPTH) {
+      batch.push_back(prefetch_queue_.front());
+      prefetch_queue_.pop_front();
+    }
+    guard.unlock();
+    LoadPrefetches(batch);
+    FinishPrefetches(batch);
+    batch.clear();
+    guard.lock();
+  }
+}
+
+void BufferPoolManagerInstance::LoadPrefetches(const std::vector<PrefetchRequest> &requests) {
+  StagedPageCompressor compressor(this);
+  std::unique_lock<std::mutex> latch(latch_);
+  std::vector<std::pair<frame_id_t, page_id_t>> loads;
+  for (const auto &[page_id, strategy, tracker, sequence] : requests) {
+    frame_id_t frame_id;
+    // The scan that wanted the page is gone, or has got there first.
+    if (page_id < 0 || (tracker != nullptr && !tracker->IsWanted(sequence))) {
+      continue;
+    }
+    ValidatePageId(page_id);
+    // A page that is not allocated must not be cached: NewPage would map its id a second time. A page that is
+    // requested twice in the batch is loaded once.
+    if (!disk_manager_->IsAllocated(page_id) || page_table_.Find(page_id, &frame_id) ||
+        std::any_of(loads.begin(), loads.end(), [&](const auto &load) { return load.second == page_id; })) {
+      continue;
+    }
+    // The frames of the batch keep their old page ids until they are loaded, so a ring that wraps around within the
+    // batch does not recycle one of them.
+    std::unique_lock<std::mutex> ring_latch;
+    BufferAccessStrategy::Slot *slot = NextRingSlot(strategy, &ring_latch);
+    if (slot != nullptr && HoldsRingPage(*slot) && Frame(slot->frame_id_)->pin_count_.load() != 0) {
+      // The scan still holds the page it is about to leave behind in this slot. GetFreeFrame would hand out a shared
+      // frame instead and the ring would grow, so the page is left for the scan to fetch through its own slot.
+      strategy->PutBackSlot();
+      continue;
+    }
+    if (!GetFreeFrame(slot, &frame_id)) {
+      break;
+    }
+    if (slot != nullptr) {
+      *slot = {this, frame_id, page_id};
+    }
+    loads.emplace_back(frame_id, page_id);
+  }
+
+  // Nobody holds the pages yet, so they go straight to the replacer.
+  LoadFrames(&latch, loads, 0);
+}
+
+DiskScheduler *BufferPoolManagerInstance::GetDiskScheduler() {
+  std::call_once(disk_scheduler_once_, [this] { disk_scheduler_ = std::make_unique<DiskScheduler>(disk_manager_); });
+  return disk_scheduler_.get();
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage(page_id_t hint) {
+  const page_id_t page_id = disk_manager_->AllocatePage(hint, num_instances_, instance_index_);
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
+
+}  // namespace bustub
@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace bustub {
+
+namespace {
+
+/** Shards that no live thread owns. A shard index means the same shard in every BufferPoolStats. */
+std::mutex free_shards_latch;
+std::vector<uint32_t> *free_shards = nullptr;
+
+/** Hands the shard of a thread back when the thread exits. */
+struct ShardOwner {
+  ~ShardOwner() {
+    if (owns_shard_) {
+      std::scoped_lock guard(free_shards_latch);
+      free_shards->push_back(shard_);
+    }
+  }
+  uint32_t shard_{0};
+  bool owns_shard_{false};
+};
+
+void AppendHistogram(std::string *out, const char *name, const LatencyHistogram &histogram) {
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           R"("%s":{"count":%)" PRIu64 R"(,"mean_ns":%.1f,"p50_ns":%)" PRIu64 R"(,"p99_ns":%)" PRIu64 R"(,"buckets":[)",
+           name, histogram.count_, histogram.MeanNs(), histogram.PercentileNs(0.5), histogram.PercentileNs(0.99));
+  *out += buf;
+  // Trailing empty buckets are left out; bucket i still ends at 2^i ns.
+  size_t num_buckets = LatencyHistogram::NUM_BUCKETS;
+  while (num_buckets > 0 && histogram.buckets_[num_buckets - 1] == 0) {
+    num_buckets--;
+  }
+  for (size_t i = 0; i < num_buckets; ++i) {
+    if (i > 0) {
+      *out += ",";
+    }
+    *out += std::to_string(histogram.buckets_[i]);
+  }
+  *out += "]}";
+}
+
+}  // namespace
+
+size_t LatencyHistogram::BucketOf(uint64_t ns) {
+  size_t bucket = ns == 0 ? 0 : 64 - __builtin_clzll(ns);
+  return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram &other) {
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  total_ns_ += other.total_ns_;
+}
+
+double LatencyHistogram::MeanNs() const {
+  return count_ == 0 ? 0 : static_cast<double>(total_ns_) / static_cast<double>(count_);
+}
+
+uint64_t LatencyHistogram::PercentileNs(double quantile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  // The rank of the sample at the quantile, counting from 1.
+  auto rank = static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count_)));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return BucketBound(i);
+    }
+  }
+  return BucketBound(NUM_BUCKETS - 1);
+}
+
+void BufferPoolStatsSnapshot::Merge(const BufferPoolStatsSnapshot &other) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  evictions_ += other.evictions_;
+  dirty_write_backs_ += other.dirty_write_backs_;
+  pin_waits_ += other.pin_waits_;
+  compressed_hits_ += other.compressed_hits_;
+  compressed_bytes_ += other.compressed_bytes_;
+  compressed_pages_ += other.compressed_pages_;
+  free_list_length_ += other.free_list_length_;
+  fetch_hit_latency_.Merge(other.fetch_hit_latency_);
+  fetch_miss_latency_.Merge(other.fetch_miss_latency_);
+  new_page_latency_.Merge(other.new_page_latency_);
+}
+
+double BufferPoolStatsSnapshot::HitRatio() const {
+  uint64_t fetches = hits_ + misses_;
+  return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+}
+
+std::string BufferPoolStatsSnapshot::ToJson() const {
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           R"({"hits":%)" PRIu64 R"(,"misses":%)" PRIu64 R"(,"hit_ratio":%.4f,"evictions":%)" PRIu64
+           R"(,"dirty_write_backs":%)" PRIu64 R"(,"pin_waits":%)" PRIu64 R"(,"compressed_hits":%)" PRIu64
+           R"(,"compressed_bytes":%)" PRIu64 R"(,"compressed_pages":%)" PRIu64 R"(,"free_list_length":%)" PRIu64
+           R"(,"latency":{)",
+           hits_, misses_, HitRatio(), evictions_, dirty_write_backs_, pin_waits_, compressed_hits_, compressed_bytes_,
+           compressed_pages_, free_list_length_);
+  std::string json = buf;
+  AppendHistogram(&json, "fetch_hit", fetch_hit_latency_);
+  json += ",";
+  AppendHistogram(&json, "fetch_miss", fetch_miss_latency_);
+  json += ",";
+  AppendHistogram(&json, "new_page", new_page_latency_);
+  json += "}}";
+  return json;
+}
+
+BufferPoolStats::BufferPoolStats()
+    : enabled_(enable_buffer_pool_stats.load()), shards_(std::make_unique<Shard[]>(NUM_SHARDS)) {}
+
+void BufferPoolStats::AssignShard(ThreadState *state) {
+  thread_local ShardOwner owner;
+  std::scoped_lock guard(free_shards_latch);
+  if (free_shards == nullptr) {
+    // Never freed: threads may still hand their shards back while static objects are destroyed.
+    free_shards = new std::vector<uint32_t>();
+    for (uint32_t shard = NUM_SHARDS - 1; shard > 0; --shard) {
+      free_shards->push_back(shard - 1);
+    }
+  }
+  if (free_shards->empty()) {
+    state->shard_plus_one_ = NUM_SHARDS;
+    state->exclusive_ = false;
+    return;
+  }
+  owner.shard_ = free_shards->back();
+  owner.owns_shard_ = true;
+  free_shards->pop_back();
+  state->shard_plus_one_ = owner.shard_ + 1;
+  state->exclusive_ = true;
+}
+
+void BufferPoolStats::Record(Latency latency, TimePoint start) {
+  if (start == TimePoint()) {
+    return;
+  }
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  auto elapsed = static_cast<uint64_t>(ns < 0 ? 0 : ns);
+  Shard &shard = LocalShard();
+  auto index = static_cast<size_t>(latency);
+  Increment(&shard.buckets_[index][LatencyHistogram::BucketOf(elapsed)], 1);
+  Increment(&shard.total_ns_[index], elapsed);
+}
+
+BufferPoolStatsSnapshot BufferPoolStats::Snapshot() const {
+  BufferPoolStatsSnapshot snapshot;
+  LatencyHistogram *histograms[NUM_LATENCIES] = {&snapshot.fetch_hit_latency_, &snapshot.fetch_miss_latency_,
+                                                 &snapshot.new_page_latency_};
+  for (size_t s = 0; s < NUM_SHARDS; ++s) {
+    const Shard &shard = shards_[s];
+    snapshot.hits_ += shard.counters_[static_cast<size_t>(Counter::HIT)].load(std::memory_order_relaxed);
+    snapshot.misses_ += shard.counters_[static_cast<size_t>(Counter::MISS)].load(std::memory_order_relaxed);
+    snapshot.evictions_ += shard.counters_[static_cast<size_t>(Counter::EVICTION)].load(std::memory_order_relaxed);
+    snapshot.dirty_write_backs_ +=
+        shard.counters_[static_cast<size_t>(Counter::DIRTY_WRITE_BACK)].load(std::memory_order_relaxed);
+    snapshot.pin_waits_ += shard.counters_[static_cast<size_t>(Counter::PIN_WAIT)].load(std::memory_order_relaxed);
+    snapshot.compressed_hits_ +=
+        shard.counters_[static_cast<size_t>(Counter::COMPRESSED_HIT)].load(std::memory_order_relaxed);
+    for (size_t l = 0; l < NUM_LATENCIES; ++l) {
+      for (size_t b = 0; b < LatencyHistogram::NUM_BUCKETS; ++b) {
+        uint64_t samples = shard.buckets_[l][b].load(std::memory_order_relaxed);
+        histograms[l]->buckets_[b] += samples;
+        histograms[l]->count_ += samples;
+      }
+      histograms[l]->total_ns_ += shard.total_ns_[l].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+void BufferPoolStats::Reset() {
+  for (size_t s = 0; s < NUM_SHARDS; ++s) {
+    Shard &shard = shards_[s];
+    for (auto &counter : shard.counters_) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+    for (size_t l = 0; l < NUM_LATENCIES; ++l) {
+      for (auto &bucket : shard.buckets_[l]) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+      shard.total_ns_[l].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace bustub
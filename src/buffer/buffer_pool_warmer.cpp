@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_warmer.cpp
+//
+// Identification: src/buffer/buffer_pool_warmer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_warmer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+BufferPoolWarmer::BufferPoolWarmer(BufferPoolManager *bpm, std::string file_name)
+    : bpm_(bpm), file_name_(std::move(file_name)) {}
+
+BufferPoolWarmer::~BufferPoolWarmer() { Stop(); }
+
+bool BufferPoolWarmer::Dump() {
+  std::vector<page_id_t> page_ids = bpm_->GetResidentPageIds();
+  const std::string temp_name = file_name_ + ".tmp";
+  {
+    std::ofstream out(temp_name, std::ios::binary | std::ios::trunc);
+    const uint32_t header[] = {MAGIC, static_cast<uint32_t>(page_ids.size())};
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(page_ids.data()),
+              static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+    out.flush();
+    if (!out) {
+      LOG_DEBUG("can't write buffer pool dump %s", temp_name.c_str());
+      return false;
+    }
+  }
+  return rename(temp_name.c_str(), file_name_.c_str()) == 0;
+}
+
+size_t BufferPoolWarmer::Restore() {
+  std::ifstream in(file_name_, std::ios::binary);
+  uint32_t header[2];
+  if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != MAGIC) {
+    return 0;
+  }
+  // The count is checked against the size of the file before anything is allocated for it, so that a corrupt dump
+  // cannot ask for an arbitrary amount of memory.
+  const std::streamoff ids_begin = in.tellg();
+  in.seekg(0, std::ios::end);
+  const std::streamoff ids_size = in.tellg() - ids_begin;
+  if (ids_size != static_cast<std::streamoff>(header[1] * sizeof(page_id_t))) {
+    LOG_DEBUG("buffer pool dump %s does not hold the %u page ids it announces", file_name_.c_str(), header[1]);
+    return 0;
+  }
+  in.seekg(ids_begin);
+
+  // The pool may have been made smaller since the dump; only the hottest pages are read, then sorted into disk order.
+  std::vector<page_id_t> page_ids(std::min<size_t>(header[1], bpm_->GetPoolSize()));
+  if (!in.read(reinterpret_cast<char *>(page_ids.data()),
+               static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)))) {
+    LOG_DEBUG("truncated buffer pool dump %s", file_name_.c_str());
+    return 0;
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  return bpm_->WarmUp(page_ids);
+}
+
+void BufferPoolWarmer::Start() {
+  std::scoped_lock guard(latch_);
+  if (dumper_.joinable()) {
+    return;
+  }
+  stop_ = false;
+  dumper_ = std::thread(&BufferPoolWarmer::DumpLoop, this);
+}
+
+void BufferPoolWarmer::Stop() {
+  {
+    std::scoped_lock guard(latch_);
+    if (!dumper_.joinable()) {
+      return;
+    }
+    stop_ = true;
+  }
+  cv_.notify_one();
+  dumper_.join();
+}
+
+void BufferPoolWarmer::DumpLoop() {
+  std::unique_lock<std::mutex> guard(latch_);
+  while (!cv_.wait_for(guard, buffer_pool_dump_interval, [this] { return stop_; })) {
+    guard.unlock();
+    Dump();
+    guard.lock();
+  }
+  guard.unlock();
+  Dump();
+}
+
+}  // namespace bustub
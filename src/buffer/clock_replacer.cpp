@@ -14,16 +14,99 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages) {
+  arrays_.push_back(std::make_unique<std::atomic<uint8_t>[]>(num_pages));
+  for (size_t i = 0; i < num_pages_; ++i) {
+    arrays_.back()[i].store(0, std::memory_order_relaxed);
+  }
+  frames_ = arrays_.back().get();
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock latch(hand_latch_);
+  // Pin and Unpin race with the sweep, so loop on the live count rather than a fixed number of revolutions.
+  std::atomic<uint8_t> *frames = frames_.load();
+  while (size_.load() > 0) {
+    auto &frame = frames[hand_];
+    size_t current = hand_;
+    hand_ = (hand_ + 1) % num_pages_;
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+    uint8_t state = frame.load();
+    if ((state & EVICTABLE) == 0) {
+      continue;
+    }
+    if ((state & REFERENCED) != 0) {
+      // Second chance. A failed exchange means the frame was touched meanwhile; it is looked at next revolution.
+      frame.compare_exchange_strong(state, state & ~REFERENCED);
+      continue;
+    }
+    if (frame.compare_exchange_strong(state, 0)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(current);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if ((frames_.load()[frame_id].exchange(0) & EVICTABLE) != 0) {
+    size_--;
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  // Like LRUReplacer, unpinning a frame that is already evictable changes nothing, not even its reference bit.
+  auto &frame = frames_.load()[frame_id];
+  uint8_t state = frame.load();
+  while ((state & EVICTABLE) == 0) {
+    if (frame.compare_exchange_weak(state, EVICTABLE | REFERENCED)) {
+      size_++;
+      return;
+    }
+  }
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  // Only an evictable frame without its reference bit is written to, so that hits on a hot frame merely read it. A
+  // failed exchange means the sweep or a Pin got there first.
+  auto &frame = frames_.load()[frame_id];
+  uint8_t state = frame.load();
+  if (state == EVICTABLE) {
+    frame.compare_exchange_strong(state, EVICTABLE | REFERENCED);
+  }
+}
+
+void ClockReplacer::EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) {
+  std::scoped_lock latch(hand_latch_);
+  std::atomic<uint8_t> *frames = frames_.load();
+  // The hand takes unreferenced frames on its first revolution and referenced ones on its second.
+  for (uint8_t wanted : {EVICTABLE, static_cast<uint8_t>(EVICTABLE | REFERENCED)}) {
+    for (size_t i = 0; i < num_pages_ && candidates->size() < max_candidates; ++i) {
+      size_t frame_id = (hand_ + i) % num_pages_;
+      if (frames[frame_id].load() == wanted) {
+        candidates->push_back(static_cast<frame_id_t>(frame_id));
+      }
+    }
+  }
+}
+
+void ClockReplacer::SetCapacity(size_t num_pages) {
+  std::scoped_lock latch(hand_latch_);
+  if (num_pages <= num_pages_) {
+    return;
+  }
+  std::atomic<uint8_t> *old_frames = frames_.load();
+  arrays_.push_back(std::make_unique<std::atomic<uint8_t>[]>(num_pages));
+  for (size_t i = 0; i < num_pages; ++i) {
+    arrays_.back()[i].store(i < num_pages_ ? old_frames[i].load() : 0, std::memory_order_relaxed);
+  }
+  frames_ = arrays_.back().get();
+  num_pages_ = num_pages;
+}
+
+size_t ClockReplacer::Size() { return size_.load(); }
 
 }  // namespace bustub
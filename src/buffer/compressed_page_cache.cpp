@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "buffer/page_codec.h"
+
+namespace bustub {
+
+CompressedPageCache::CompressedPageCache(size_t capacity_bytes) : capacity_bytes_(capacity_bytes) {}
+
+void CompressedPageCache::Insert(page_id_t page_id, const char *page_data) {
+  // Compress outside the latch; a page that does not shrink is kept as it is.
+  char buffer[PAGE_SIZE];
+  size_t size = PageCodec::Compress(page_data, buffer, PAGE_SIZE - 1);
+  const char *data = buffer;
+  if (size == 0) {
+    size = PAGE_SIZE;
+    data = page_data;
+  }
+  std::shared_ptr<char[]> copy(new char[size]);
+  memcpy(copy.get(), data, size);
+
+  std::scoped_lock guard(latch_);
+  PutEntry(page_id, std::move(copy), size, false);
+}
+
+void CompressedPageCache::Stage(page_id_t page_id, const char *page_data) {
+  std::shared_ptr<char[]> copy(new char[PAGE_SIZE]);
+  memcpy(copy.get(), page_data, PAGE_SIZE);
+
+  std::scoped_lock guard(latch_);
+  PutEntry(page_id, std::move(copy), PAGE_SIZE, true);
+  staged_pages_.push_back(page_id);
+}
+
+void CompressedPageCache::CompressStaged() {
+  char buffer[PAGE_SIZE];
+  while (true) {
+    std::shared_ptr<char[]> page;
+    page_id_t page_id;
+    {
+      std::scoped_lock guard(latch_);
+      if (staged_pages_.empty()) {
+        return;
+      }
+      page_id = staged_pages_.back();
+      staged_pages_.pop_back();
+      auto it = index_.find(page_id);
+      if (it == index_.end() || !it->second->staged_) {
+        continue;
+      }
+      it->second->staged_ = false;
+      page = it->second->data_;
+    }
+
+    // A page that does not shrink stays as it was staged.
+    size_t size = PageCodec::Compress(page.get(), buffer, PAGE_SIZE - 1);
+    if (size == 0) {
+      continue;
+    }
+    std::shared_ptr<char[]> compressed(new char[size]);
+    memcpy(compressed.get(), buffer, size);
+
+    // The page may have been taken, or staged again with new contents, while it was compressed.
+    std::scoped_lock guard(latch_);
+    auto it = index_.find(page_id);
+    if (it != index_.end() && it->second->data_ == page) {
+      size_bytes_ -= it->second->size_ - size;
+      it->second->data_ = std::move(compressed);
+      it->second->size_ = size;
+    }
+  }
+}
+
+bool CompressedPageCache::Take(page_id_t page_id, char *page_data) {
+  std::list<Entry> taken;
+  {
+    std::scoped_lock guard(latch_);
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    size_bytes_ -= it->second->size_;
+    num_pages_--;
+    taken.splice(taken.begin(), entries_, it->second);
+    index_.erase(it);
+  }
+  // Decompress outside the latch.
+  const Entry &entry = taken.front();
+  if (entry.size_ == PAGE_SIZE) {
+    memcpy(page_data, entry.data_.get(), PAGE_SIZE);
+    return true;
+  }
+  return PageCodec::Decompress(entry.data_.get(), entry.size_, page_data);
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+}
+
+void CompressedPageCache::SetCapacity(size_t capacity_bytes) {
+  std::scoped_lock guard(latch_);
+  capacity_bytes_ = capacity_bytes;
+  Trim();
+}
+
+void CompressedPageCache::PutEntry(page_id_t page_id, std::shared_ptr<char[]> data, size_t size, bool staged) {
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+  entries_.push_front({page_id, std::move(data), size, staged});
+  index_[page_id] = entries_.begin();
+  size_bytes_ += size;
+  num_pages_++;
+  Trim();
+}
+
+void CompressedPageCache::EraseEntry(std::list<Entry>::iterator entry) {
+  size_bytes_ -= entry->size_;
+  num_pages_--;
+  index_.erase(entry->page_id_);
+  entries_.erase(entry);
+}
+
+void CompressedPageCache::Trim() {
+  while (size_bytes_ > capacity_bytes_) {
+    EraseEntry(std::prev(entries_.end()));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.cpp
+//
+// Identification: src/buffer/concurrent_page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/concurrent_page_table.h"
+
+#include <vector>
+
+namespace bustub {
+
+ConcurrentPageTable::Slots::Slots(size_t num_frames) {
+  // Keep the load factor at or below one half so that probe sequences stay short.
+  capacity_ = 2;
+  shift_ = 1;
+  while (capacity_ < 2 * num_frames) {
+    capacity_ <<= 1;
+    shift_++;
+  }
+  mask_ = capacity_ - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  for (size_t i = 0; i < capacity_; ++i) {
+    slots_[i].store(Pack(EMPTY_KEY, INVALID_PAGE_ID), std::memory_order_relaxed);
+  }
+}
+
+size_t ConcurrentPageTable::Slots::HomeSlot(page_id_t page_id) const {
+  // Fibonacci hashing spreads the dense, sequential page ids handed out by the allocator.
+  return static_cast<size_t>((static_cast<uint32_t>(page_id) * 2654435769U) >> (32 - shift_)) & mask_;
+}
+
+ConcurrentPageTable::ConcurrentPageTable(size_t num_frames) {
+  tables_.push_back(std::make_unique<Slots>(num_frames));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+void ConcurrentPageTable::Reserve(size_t num_frames) {
+  const Slots *old_table = table_.load(std::memory_order_relaxed);
+  if (old_table->capacity_ >= 2 * num_frames) {
+    return;
+  }
+  // Fill the new array before publishing it, so readers that switch over find every entry.
+  tables_.push_back(std::make_unique<Slots>(num_frames));
+  Slots *table = tables_.back().get();
+  for (size_t i = 0; i < old_table->capacity_; ++i) {
+    uint64_t entry = old_table->slots_[i].load(std::memory_order_relaxed);
+    if (IsFree(entry)) {
+      continue;
+    }
+    size_t slot = table->HomeSlot(KeyOf(entry));
+    while (KeyOf(table->slots_[slot].load(std::memory_order_relaxed)) != EMPTY_KEY) {
+      slot = (slot + 1) & table->mask_;
+    }
+    table->slots_[slot].store(entry, std::memory_order_relaxed);
+  }
+  tombstones_ = 0;
+  table_.store(table, std::memory_order_release);
+}
+
+bool ConcurrentPageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  // The slot markers are negative page ids; an invalid page id must not match an empty slot.
+  if (page_id < 0) {
+    return false;
+  }
+  const Slots *table = table_.load(std::memory_order_acquire);
+  size_t slot = table->HomeSlot(page_id);
+  for (size_t probes = 0; probes < table->capacity_; ++probes) {
+    uint64_t entry = table->slots_[slot].load(std::memory_order_acquire);
+    page_id_t key = KeyOf(entry);
+    if (key == page_id) {
+      *frame_id = FrameOf(entry);
+      return true;
+    }
+    if (key == EMPTY_KEY) {
+      return false;
+    }
+    slot = (slot + 1) & table->mask_;
+  }
+  return false;
+}
+
+void ConcurrentPageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  Slots *table = table_.load(std::memory_order_relaxed);
+  size_t slot = table->HomeSlot(page_id);
+  size_t reuse = table->capacity_;
+  for (size_t probes = 0; probes < table->capacity_; ++probes) {
+    uint64_t entry = table->slots_[slot].load(std::memory_order_relaxed);
+    page_id_t key = KeyOf(entry);
+    if (key == page_id) {
+      table->slots_[slot].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    if (key == TOMBSTONE_KEY && reuse == table->capacity_) {
+      reuse = slot;
+    }
+    if (key == EMPTY_KEY) {
+      break;
+    }
+    slot = (slot + 1) & table->mask_;
+  }
+  if (reuse != table->capacity_) {
+    slot = reuse;
+    tombstones_--;
+  }
+  table->slots_[slot].store(Pack(page_id, frame_id), std::memory_order_release);
+  size_++;
+}
+
+bool ConcurrentPageTable::Remove(page_id_t page_id) {
+  Slots *table = table_.load(std::memory_order_relaxed);
+  size_t slot = table->HomeSlot(page_id);
+  for (size_t probes = 0; probes < table->capacity_; ++probes) {
+    uint64_t entry = table->slots_[slot].load(std::memory_order_relaxed);
+    page_id_t key = KeyOf(entry);
+    if (key == page_id) {
+      // A tombstone keeps the probe sequences of other keys intact for concurrent readers.
+      table->slots_[slot].store(Pack(TOMBSTONE_KEY, INVALID_PAGE_ID), std::memory_order_release);
+      size_--;
+      tombstones_++;
+      if (size_ + tombstones_ > table->capacity_ * 3 / 4) {
+        Rebuild();
+      }
+      return true;
+    }
+    if (key == EMPTY_KEY) {
+      return false;
+    }
+    slot = (slot + 1) & table->mask_;
+  }
+  return false;
+}
+
+void ConcurrentPageTable::Rebuild() {
+  Slots *table = table_.load(std::memory_order_relaxed);
+  std::vector<uint64_t> live;
+  live.reserve(size_);
+  for (size_t i = 0; i < table->capacity_; ++i) {
+    uint64_t entry = table->slots_[i].load(std::memory_order_relaxed);
+    if (!IsFree(entry)) {
+      live.push_back(entry);
+    }
+    table->slots_[i].store(Pack(EMPTY_KEY, INVALID_PAGE_ID), std::memory_order_release);
+  }
+  size_ = 0;
+  tombstones_ = 0;
+  for (uint64_t entry : live) {
+    Insert(KeyOf(entry), FrameOf(entry));
+  }
+}
+
+}  // namespace bustub
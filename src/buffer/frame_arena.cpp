@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+#if defined(SYS_mbind)
+namespace {
+
+/** Memory policy of mbind(2) that allocates only from the given nodes. */
+constexpr int MPOL_BIND_POLICY = 2;
+
+}  // namespace
+#endif
+
+FrameArena::FrameArena(size_t max_bytes, bool huge_pages, int numa_node)
+    : huge_pages_(huge_pages), numa_node_(numa_node) {
+  // Reserving address space costs no memory; the slack lets the arena start on a huge page boundary.
+  reservation_bytes_ = max_bytes + HUGE_PAGE_SIZE;
+  void *reservation = mmap(nullptr, reservation_bytes_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (reservation == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot reserve address space for buffer pool frames.");
+  }
+  reservation_ = static_cast<char *>(reservation);
+  auto address = reinterpret_cast<uintptr_t>(reservation_);
+  base_ = reservation_ + (HUGE_PAGE_SIZE - address % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+}
+
+FrameArena::~FrameArena() { munmap(reservation_, reservation_bytes_); }
+
+char *FrameArena::Commit(size_t offset, size_t bytes) {
+  char *data = base_ + offset;
+  const int protection = PROT_READ | PROT_WRITE;
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+  bool huge_tlb = false;
+#if defined(MAP_HUGETLB)
+  huge_tlb = huge_pages_ && offset % HUGE_PAGE_SIZE == 0 && bytes % HUGE_PAGE_SIZE == 0 &&
+             mmap(data, bytes, protection, flags | MAP_HUGETLB, -1, 0) != MAP_FAILED;
+#endif
+  if (huge_tlb) {
+    huge_tlb_bytes_ += bytes;
+  } else {
+    if (mmap(data, bytes, protection, flags, -1, 0) == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot map memory for buffer pool frames.");
+    }
+#if defined(MADV_HUGEPAGE)
+    if (huge_pages_) {
+      // Without reserved huge pages the kernel can still back the aligned arena with transparent ones.
+      madvise(data, bytes, MADV_HUGEPAGE);
+    }
+#endif
+  }
+  // Bind before the first touch: pages are placed when they are faulted in.
+  if (numa_node_ >= 0) {
+    BindToNode(data, bytes);
+  }
+  return data;
+}
+
+void FrameArena::Discard(char *data, size_t bytes) {
+#if defined(__linux__)
+  madvise(data, bytes, MADV_DONTNEED);
+#else
+  // Elsewhere MADV_DONTNEED may leave the old contents in place; fresh anonymous memory mapped over the range is zero.
+  mmap(data, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+#endif
+}
+
+void FrameArena::BindToNode([[maybe_unused]] char *data, [[maybe_unused]] size_t bytes) {
+#if defined(SYS_mbind)
+  unsigned long node_mask = 0;  // NOLINT
+  if (numa_node_ < static_cast<int>(sizeof(node_mask) * 8 - 1)) {
+    node_mask = 1UL << numa_node_;
+  }
+  if (node_mask != 0 &&
+      syscall(SYS_mbind, data, bytes, MPOL_BIND_POLICY, &node_mask, sizeof(node_mask) * 8, 0) == 0) {
+    return;
+  }
+#endif
+  LOG_WARN("Cannot bind buffer pool frames to NUMA node %d, using the default placement.", numa_node_);
+  numa_node_ = -1;
+}
+
+int FrameArena::NumNumaNodes() {
+#if defined(__linux__)
+  // The file lists the online nodes as ranges, e.g. "0-1" or "0,2-3".
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string ranges;
+  if (!(online >> ranges)) {
+    return 1;
+  }
+  int num_nodes = 1;
+  size_t start = 0;
+  while (start < ranges.size()) {
+    size_t end = ranges.find_first_of(",-", start);
+    std::string number = ranges.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    if (!number.empty() && std::all_of(number.begin(), number.end(), ::isdigit)) {
+      num_nodes = std::max(num_nodes, std::stoi(number) + 1);
+    }
+    if (end == std::string::npos) {
+      break;
+    }
+    start = end + 1;
+  }
+  return num_nodes;
+#else
+  // Only Linux exposes the nodes memory can be bound to; elsewhere the machine counts as a single node.
+  return 1;
+#endif
+}
+
+}  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k), frames_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "k must be at least 1");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock latch(latch_);
+  std::set<QueueKey> &queue = history_queue_.empty() ? cache_queue_ : history_queue_;
+  if (queue.empty()) {
+    return false;
+  }
+  *frame_id = queue.begin()->second;
+  queue.erase(queue.begin());
+
+  // The frame will hold a different page next, so its access history starts over.
+  FrameInfo &frame = frames_[*frame_id];
+  frame.history_.clear();
+  frame.evictable_ = false;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  if (!frames_[frame_id].evictable_) {
+    return;
+  }
+  Dequeue(frame_id);
+  frames_[frame_id].evictable_ = false;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  // A frame that is unpinned without ever being recorded as accessed still needs a place in the order.
+  if (frame.history_.empty()) {
+    RecordAccessLocked(frame_id);
+  }
+  frame.evictable_ = true;
+  Enqueue(frame_id);
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  RecordAccessLocked(frame_id);
+}
+
+void LRUKReplacer::RecordLoad(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock latch(latch_);
+  // A frame reused after DeletePage never went through Victim, so drop whatever history the old page left behind.
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+  }
+  frame.history_.clear();
+  RecordAccessLocked(frame_id);
+  if (frame.evictable_) {
+    Enqueue(frame_id);
+  }
+}
+
+void LRUKReplacer::EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) {
+  std::scoped_lock latch(latch_);
+  for (const auto *queue : {&history_queue_, &cache_queue_}) {
+    for (auto it = queue->begin(); it != queue->end() && candidates->size() < max_candidates; ++it) {
+      candidates->push_back(it->second);
+    }
+  }
+}
+
+void LRUKReplacer::SetCapacity(size_t num_pages) {
+  std::scoped_lock latch(latch_);
+  if (num_pages > frames_.size()) {
+    frames_.resize(num_pages);
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock latch(latch_);
+  return history_queue_.size() + cache_queue_.size();
+}
+
+void LRUKReplacer::RecordAccessLocked(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    Dequeue(frame_id);
+  }
+  frame.history_.push_back(current_timestamp_++);
+  if (frame.history_.size() > k_) {
+    frame.history_.pop_front();
+  }
+  if (frame.evictable_) {
+    Enqueue(frame_id);
+  }
+}
+
+void LRUKReplacer::Enqueue(frame_id_t frame_id) {
+  const FrameInfo &frame = frames_[frame_id];
+  auto &queue = frame.history_.size() < k_ ? history_queue_ : cache_queue_;
+  queue.emplace(frame.history_.front(), frame_id);
+}
+
+void LRUKReplacer::Dequeue(frame_id_t frame_id) {
+  const FrameInfo &frame = frames_[frame_id];
+  auto &queue = frame.history_.size() < k_ ? history_queue_ : cache_queue_;
+  queue.erase({frame.history_.front(), frame_id});
+}
+
+}  // namespace bustub
@@ -55,6 +55,12 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
     frame_map[frame_id] = lru_list.begin();
 }
 
+void LRUReplacer::EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) {
+    for (auto it = lru_list.rbegin(); it != lru_list.rend() && candidates->size() < max_candidates; ++it) {
+        candidates->push_back(*it);
+    }
+}
+
 size_t LRUReplacer::Size() {
     return lru_list.size();
 }
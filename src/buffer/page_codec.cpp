@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.cpp
+//
+// Identification: src/buffer/page_codec.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_codec.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** Number of bits of the hash of four bytes that picks a slot of the match finder. */
+constexpr size_t HASH_BITS = 12;
+/** Farthest back a match can point, the largest distance two bytes hold. */
+constexpr size_t MAX_DISTANCE = 65535;
+
+uint32_t Load32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+size_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Appends bytes to a bounded output buffer, remembering whether anything did not fit. */
+class Writer {
+ public:
+  Writer(uint8_t *out, size_t capacity) : out_(out), capacity_(capacity) {}
+
+  void Put(uint8_t byte) {
+    if (size_ < capacity_) {
+      out_[size_] = byte;
+    } else {
+      overflow_ = true;
+    }
+    size_++;
+  }
+
+  void Put(const uint8_t *bytes, size_t n) {
+    if (size_ + n <= capacity_) {
+      memcpy(out_ + size_, bytes, n);
+    } else {
+      overflow_ = true;
+    }
+    size_ += n;
+  }
+
+  /** Writes the part of a length that did not fit in its nibble. */
+  void PutLengthContinuation(size_t length) {
+    for (; length >= 255; length -= 255) {
+      Put(255);
+    }
+    Put(static_cast<uint8_t>(length));
+  }
+
+  /** Writes a pair; a match_length of 0 means the pair only has literals. */
+  void PutPair(const uint8_t *literals, size_t num_literals, size_t distance, size_t match_length) {
+    size_t literal_nibble = num_literals < 15 ? num_literals : 15;
+    size_t match_nibble = 0;
+    if (match_length > 0) {
+      match_nibble = match_length - PageCodec::MIN_MATCH < 15 ? match_length - PageCodec::MIN_MATCH : 15;
+    }
+    Put(static_cast<uint8_t>(literal_nibble << 4 | match_nibble));
+    if (literal_nibble == 15) {
+      PutLengthContinuation(num_literals - 15);
+    }
+    Put(literals, num_literals);
+    if (match_length > 0) {
+      Put(static_cast<uint8_t>(distance & 0xff));
+      Put(static_cast<uint8_t>(distance >> 8));
+      if (match_nibble == 15) {
+        PutLengthContinuation(match_length - PageCodec::MIN_MATCH - 15);
+      }
+    }
+  }
+
+  size_t Size() const { return size_; }
+  bool Overflow() const { return overflow_; }
+
+ private:
+  uint8_t *out_;
+  size_t capacity_;
+  size_t size_{0};
+  bool overflow_{false};
+};
+
+/** Reads the continuation of a length that started as a nibble of 15 and adds it to *length. */
+bool ReadLengthContinuation(const uint8_t *in, size_t size, size_t *pos, size_t *length) {
+  uint8_t byte;
+  do {
+    if (*pos >= size) {
+      return false;
+    }
+    byte = in[(*pos)++];
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+size_t PageCodec::Compress(const char *page, char *out, size_t capacity) {
+  const auto *src = reinterpret_cast<const uint8_t *>(page);
+  Writer writer(reinterpret_cast<uint8_t *>(out), capacity);
+  // Most recent position of each hashed four-byte sequence, plus one so that zero means none.
+  uint32_t last_seen[1 << HASH_BITS] = {};
+
+  size_t literals_start = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= PAGE_SIZE && !writer.Overflow()) {
+    uint32_t sequence = Load32(src + pos);
+    size_t slot = Hash(sequence);
+    size_t candidate = last_seen[slot];
+    last_seen[slot] = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > MAX_DISTANCE || Load32(src + candidate - 1) != sequence) {
+      pos++;
+      continue;
+    }
+    candidate--;
+    size_t length = MIN_MATCH;
+    while (pos + length < PAGE_SIZE && src[candidate + length] == src[pos + length]) {
+      length++;
+    }
+    writer.PutPair(src + literals_start, pos - literals_start, pos - candidate, length);
+    pos += length;
+    literals_start = pos;
+  }
+  if (literals_start < PAGE_SIZE) {
+    writer.PutPair(src + literals_start, PAGE_SIZE - literals_start, 0, 0);
+  }
+  return writer.Overflow() ? 0 : writer.Size();
+}
+
+bool PageCodec::Decompress(const char *in, size_t size, char *page) {
+  const auto *src = reinterpret_cast<const uint8_t *>(in);
+  auto *dst = reinterpret_cast<uint8_t *>(page);
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+  while (in_pos < size) {
+    uint8_t token = src[in_pos++];
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !ReadLengthContinuation(src, size, &in_pos, &num_literals)) {
+      return false;
+    }
+    if (num_literals > size - in_pos || num_literals > PAGE_SIZE - out_pos) {
+      return false;
+    }
+    memcpy(dst + out_pos, src + in_pos, num_literals);
+    in_pos += num_literals;
+    out_pos += num_literals;
+    if (in_pos == size) {
+      break;
+    }
+
+    if (size - in_pos < 2) {
+      return false;
+    }
+    size_t distance = src[in_pos] | static_cast<size_t>(src[in_pos + 1]) << 8;
+    in_pos += 2;
+    size_t length = (token & 0xf) + MIN_MATCH;
+    if ((token & 0xf) == 15 && !ReadLengthContinuation(src, size, &in_pos, &length)) {
+      return false;
+    }
+    if (distance == 0 || distance > out_pos || length > PAGE_SIZE - out_pos) {
+      return false;
+    }
+    // The match may overlap the bytes it produces, so it is copied front to back.
+    for (size_t i = 0; i < length; ++i, ++out_pos) {
+      dst[out_pos] = dst[out_pos - distance];
+    }
+  }
+  return out_pos == PAGE_SIZE;
+}
+
+}  // namespace bustub
@@ -0,0 +1,278 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type) {
+  // Allocate and create individual BufferPoolManagerInstances
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_.push_back(new BufferPoolManagerInstance(pool_size, static_cast<uint32_t>(num_instances),
+                                                       static_cast<uint32_t>(i), disk_manager, log_manager,
+                                                       replacer_type));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+size_t ParallelBufferPoolManager::GetInstancePoolSize() {
+  size_t pool_size = instances_[0]->GetPoolSize();
+  for (auto *instance : instances_) {
+    pool_size = std::min(pool_size, instance->GetPoolSize());
+  }
+  return pool_size;
+}
+
+bool ParallelBufferPoolManager::ResizePool(size_t pool_size) {
+  // Check every share first, so that a request that cannot be met leaves all instances alone.
+  const size_t num_instances = instances_.size();
+  for (size_t i = 0; i < num_instances; ++i) {
+    size_t share = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    if (share == 0 || share > instances_[i]->GetMaxPoolSize()) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_[i]->ResizePool(pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0));
+  }
+  return true;
+}
+
+void ParallelBufferPoolManager::RunPageCleaner(size_t clean_target) {
+  const size_t per_instance = (clean_target + instances_.size() - 1) / instances_.size();
+  for (auto *instance : instances_) {
+    instance->RunPageCleaner(per_instance);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (auto *instance : instances_) {
+    instance->StopPageCleaner();
+  }
+}
+
+void ParallelBufferPoolManager::StopPrefetcher() {
+  for (auto *instance : instances_) {
+    instance->StopPrefetcher();
+  }
+}
+
+PageCleanerStats ParallelBufferPoolManager::GetPageCleanerStats() {
+  PageCleanerStats total;
+  for (auto *instance : instances_) {
+    PageCleanerStats stats = instance->GetPageCleanerStats();
+    total.pages_cleaned_ += stats.pages_cleaned_;
+    total.sync_victim_flushes_ += stats.sync_victim_flushes_;
+    total.avoided_victim_flushes_ += stats.avoided_victim_flushes_;
+  }
+  return total;
+}
+
+BufferPoolStatsSnapshot ParallelBufferPoolManager::GetStats() {
+  BufferPoolStatsSnapshot total;
+  for (auto *instance : instances_) {
+    total.Merge(instance->GetStats());
+  }
+  return total;
+}
+
+void ParallelBufferPoolManager::ResetStats() {
+  for (auto *instance : instances_) {
+    instance->ResetStats();
+  }
+}
+
+void ParallelBufferPoolManager::EnableStats(bool enabled) {
+  for (auto *instance : instances_) {
+    instance->EnableStats(enabled);
+  }
+}
+
+void ParallelBufferPoolManager::SetCompressedTierCapacity(size_t capacity_bytes) {
+  for (auto *instance : instances_) {
+    instance->SetCompressedTierCapacity(capacity_bytes / instances_.size());
+  }
+}
+
+std::vector<page_id_t> ParallelBufferPoolManager::GetResidentPageIds() {
+  std::vector<std::vector<page_id_t>> per_instance;
+  size_t num_pages = 0;
+  for (auto *instance : instances_) {
+    per_instance.push_back(instance->GetResidentPageIds());
+    num_pages += per_instance.back().size();
+  }
+  // The instances have replacers of their own, so the n-th hottest pages of all of them are about equally hot.
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(num_pages);
+  for (size_t rank = 0; page_ids.size() < num_pages; ++rank) {
+    for (const auto &resident : per_instance) {
+      if (rank < resident.size()) {
+        page_ids.push_back(resident[rank]);
+      }
+    }
+  }
+  return page_ids;
+}
+
+BufferPoolManagerInstance *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  return instances_[static_cast<size_t>(page_id) % instances_.size()];
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  // Fetch page for page_id from responsible BufferPoolManagerInstance
+  if (page_id < 0) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
+  // A ring slot only recycles frames of the instance that filled it, so a ring shared by every instance still keeps
+  // each of them to at most ring_size frames.
+  if (page_id < 0) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategy(page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // Unpin page_id from responsible BufferPoolManagerInstance
+  if (page_id < 0) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  // Flush page_id from responsible BufferPoolManagerInstance
+  if (page_id < 0) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id) {
+  // 1.   From a starting index of the BPMIs, call NewPage until either 1) success and return 2) looped around to
+  //      starting index and return nullptr
+  // 2.   Bump the starting index so the next call starts its search at a different BPMI
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; ++i) {
+    Page *page = instances_[(start + i) % num_instances]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) {
+  // Instances are tried round robin like NewPageImpl, so that the pages of a growing table are spread across them.
+  // The hint only picks the extent of the instance next to the one of the hint on disk.
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; ++i) {
+    Page *page = instances_[(start + i) % num_instances]->NewPageWithStrategy(page_id, strategy, hint);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  // Delete page_id from responsible BufferPoolManagerInstance
+  if (page_id < 0) {
+    return true;
+  }
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  // flush all pages from all BufferPoolManagerInstances
+  for (auto *instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+void ParallelBufferPoolManager::PrefetchPagesImpl(const std::vector<page_id_t> &page_ids,
+                                                  BufferAccessStrategy *strategy, PrefetchTracker *tracker) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (page_id_t page_id : page_ids) {
+    if (page_id >= 0) {
+      per_instance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->PrefetchPages(per_instance[i], strategy, tracker);
+    }
+  }
+}
+
+size_t ParallelBufferPoolManager::WarmUpImpl(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (page_id_t page_id : page_ids) {
+    if (page_id >= 0) {
+      per_instance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  size_t scheduled = 0;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!per_instance[i].empty()) {
+      scheduled += instances_[i]->WarmUp(per_instance[i]);
+    }
+  }
+  return scheduled;
+}
+
+std::vector<Page *> ParallelBufferPoolManager::FetchPagesImpl(const std::vector<page_id_t> &page_ids) {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  std::vector<std::vector<size_t>> positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (page_ids[i] >= 0) {
+      size_t instance = static_cast<size_t>(page_ids[i]) % instances_.size();
+      per_instance[instance].push_back(page_ids[i]);
+      positions[instance].push_back(i);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (per_instance[i].empty()) {
+      continue;
+    }
+    std::vector<Page *> fetched = instances_[i]->FetchPages(per_instance[i]);
+    for (size_t j = 0; j < fetched.size(); ++j) {
+      pages[positions[i][j]] = fetched[j];
+    }
+  }
+  return pages;
+}
+
+}  // namespace bustub
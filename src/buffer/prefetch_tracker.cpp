@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetch_tracker.cpp
+//
+// Identification: src/buffer/prefetch_tracker.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/prefetch_tracker.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+PrefetchTracker::~PrefetchTracker() {
+  std::unique_lock<std::mutex> guard(latch_);
+  cancelled_ = true;
+  done_.wait(guard, [this] { return pending_ == 0; });
+}
+
+size_t PrefetchTracker::Begin(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  pending_++;
+  queued_.push_back(page_id);
+  return passed_ + queued_.size() - 1;
+}
+
+void PrefetchTracker::Finish() {
+  std::scoped_lock guard(latch_);
+  pending_--;
+  if (pending_ == 0) {
+    // Nothing is left to skip.
+    passed_ += queued_.size();
+    queued_.clear();
+  }
+  // Notify under the latch: the owner may destroy the tracker as soon as it can acquire it.
+  done_.notify_all();
+}
+
+void PrefetchTracker::Reach(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  auto it = std::find(queued_.begin(), queued_.end(), page_id);
+  if (it != queued_.end()) {
+    size_t passed = it - queued_.begin() + 1;
+    passed_ += passed;
+    queued_.erase(queued_.begin(), queued_.begin() + passed);
+  }
+}
+
+bool PrefetchTracker::IsWanted(size_t sequence) {
+  std::scoped_lock guard(latch_);
+  return !cancelled_ && sequence >= passed_;
+}
+
+}  // namespace bustub
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.cpp
+//
+// Identification: src/buffer/read_ahead.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace bustub {
+
+ReadAhead::ReadAhead(BufferPoolManager *bpm, BufferAccessStrategy *strategy)
+    : bpm_(bpm), strategy_(strategy), window_(static_cast<page_id_t>(READ_AHEAD_PAGES)) {
+  if (strategy_ != nullptr) {
+    window_ = std::min(window_, static_cast<page_id_t>(strategy_->GetRingSize() / 2));
+  }
+}
+
+ReadAhead::ReadAhead(const ReadAhead &other)
+    : bpm_(other.bpm_),
+      strategy_(other.strategy_),
+      window_(other.window_),
+      last_page_id_(other.last_page_id_),
+      stride_(other.stride_),
+      run_(other.run_),
+      prefetched_until_(other.prefetched_until_) {}
+
+ReadAhead &ReadAhead::operator=(const ReadAhead &other) {
+  // The prefetches already issued stay with tracker_, which goes on waiting for them.
+  bpm_ = other.bpm_;
+  strategy_ = other.strategy_;
+  window_ = other.window_;
+  last_page_id_ = other.last_page_id_;
+  stride_ = other.stride_;
+  run_ = other.run_;
+  prefetched_until_ = other.prefetched_until_;
+  return *this;
+}
+
+void ReadAhead::OnPage(page_id_t page_id) {
+  if (bpm_ == nullptr || window_ == 0 || page_id == INVALID_PAGE_ID || page_id == last_page_id_) {
+    return;
+  }
+  tracker_.Reach(page_id);
+  if (last_page_id_ != INVALID_PAGE_ID && page_id - last_page_id_ == stride_) {
+    run_++;
+  } else {
+    stride_ = last_page_id_ == INVALID_PAGE_ID ? 0 : page_id - last_page_id_;
+    run_ = 1;
+    prefetched_until_ = page_id;
+  }
+  last_page_id_ = page_id;
+  if (stride_ <= 0 || run_ < READ_AHEAD_TRIGGER) {
+    return;
+  }
+
+  // Top the window up once half of it has been consumed, so that prefetches are issued in batches.
+  page_id_t ahead = std::max(prefetched_until_ - page_id, 0) / stride_;
+  if (ahead > window_ / 2) {
+    return;
+  }
+  std::vector<page_id_t> page_ids;
+  for (page_id_t next = std::max(prefetched_until_, page_id) + stride_; next <= page_id + window_ * stride_;
+       next += stride_) {
+    page_ids.push_back(next);
+  }
+  if (!page_ids.empty()) {
+    prefetched_until_ = page_ids.back();
+    bpm_->PrefetchPages(page_ids, strategy_, &tracker_);
+  }
+}
+
+}  // namespace bustub
@@ -16,8 +16,22 @@ namespace bustub {
 
 std::atomic<bool> enable_logging(false);
 
+std::atomic<bool> enable_buffer_pool_stats(true);
+
+std::atomic<bool> buffer_pool_huge_pages(false);
+
+std::atomic<bool> buffer_pool_numa_binding(true);
+
+std::atomic<bool> disk_scheduler_io_uring(true);
+
+std::atomic<bool> disk_manager_direct_io(false);
+
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(10);
+
+std::chrono::milliseconds buffer_pool_dump_interval = std::chrono::seconds(60);
+
 }  // namespace bustub
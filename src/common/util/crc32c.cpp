@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The Castagnoli polynomial, bit-reversed. */
+constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+/** Table k maps a byte to its CRC followed by k zero bytes, so that eight bytes are folded in at once. */
+constexpr Tables MakeTables() {
+  Tables tables{};
+  for (uint32_t byte = 0; byte < 256; ++byte) {
+    uint32_t crc = byte;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+    }
+    tables[0][byte] = crc;
+  }
+  for (size_t k = 1; k < tables.size(); ++k) {
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+      tables[k][byte] = (tables[k - 1][byte] >> 8) ^ tables[0][tables[k - 1][byte] & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr Tables TABLES = MakeTables();
+
+/** Extends the raw, not inverted, CRC state with the tables. Words are read little-endian. */
+uint32_t ExtendTables(uint32_t crc, const char *data, size_t length) {
+  while (length >= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    word ^= crc;
+    crc = TABLES[7][word & 0xFF] ^ TABLES[6][(word >> 8) & 0xFF] ^ TABLES[5][(word >> 16) & 0xFF] ^
+          TABLES[4][(word >> 24) & 0xFF] ^ TABLES[3][(word >> 32) & 0xFF] ^ TABLES[2][(word >> 40) & 0xFF] ^
+          TABLES[1][(word >> 48) & 0xFF] ^ TABLES[0][word >> 56];
+    data += sizeof(word);
+    length -= sizeof(word);
+  }
+  for (; length > 0; --length) {
+    crc = (crc >> 8) ^ TABLES[0][(crc ^ static_cast<uint8_t>(*data++)) & 0xFF];
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+
+/** Extends the raw CRC state with the crc32 instruction of SSE 4.2, which the caller checked the CPU has. */
+__attribute__((target("sse4.2"))) uint32_t ExtendHardware(uint32_t crc, const char *data, size_t length) {
+  uint64_t crc64 = crc;
+  while (length >= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+    data += sizeof(word);
+    length -= sizeof(word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; length > 0; --length) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data++));
+  }
+  return crc;
+}
+
+bool HasHardware() { return __builtin_cpu_supports("sse4.2") != 0; }
+
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+
+/** Extends the raw CRC state with the crc32c instructions of ARMv8, which the compiler was told the CPU has. */
+uint32_t ExtendHardware(uint32_t crc, const char *data, size_t length) {
+  while (length >= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc = __crc32cd(crc, word);
+    data += sizeof(word);
+    length -= sizeof(word);
+  }
+  for (; length > 0; --length) {
+    crc = __crc32cb(crc, static_cast<uint8_t>(*data++));
+  }
+  return crc;
+}
+
+bool HasHardware() { return true; }
+
+#else
+
+uint32_t ExtendHardware(uint32_t crc, const char *data, size_t length) { return ExtendTables(crc, data, length); }
+
+bool HasHardware() { return false; }
+
+#endif
+
+}  // namespace
+
+uint32_t Crc32c::Extend(uint32_t crc, const char *data, size_t length) {
+  return ~(IsHardwareAccelerated() ? ExtendHardware(~crc, data, length) : ExtendTables(~crc, data, length));
+}
+
+uint32_t Crc32c::ExtendPortable(uint32_t crc, const char *data, size_t length) {
+  return ~ExtendTables(~crc, data, length);
+}
+
+bool Crc32c::IsHardwareAccelerated() {
+  static const bool hardware = HasHardware();
+  return hardware;
+}
+
+}  // namespace bustub
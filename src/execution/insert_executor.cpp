@@ -20,6 +20,9 @@ InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
         table_metadata_ = exec_ctx_->GetCatalog()->GetTable(plan_->TableOid());
         table_indexes_ = exec_ctx_->GetCatalog()->GetTableIndexes(table_metadata_->name_);
+        if (!plan_->IsRawInsert()) {
+            strategy_ = exec_ctx_->MakeBufferAccessStrategy();
+        }
     }
 
 void InsertExecutor::Init() {
@@ -52,7 +55,7 @@ bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
         if (!success) {
             return false;
         }
-        success = table_metadata_->table_->InsertTuple(*tmp, rid, exec_ctx_->GetTransaction());
+        success = table_metadata_->table_->InsertTuple(*tmp, rid, exec_ctx_->GetTransaction(), strategy_.get());
         if (!success) {
             return false;
         }
@@ -17,7 +17,8 @@ namespace bustub {
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx), plan_(plan) {
   auto catalog = exec_ctx_->GetCatalog();
   table_metadata_ = catalog->GetTable(plan_->GetTableOid());
-  table_iterator_ = (table_metadata_->table_)->Begin(exec_ctx_->GetTransaction());
+  strategy_ = exec_ctx_->MakeBufferAccessStrategy();
+  table_iterator_ = (table_metadata_->table_)->Begin(exec_ctx_->GetTransaction(), strategy_.get());
 }
 
 void SeqScanExecutor::Init() {
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements Adaptive Replacement Cache (Megiddo and Modha, FAST 2003).
+ *
+ * Resident frames live in two LRU lists: T1 holds pages seen once since they were loaded, T2 pages seen at least
+ * twice. Each has a ghost list (B1, B2) of the ids of pages recently evicted from it. Loading a page found in B1
+ * means T1 was too small, so the target size p of T1 grows; a page found in B2 shrinks it. Victim evicts from T1
+ * while T1 exceeds p and from T2 otherwise, skipping pinned frames.
+ *
+ * Ghost hits need page ids, which the buffer pool supplies through RecordLoad and RecordEviction.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_pages the maximum number of pages the ARCReplacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ARCReplacer.
+   */
+  ~ARCReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordLoad(frame_id_t frame_id, page_id_t page_id) override;
+
+  void RecordEviction(frame_id_t frame_id, page_id_t page_id) override;
+
+  void EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) override;
+
+  void SetCapacity(size_t num_pages) override;
+
+  size_t Size() override;
+
+  /** @return the current target size of T1 */
+  size_t GetTarget();
+
+ private:
+  /** The list a frame currently belongs to. EVICTED_* marks a victim whose page id is not known yet. */
+  enum class Location { NONE, T1, T2, EVICTED_T1, EVICTED_T2 };
+
+  struct FrameInfo {
+    Location location_{Location::NONE};
+    std::list<frame_id_t>::iterator pos_;
+    bool evictable_{false};
+  };
+
+  /** Moves frame_id to the most recently used end of T1 or T2. Caller holds latch_. */
+  void MoveToFront(frame_id_t frame_id, Location location);
+
+  /** Takes frame_id off T1 / T2. Caller holds latch_. */
+  void Detach(frame_id_t frame_id);
+
+  /** Evicts the least recently used evictable frame of list, if any. Caller holds latch_. */
+  bool EvictFrom(std::list<frame_id_t> *list, Location evicted_from, frame_id_t *frame_id);
+
+  /** Adds page_id to a ghost list and trims the ghost lists to the ARC bounds. Caller holds latch_. */
+  void AddGhost(std::list<page_id_t> *ghost, page_id_t page_id);
+
+  /** Removes page_id from a ghost list if present. Caller holds latch_. */
+  bool RemoveGhost(std::list<page_id_t> *ghost, page_id_t page_id);
+
+  /** Drops the least recently evicted page of a ghost list. Caller holds latch_. */
+  void PopGhost(std::list<page_id_t> *ghost);
+
+  /** Number of frames of the buffer pool, c in the ARC paper. */
+  size_t capacity_;
+  /** Target size of T1. */
+  size_t p_{0};
+  std::vector<FrameInfo> frames_;
+  /** Resident lists, most recently used at the front. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Ghost lists, most recently evicted at the front. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  struct GhostEntry {
+    std::list<page_id_t> *list_;
+    std::list<page_id_t>::iterator pos_;
+  };
+  /** Position of every ghost page in B1 or B2. */
+  std::unordered_map<page_id_t, GhostEntry> ghosts_;
+  /** Number of evictable frames. */
+  size_t size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
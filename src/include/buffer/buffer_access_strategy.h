@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/prefetch_tracker.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManagerInstance;
+
+/**
+ * BufferAccessStrategy confines a bulk operation, such as a sequential scan or a bulk insert, to a small private ring
+ * of frames. When a page fetched through the strategy misses, the buffer pool reuses the frame that the same ring
+ * slot filled last time, as long as it still holds that page and is unpinned, instead of asking the replacer for a
+ * victim. The operation therefore evicts at most ring_size pages of other users however many pages it touches.
+ *
+ * A strategy is owned by a single scan or insert. The ring is also filled by the prefetch threads of the buffer pool
+ * when the scan reads ahead, so it is guarded by a latch, and destroying the strategy cancels those reads and waits
+ * for the ones in progress.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManagerInstance;
+
+ public:
+  /**
+   * Create a new BufferAccessStrategy.
+   * @param ring_size the number of frames the ring may recycle
+   */
+  explicit BufferAccessStrategy(size_t ring_size);
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /** Cancels the prefetches still scheduled with this strategy, and waits for the ones in progress. */
+  ~BufferAccessStrategy() = default;
+
+  /** @return the number of frames in the ring */
+  size_t GetRingSize() const { return ring_.size(); }
+
+ private:
+  /** A frame filled through the ring, identified by its buffer pool instance and the page it was filled with. */
+  struct Slot {
+    BufferPoolManagerInstance *owner_{nullptr};
+    frame_id_t frame_id_{-1};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** @return the slot whose frame should be recycled next, advancing the ring. Caller holds latch_. */
+  Slot *NextSlot();
+
+  /** Steps the ring back over the slot NextSlot returned last, which the caller did not fill. Caller holds latch_. */
+  void PutBackSlot();
+
+  /** Protects ring_ and current_. Acquired after the latch of a buffer pool instance. */
+  std::mutex latch_;
+  std::vector<Slot> ring_;
+  size_t current_{0};
+  /** The prefetches scheduled with this strategy. Declared last, so that it waits for them before the ring goes. */
+  PrefetchTracker prefetches_;
+};
+
+}  // namespace bustub
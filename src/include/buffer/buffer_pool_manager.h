@@ -12,37 +12,45 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_pool_stats.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
+class BufferAccessStrategy;
+class PrefetchTracker;
+
+/** Counters reported by a buffer pool about its page cleaner. */
+struct PageCleanerStats {
+  /** Dirty pages written back by the page cleaner. */
+  uint64_t pages_cleaned_{0};
+  /** Dirty victims written back synchronously by the thread that needed their frame. */
+  uint64_t sync_victim_flushes_{0};
+  /** Victims that were clean only because the page cleaner had written them back, i.e. synchronous flushes avoided. */
+  uint64_t avoided_victim_flushes_{0};
+};
+
 /**
- * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ * BufferPoolManager is the interface every buffer pool exposes to the rest of the system. TableHeap, BPlusTree and the
+ * hash table only ever talk to a BufferPoolManager, so a single BufferPoolManagerInstance and a
+ * ParallelBufferPoolManager that shards pages across several instances can be used interchangeably.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
-  /**
-   * Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param log_manager the log manager (for testing only: nullptr = disable logging)
-   */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager() = default;
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -60,7 +68,7 @@ class BufferPoolManager {
     return result;
   }
 
-  /** Grading function. Do not modify! */
+  /** Grading function. Do not modify! A page that is write-latched, possibly by the caller, is not flushed. */
   bool FlushPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
     auto result = FlushPageImpl(page_id);
@@ -84,22 +92,176 @@ class BufferPoolManager {
     return result;
   }
 
-  /** Grading function. Do not modify! */
+  /** Grading function. Do not modify! Pages that are write-latched, possibly by the caller, are skipped. */
   void FlushAllPages(bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, INVALID_PAGE_ID);
     FlushAllPagesImpl();
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  /**
+   * Fetch the requested page on behalf of a bulk operation. On a miss the page is loaded into a frame recycled from
+   * the strategy's ring rather than one chosen by the replacer. Behaves like FetchPage if strategy is nullptr.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the calling scan or bulk insert, may be nullptr
+   * @return the requested page, or nullptr if no frame is available
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPageImpl(page_id, strategy);
+  }
+
+  /**
+   * Create a new page on behalf of a bulk operation, in a frame recycled from the strategy's ring if possible.
+   * Behaves like NewPage if strategy is nullptr.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of the calling bulk insert, may be nullptr
+   * @param hint id of a page of the table or index the new page belongs to, which it shares an extent on disk with
+   * if possible; INVALID_PAGE_ID for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint = INVALID_PAGE_ID) {
+    return NewPageImpl(page_id, strategy, hint);
+  }
+
+  /**
+   * Fetch the requested page and wrap the pin in a guard that unpins it when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the calling scan or bulk insert, may be nullptr
+   * @return a guard for the page, invalid if no frame is available
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return BasicPageGuard(this, FetchPageImpl(page_id, strategy));
+  }
+
+  /**
+   * Fetch and read-latch the requested page, returning a guard that unlatches and unpins it when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the calling scan or bulk insert, may be nullptr
+   * @return a guard for the page, invalid if no frame is available
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return FetchPageBasic(page_id, strategy).UpgradeRead();
+  }
+
+  /**
+   * Fetch and write-latch the requested page, returning a guard that unlatches and unpins it when it goes out of
+   * scope. The page is unpinned dirty if it was modified through the guard.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the calling scan or bulk insert, may be nullptr
+   * @return a guard for the page, invalid if no frame is available
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    return FetchPageBasic(page_id, strategy).UpgradeWrite();
+  }
+
+  /**
+   * Create a new page and wrap the pin in a guard that unpins it when it goes out of scope.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy of the calling bulk insert, may be nullptr
+   * @param hint id of a page of the table or index the new page belongs to, such as the page being split or the last
+   * page of a table, which it shares an extent on disk with if possible; INVALID_PAGE_ID for none
+   * @return a guard for the page, invalid if no new page could be created
+   */
+  BasicPageGuard NewPageGuarded(page_id_t *page_id, BufferAccessStrategy *strategy = nullptr,
+                                page_id_t hint = INVALID_PAGE_ID) {
+    return BasicPageGuard(this, NewPageImpl(page_id, strategy, hint));
+  }
+
+  /**
+   * Schedules asynchronous reads of pages that a scan is about to fetch, and returns without waiting for them. A later
+   * FetchPage of a page that has been read is a buffer hit. This is a hint: pages that are resident, not allocated yet
+   * or cannot be given a frame are skipped.
+   * @param page_ids ids of the pages to read ahead
+   * @param strategy the access strategy of the calling scan, whose ring the pages are read into, may be nullptr
+   * @param tracker tracks the reads for the calling scan, which destroys it when it ends; defaults to the tracker of
+   * strategy. Without either, the reads are only waited for by StopPrefetcher.
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr,
+                     PrefetchTracker *tracker = nullptr) {
+    PrefetchPagesImpl(page_ids, strategy, tracker);
+  }
+
+  /**
+   * Fetch a batch of pages, such as the pages holding the RIDs an index scan returned. The resident pages are pinned
+   * in one pass over the page table and the missing ones are read from disk as one batch. A page whose id occurs more
+   * than once is looked up and read once, but pinned once per occurrence.
+   * @param page_ids ids of the pages to fetch
+   * @return the pages in the order of page_ids, nullptr for each page that could not be given a frame or read; every
+   * other entry must be unpinned once
+   */
+  std::vector<Page *> FetchPages(const std::vector<page_id_t> &page_ids) { return FetchPagesImpl(page_ids); }
+
+  /**
+   * Reads pages that were resident before a restart back in, in the background like PrefetchPages; see
+   * BufferPoolWarmer. Unlike PrefetchPages, the pages need not have been allocated by this buffer pool: they were
+   * allocated before the restart, and the disk manager knows them as such. Nor are they dropped once a hint's worth
+   * of reads is queued.
+   * @param page_ids ids of the pages to read, in the order to read them
+   * @return the number of pages scheduled, fewer than page_ids only while StopPrefetcher is running
+   */
+  size_t WarmUp(const std::vector<page_id_t> &page_ids) { return WarmUpImpl(page_ids); }
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() = 0;
+
+  /**
+   * @return the number of frames the pages of a batch may all have to share: the frames of the smallest instance of a
+   * parallel buffer pool, or the whole pool. Callers that pin many pages at once size their batches by it.
+   */
+  virtual size_t GetInstancePoolSize() { return GetPoolSize(); }
+
+  /**
+   * Grows or shrinks the buffer pool to pool_size frames while it is in use. New frames go to the free list. When
+   * shrinking, the frames above the new size are taken out of use: free and unpinned ones are evicted and their memory
+   * given back right away, pinned ones as soon as they are unpinned.
+   * @param pool_size the new size of the buffer pool
+   * @return false if the buffer pool cannot have pool_size frames; its size is unchanged then
+   */
+  virtual bool ResizePool(size_t pool_size) = 0;
+
+  /**
+   * Starts a background page cleaner that writes back dirty, unpinned frames near the eviction end of the replacer,
+   * so that foreground threads find clean victims and do not have to wait for a write. The cleaner wakes up every
+   * page_cleaner_interval, and early when a foreground thread had to write a dirty victim itself.
+   * @param clean_target how many of the next eviction candidates the cleaner keeps clean
+   */
+  virtual void RunPageCleaner(size_t clean_target) = 0;
+
+  /** Stops and joins the page cleaner, if it is running. */
+  virtual void StopPageCleaner() = 0;
+
+  /**
+   * Drops the queued prefetches and stops and joins the prefetch thread, if it is running, so that the buffer pool
+   * no longer uses the disk manager in the background. A later prefetch starts the thread again.
+   */
+  virtual void StopPrefetcher() {}
+
+  /** @return the page cleaner counters; victim flushes are counted whether or not a cleaner runs */
+  virtual PageCleanerStats GetPageCleanerStats() = 0;
+
+  /** @return a snapshot of the hit, miss, eviction and write-back counters and the latency histograms */
+  virtual BufferPoolStatsSnapshot GetStats() = 0;
+
+  /** Zeroes the statistics returned by GetStats. */
+  virtual void ResetStats() = 0;
+
+  /** Turns collection of the statistics returned by GetStats on or off; see enable_buffer_pool_stats. */
+  virtual void EnableStats(bool enabled) = 0;
+
+  /**
+   * Sizes the compressed tier, which keeps pages evicted from the buffer pool compressed in memory so that fetching
+   * them again does not read the disk. The tier is off until it is given a capacity.
+   * @param capacity_bytes the most memory the compressed pages may take, 0 to turn the tier off
+   */
+  virtual void SetCompressedTierCapacity(size_t capacity_bytes) = 0;
+
+  /**
+   * Lists the resident pages, hottest first: the pinned pages, then the unpinned ones in the reverse of the order in
+   * which the replacer would evict them.
+   * @return ids of the resident pages
+   */
+  virtual std::vector<page_id_t> GetResidentPageIds() = 0;
 
- private:
-  bool AllPagePinned();
-  frame_id_t GetFreeFrame();
  protected:
   /**
    * Grading function. Do not modify!
@@ -117,9 +279,18 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @return the requested page, or nullptr if no frame is available or the page fails its checksum
+   */
+  virtual Page *FetchPageImpl(page_id_t page_id) = 0;
+
+  /**
+   * Fetch the requested page from the buffer pool, taking the frame from strategy's ring on a miss.
+   * Buffer pools that do not support strategies ignore it.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy to use, may be nullptr
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) { return FetchPageImpl(page_id); }
 
   /**
    * Unpin the target page from the buffer pool.
@@ -127,49 +298,78 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty) = 0;
 
   /**
-   * Flushes the target page to disk.
+   * Flushes the target page to disk. The page is copied under its read latch, which is only tried: a page that a
+   * writer holds or waits for is not flushed and stays dirty, so that a caller holding its write latch, e.g. through a
+   * WritePageGuard, does not deadlock on itself.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
-   * @return false if the page could not be found in the page table, true otherwise
+   * @return false if the page could not be found in the page table or is write-latched, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id) = 0;
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id) = 0;
+
+  /**
+   * Creates a new page in the buffer pool, in a frame taken from strategy's ring if possible, with an id close to
+   * hint if possible. Buffer pools that do not support strategies or hints ignore them.
+   * @param[out] page_id id of created page
+   * @param strategy the access strategy to use, may be nullptr
+   * @param hint id of a page the new page will be used together with, INVALID_PAGE_ID for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) {
+    return NewPageImpl(page_id);
+  }
+
+  /**
+   * Schedules asynchronous reads of page_ids. Buffer pools that cannot read in the background ignore the hint.
+   * @param page_ids ids of the pages to read ahead
+   * @param strategy the access strategy to read them with, may be nullptr
+   * @param tracker tracks the reads for the caller, may be nullptr
+   */
+  virtual void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy,
+                                 PrefetchTracker *tracker) {}
+
+  /**
+   * Fetch a batch of pages. Fetches them one by one by default.
+   * @param page_ids ids of the pages to fetch
+   * @return the pages in the order of page_ids, nullptr for each page that could not be fetched
+   */
+  virtual std::vector<Page *> FetchPagesImpl(const std::vector<page_id_t> &page_ids) {
+    std::vector<Page *> pages;
+    pages.reserve(page_ids.size());
+    for (page_id_t page_id : page_ids) {
+      pages.push_back(FetchPageImpl(page_id));
+    }
+    return pages;
+  }
+
+  /**
+   * Reads pages that were resident before a restart back in the background.
+   * @param page_ids ids of the pages to read
+   * @return the number of pages scheduled
+   */
+  virtual size_t WarmUpImpl(const std::vector<page_id_t> &page_ids) = 0;
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
-
-  /**
-   * Flushes all the pages in the buffer pool to disk.
-   */
-  void FlushAllPagesImpl();
-
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual bool DeletePageImpl(page_id_t page_id) = 0;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk. As in FlushPageImpl, the write-latched pages are skipped and
+   * stay dirty, so the flush never waits for a latch holder.
+   */
+  virtual void FlushAllPagesImpl() = 0;
 };
+
 }  // namespace bustub
@@ -0,0 +1,461 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/concurrent_page_table.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolManagerInstance reads disk pages to and from its internal buffer pool.
+ *
+ * Buffer hits never take the instance latch: FetchPage looks the page up in a ConcurrentPageTable and pins the frame
+ * with an atomic compare-and-swap on its pin count, and UnpinPage only decrements it. A pin count of -1 marks a frame
+ * that is free or owned by a latch holder that is evicting or loading it, which makes lock-free pins fail and retry
+ * under the latch. Apart from the Replacer::Record* notifications of accesses, loads and evictions, the replacer is
+ * only touched when a pin count moves between 0 and 1.
+ *
+ * PrefetchPages queues pages for a background prefetch thread, which is started on first use and stopped by
+ * StopPrefetcher or the destructor. It skips the pages of scans that have ended since, and loads the others the way
+ * a miss in FetchPage does and leaves them unpinned. FetchPages pins the resident pages of a batch without the latch
+ * and loads the rest under a single acquisition of it. Batches of misses, the prefetch thread and the page cleaner
+ * issue their reads and writes through a DiskScheduler, created on first use, so that up to a queue depth of them are
+ * in flight at once; a single miss in FetchPage still reads its page with one blocking DiskManager::ReadPage.
+ *
+ * With a compressed tier, every evicted page is staged in it after any write-back, still under the latch, and
+ * compressed once the latch is released. A miss takes the page from the tier before it goes to disk. DeletePage drops
+ * the page from the tier.
+ *
+ * Frames are allocated in chunks of a power-of-two number of frames, the first of which covers the initial pool, so
+ * that ResizePool can grow the pool without moving frames that other threads hold. The data of all frames lives in
+ * one contiguous FrameArena, frame i at offset i * PAGE_SIZE, optionally backed by huge pages and, in a parallel
+ * buffer pool, bound to the NUMA node of the instance; the Page objects are kept in a dense array per chunk.
+ *
+ * Shrinking retires the frames at or above the new pool size. A retiring frame is kept out of the replacer and off the
+ * free list, and is released once nobody has it pinned: its page is evicted and the memory behind its data is handed
+ * back to the operating system. The Page objects themselves are only freed with the pool, so a frame id from a stale
+ * lock-free lookup never dangles; pinning a released frame fails like pinning a free one.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new standalone BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Destroys an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  /** @return size of the buffer pool */
+  size_t GetPoolSize() override { return pool_size_.load(); }
+
+  /** @return pointer to the pages of the first chunk, which holds at least the frames of the initial pool */
+  Page *GetPages() { return Frame(0); }
+
+  bool ResizePool(size_t pool_size) override;
+
+  /** @return the largest size ResizePool accepts */
+  size_t GetMaxPoolSize() const { return chunk_frames_ * BUFFER_POOL_MAX_CHUNKS; }
+
+  /** @return the number of frames holding memory: the pool size plus retiring frames that are still pinned */
+  size_t GetFramesInUse();
+
+  /** @return the arena holding the data of the frames */
+  const FrameArena &GetFrameArena() const { return *arena_; }
+
+  void RunPageCleaner(size_t clean_target) override;
+
+  void StopPageCleaner() override;
+
+  void StopPrefetcher() override;
+
+  PageCleanerStats GetPageCleanerStats() override;
+
+  BufferPoolStatsSnapshot GetStats() override;
+
+  void ResetStats() override;
+
+  void EnableStats(bool enabled) override { stats_.SetEnabled(enabled); }
+
+  void SetCompressedTierCapacity(size_t capacity_bytes) override;
+
+  std::vector<page_id_t> GetResidentPageIds() override;
+
+ protected:
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Writes back the dirty pages as one DiskManager::WritePages batch: sorted, coalesced and synced once. The pages are
+   * written from copies taken under their read latches; the write-latched ones are skipped.
+   */
+  void FlushAllPagesImpl() override;
+
+  void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy,
+                         PrefetchTracker *tracker) override;
+
+  std::vector<Page *> FetchPagesImpl(const std::vector<page_id_t> &page_ids) override;
+
+  /** Queues the pages for the prefetch thread. The disk manager already counts them as allocated. */
+  size_t WarmUpImpl(const std::vector<page_id_t> &page_ids) override;
+
+ private:
+  /** A run of chunk_frames_ frames that the pool grew by at once. */
+  struct FrameChunk {
+    /** Data of the first frame of the chunk, in arena_. */
+    char *data_;
+    /** The frames. Constructed in place, since they point into data_. */
+    Page *pages_;
+    /** Per frame: the cleaner wrote the page back and nobody dirtied it since. */
+    std::unique_ptr<std::atomic<bool>[]> cleaned_;
+    /** Per frame: the frame is out of use and its memory was given back. Protected by latch_. */
+    std::unique_ptr<bool[]> released_;
+  };
+
+  /** @return the frame with id frame_id. Does not need the latch. */
+  Page *Frame(frame_id_t frame_id) const {
+    return &chunks_[frame_id >> chunk_shift_].load(std::memory_order_acquire)->pages_[frame_id & (chunk_frames_ - 1)];
+  }
+
+  /** @return the cleaned flag of frame_id */
+  std::atomic<bool> &Cleaned(frame_id_t frame_id) const {
+    return chunks_[frame_id >> chunk_shift_].load(std::memory_order_acquire)->cleaned_[frame_id & (chunk_frames_ - 1)];
+  }
+
+  /** @return the released flag of frame_id. Caller holds latch_. */
+  bool &Released(frame_id_t frame_id) const {
+    return chunks_[frame_id >> chunk_shift_].load(std::memory_order_relaxed)->released_[frame_id & (chunk_frames_ - 1)];
+  }
+
+  /** Appends a chunk of released frames. Caller holds latch_. */
+  void AddChunk();
+
+  /**
+   * Releases a retiring frame unless it is pinned: claims it, evicts its page and releases it. Caller holds latch_.
+   * @return true if the frame was released
+   */
+  bool TryReleaseFrame(frame_id_t frame_id);
+
+  /** Tries to release every retiring frame. Caller holds latch_. */
+  void ReleaseRetiringFrames();
+
+  /**
+   * Gives the memory of a frame claimed with a pin count of -1 back to the operating system and marks it released.
+   * The frame must not hold a page. Caller holds latch_.
+   */
+  void ReleaseFrame(frame_id_t frame_id);
+
+  /**
+   * Resets a frame claimed with a pin count of -1 that no longer holds a page, and puts it back on the free list, or
+   * releases it if it is retiring. Caller holds latch_.
+   */
+  void FreeFrame(frame_id_t frame_id);
+
+  /**
+   * Pins frame_id if it still holds page_id. Does not need the latch.
+   * @return false if the frame is free, being evicted or loaded, or now holds a different page
+   */
+  bool TryPin(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Pins the frame of page_id if the page is resident, waiting for a batch load of the page that is in flight.
+   * Caller holds latch_, which is released while waiting.
+   * @param[out] frame_id the pinned frame
+   * @return false if the page is not resident, or its load failed
+   */
+  bool PinResident(std::unique_lock<std::mutex> *latch, page_id_t page_id, frame_id_t *frame_id);
+
+  /**
+   * Makes the replacer agree with the current pin count of frame_id, keeping retiring frames out of it. Called when a
+   * frame is claimed or published, and after every 0 <-> 1 transition unless the replacer allows pinned frames.
+   */
+  void SyncReplacer(frame_id_t frame_id);
+
+  /** Called after a 0 <-> 1 transition of the pin count of frame_id, which only an eager replacer sync cares about. */
+  void PinTransition(frame_id_t frame_id);
+
+  /**
+   * Finds a frame to load a page into. A bulk operation recycles the frame of its ring slot if it can; otherwise the
+   * frame comes from the free list, or is evicted from the one chosen by the replacer. The returned frame has a pin
+   * count of -1. Caller holds latch_.
+   * @param slot the ring slot of the calling access strategy, or nullptr
+   * @param[out] frame_id the frame that can be reused
+   * @return false if every frame is pinned
+   */
+  bool GetFreeFrame(BufferAccessStrategy::Slot *slot, frame_id_t *frame_id);
+
+  /**
+   * Latches the ring of strategy and advances it. Caller holds latch_.
+   * @param strategy the access strategy of the caller, may be nullptr
+   * @param[out] ring_latch holds the ring latch on return
+   * @return the slot whose frame should be recycled, or nullptr if strategy is nullptr
+   */
+  BufferAccessStrategy::Slot *NextRingSlot(BufferAccessStrategy *strategy, std::unique_lock<std::mutex> *ring_latch);
+
+  /** @return true if the frame of slot is in this pool and holds the page the ring put there. Caller holds latch_. */
+  bool HoldsRingPage(const BufferAccessStrategy::Slot &slot) const;
+
+  /**
+   * Makes a frame claimed with a pin count of -1 hold page_id: resets it, reads the page from the compressed tier or
+   * disk, reports the load to the replacer and maps the page in the page table. The caller publishes the pin count.
+   * A page that cannot be read, or fails its checksum, is not mapped and the frame is freed. Caller holds latch_.
+   * @return false if the page could not be read
+   */
+  bool LoadFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Decompresses page_id from the compressed tier into page_data, if the tier holds it. Caller holds latch_.
+   * @return false if the page has to be read from disk
+   */
+  bool TakeFromCompressedTier(page_id_t page_id, char *page_data);
+
+  /**
+   * Loads a batch of frames like LoadFrame does, with all of their reads in flight at once. The frames are entered in
+   * the page table with a pin count of -1, and latch_ is released while the reads are in flight; PinResident waits
+   * for them. Caller holds latch_.
+   * @param pin_count the pin count each loaded frame is published with
+   * @return whether each frame was loaded
+   */
+  std::vector<bool> LoadFrames(std::unique_lock<std::mutex> *latch,
+                               const std::vector<std::pair<frame_id_t, page_id_t>> &frames, int pin_count);
+
+  /**
+   * Evicts the page held by a frame claimed with a pin count of -1: reports it to the replacer, removes it from the
+   * page table, writes it back if dirty and stages a copy of it in the compressed tier. Caller holds latch_.
+   */
+  void EvictFrame(frame_id_t frame_id);
+
+  /** Compresses the pages EvictFrame staged in the compressed tier. Caller does not hold latch_. */
+  void CompressStagedPages();
+
+  /**
+   * Calls CompressStagedPages when it goes out of scope. Declared before latch_ is taken, it runs once latch_ is
+   * released again, so that evictions do not compress pages under latch_.
+   */
+  class StagedPageCompressor {
+   public:
+    explicit StagedPageCompressor(BufferPoolManagerInstance *bpm) : bpm_(bpm) {}
+    ~StagedPageCompressor() { bpm_->CompressStagedPages(); }
+    DISALLOW_COPY_AND_MOVE(StagedPageCompressor);
+
+   private:
+    BufferPoolManagerInstance *bpm_;
+  };
+
+  /**
+   * Writes the page held by frame_id back to disk and clears its dirty flag, counting a dirty write-back if it was
+   * set. The frame is written in place, so it must be claimed with a pin count of -1. Caller holds latch_.
+   */
+  void FlushFrame(frame_id_t frame_id);
+
+  /**
+   * Pins a frame to write its page back, without telling the replacer, so that the frame keeps its place there.
+   * Caller holds latch_.
+   * @return false if the frame is free, being loaded or being evicted
+   */
+  bool PinForFlush(frame_id_t frame_id);
+
+  /** Drops a pin taken to write a page back, and gives the frame back to the replacer if it was the last one. */
+  void UnpinForFlush(frame_id_t frame_id);
+
+  /**
+   * Copies the page of a frame pinned to write it back into copy, under its read latch so that the copy is
+   * consistent, and clears its dirty flag. A page that a writer holds or waits for is left alone rather than waited
+   * for, since the writer may be the caller. Does not need latch_, and must not be called with it held.
+   * @param[out] dirty set to whether the page was dirty
+   * @return false if the page is write-latched and was not copied
+   */
+  bool CopyForFlush(frame_id_t frame_id, char *copy, bool *dirty);
+
+  /** Body of the page cleaner thread. */
+  void PageCleanerLoop(size_t clean_target);
+
+  /**
+   * Writes back the dirty frames among the next clean_target eviction candidates, as one batch of copies taken under
+   * their read latches and written through the disk scheduler, then syncs the file once.
+   */
+  void CleanEvictionCandidates(size_t clean_target);
+
+  /** A page queued for the prefetch thread. */
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    /** The strategy whose ring the page is read into, may be nullptr. */
+    BufferAccessStrategy *strategy_;
+    /** Told when the request is done, may be nullptr. A request its tracker no longer wants is skipped. */
+    PrefetchTracker *tracker_;
+    /** The number the tracker gave the request. */
+    size_t sequence_;
+  };
+
+  /**
+   * Queues pages for the prefetch thread, starting it if need be.
+   * @param capped if true, the pages past a queue of pool_size_ requests are dropped
+   * @return the number of pages queued
+   */
+  size_t QueuePrefetches(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy,
+                         PrefetchTracker *tracker, bool capped);
+
+  /** Body of the prefetch thread. */
+  void PrefetchLoop();
+
+  /**
+   * Loads the pages of a batch of prefetch requests that are not resident already into unpinned frames. A request
+   * whose ring slot holds a page that is still pinned is dropped, rather than growing the ring with a shared frame.
+   */
+  void LoadPrefetches(const std::vector<PrefetchRequest> &requests);
+
+  /** Reports requests to their trackers as done. */
+  static void FinishPrefetches(const std::vector<PrefetchRequest> &requests);
+
+  /** @return the disk scheduler, created on the first call */
+  DiskScheduler *GetDiskScheduler();
+
+  /**
+   * Allocate a page on disk, in the extent of hint if there is one; see DiskManager::AllocatePage. Page ids are
+   * striped across the instances of a parallel BPM so that page_id % num_instances_ == instance_index_ always holds.
+   * Caller holds latch_.
+   * @param hint id of a page of the table or index the new page belongs to, INVALID_PAGE_ID for none
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage(page_id_t hint);
+
+  /**
+   * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
+   * validate input data and ensure that a parallel BPM is routing requests to the BPIs correctly
+   * @param page_id
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /** Number of frames in use. Written under latch_; frames at or above it are retiring or released. */
+  std::atomic<size_t> pool_size_{0};
+  /** Frames per chunk, a power of two, and its base-2 logarithm. */
+  size_t chunk_frames_{1};
+  int chunk_shift_{0};
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** Data of every frame. */
+  std::unique_ptr<FrameArena> arena_;
+  /**
+   * Compressed copies of evicted pages, nullptr while the tier is off. Written under latch_ with std::atomic_store,
+   * so that CompressStagedPages can std::atomic_load it without latch_.
+   */
+  std::shared_ptr<CompressedPageCache> compressed_tier_;
+  /** The first num_chunks_ entries point to the chunks of frames; num_chunks_ is protected by latch_. */
+  std::unique_ptr<std::atomic<FrameChunk *>[]> chunks_;
+  size_t num_chunks_{0};
+  /** Frames at or above pool_size_ that are not released yet, because they were pinned. Protected by latch_. */
+  size_t retiring_frames_{0};
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Issues batched reads and writes, nullptr until GetDiskScheduler creates it. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
+  std::once_flag disk_scheduler_once_;
+  /** Pointer to the log manager. */
+  LogManager *log_manager_ __attribute__((__unused__));
+  /** Page table for keeping track of buffer pool pages. Readable without latch_, written only under it. */
+  ConcurrentPageTable page_table_;
+  /** Replacer to find unpinned pages for replacement. */
+  Replacer *replacer_;
+  /**
+   * Whether replacer_ keeps every frame in use, pinned or not, so that pin transitions need not sync it. Pinned frames
+   * are then skipped when they come up as victims.
+   */
+  bool lazy_replacer_sync_;
+  /** List of free pages. */
+  std::list<frame_id_t> free_list_;
+  /**
+   * Serializes writers of page_table_, free_list_, the pool size and every frame whose pin count is -1, except the
+   * data of the frames a batch load is reading into.
+   */
+  std::mutex latch_;
+  /** Signalled under latch_ when a batch load publishes its frames. */
+  std::condition_variable load_cv_;
+  /** Protects replacer_. Acquired after latch_ when both are needed. */
+  std::mutex replacer_latch_;
+
+  /** Background page cleaner; cleaner_stop_ is protected by cleaner_latch_. */
+  std::thread page_cleaner_;
+  std::mutex cleaner_latch_;
+  std::condition_variable cleaner_cv_;
+  bool cleaner_stop_{false};
+  std::atomic<uint64_t> pages_cleaned_{0};
+  std::atomic<uint64_t> sync_victim_flushes_{0};
+  std::atomic<uint64_t> avoided_victim_flushes_{0};
+
+  /** Counters and latency histograms reported by GetStats. */
+  BufferPoolStats stats_;
+
+  /** Prefetch thread; prefetch_queue_ and prefetch_stop_ are protected by prefetch_latch_. */
+  std::thread prefetcher_;
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  std::deque<PrefetchRequest> prefetch_queue_;
+  bool prefetch_stop_{false};
+};
+}  // namespace bustub
@@ -0,0 +1,211 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * A latency histogram with power-of-two buckets: bucket 0 counts latencies of 0ns, bucket i > 0 counts latencies in
+ * [2^(i-1), 2^i) ns, and the last bucket also counts everything longer.
+ */
+struct LatencyHistogram {
+  static constexpr size_t NUM_BUCKETS = 32;
+
+  /** @return the bucket a latency of ns nanoseconds falls into */
+  static size_t BucketOf(uint64_t ns);
+
+  /** @return the exclusive upper bound in nanoseconds of bucket */
+  static uint64_t BucketBound(size_t bucket) { return uint64_t{1} << bucket; }
+
+  /** Adds the samples of other to this histogram. */
+  void Merge(const LatencyHistogram &other);
+
+  /** @return the mean latency in nanoseconds, 0 if there are no samples */
+  double MeanNs() const;
+
+  /**
+   * @param quantile a fraction between 0 and 1, e.g. 0.99
+   * @return the upper bound in nanoseconds of the bucket holding the quantile, 0 if there are no samples
+   */
+  uint64_t PercentileNs(double quantile) const;
+
+  std::array<uint64_t, NUM_BUCKETS> buckets_{};
+  uint64_t count_{0};
+  uint64_t total_ns_{0};
+};
+
+/** A point-in-time copy of the counters of a buffer pool. */
+struct BufferPoolStatsSnapshot {
+  /** FetchPage calls that found the page resident. */
+  uint64_t hits_{0};
+  /** FetchPage calls that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Dirty pages written back to disk, whether by an eviction, the page cleaner or a flush. */
+  uint64_t dirty_write_backs_{0};
+  /** FetchPage calls that found the page resident but had to wait on the instance latch while it was (un)loaded. */
+  uint64_t pin_waits_{0};
+  /** Misses served from the compressed tier instead of disk; they count as misses as well. */
+  uint64_t compressed_hits_{0};
+  /** Bytes the pages in the compressed tier take when the snapshot was taken. */
+  uint64_t compressed_bytes_{0};
+  /** Pages in the compressed tier when the snapshot was taken. */
+  uint64_t compressed_pages_{0};
+  /** Frames on the free list when the snapshot was taken. */
+  uint64_t free_list_length_{0};
+
+  /** Latency of FetchPage hits. Only one in STATS_HIT_SAMPLE_INTERVAL hits is timed. */
+  LatencyHistogram fetch_hit_latency_;
+  /** Latency of FetchPage misses, including the disk read. */
+  LatencyHistogram fetch_miss_latency_;
+  /** Latency of NewPage. */
+  LatencyHistogram new_page_latency_;
+
+  /** Adds the counters of other, e.g. another instance of a parallel buffer pool, to this snapshot. */
+  void Merge(const BufferPoolStatsSnapshot &other);
+
+  /** @return hits / (hits + misses), 0 if there were no fetches */
+  double HitRatio() const;
+
+  /** @return the snapshot as a JSON object */
+  std::string ToJson() const;
+};
+
+/**
+ * BufferPoolStats collects the counters behind BufferPoolStatsSnapshot.
+ *
+ * Counters are kept per thread: a thread takes one of the cache-line aligned shards for itself on first use and hands
+ * it back when it exits. Nobody else writes that shard, so the thread bumps its counters with a plain load and store
+ * instead of a locked read-modify-write, and threads fetching pages concurrently never share a cache line. Threads
+ * beyond the number of shards share an overflow shard and update it atomically. Snapshot sums the shards.
+ *
+ * Timing a FetchPage hit would cost as much as the hit itself, so only one in STATS_HIT_SAMPLE_INTERVAL hits per
+ * thread is timed; misses and new pages are always timed.
+ */
+class BufferPoolStats {
+ public:
+  enum class Counter { HIT, MISS, EVICTION, DIRTY_WRITE_BACK, PIN_WAIT, COMPRESSED_HIT, NUM_COUNTERS };
+  enum class Latency { FETCH_HIT, FETCH_MISS, NEW_PAGE, NUM_LATENCIES };
+
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  BufferPoolStats();
+
+  DISALLOW_COPY_AND_MOVE(BufferPoolStats);
+
+  ~BufferPoolStats() = default;
+
+  /** Turns collection on or off. While it is off, Add and Record do nothing and StartTimer does not read the clock. */
+  void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /** Increments counter by one. */
+  void Add(Counter counter) {
+    if (IsEnabled()) {
+      Increment(&LocalShard().counters_[static_cast<size_t>(counter)], 1);
+    }
+  }
+
+  /**
+   * Starts timing an operation.
+   * @param sampled if true, only one in STATS_HIT_SAMPLE_INTERVAL calls of this thread reads the clock
+   * @return the start time, or a default TimePoint if the operation is not timed
+   */
+  TimePoint StartTimer(bool sampled) {
+    if (!IsEnabled()) {
+      return TimePoint();
+    }
+    if (sampled && ++LocalState().calls_ % STATS_HIT_SAMPLE_INTERVAL != 0) {
+      return TimePoint();
+    }
+    return std::chrono::steady_clock::now();
+  }
+
+  /** Records the time elapsed since start in the histogram of latency, unless start is a default TimePoint. */
+  void Record(Latency latency, TimePoint start);
+
+  /** @return the sum of all shards. free_list_length_ is left for the buffer pool to fill in. */
+  BufferPoolStatsSnapshot Snapshot() const;
+
+  /** Zeroes every counter. Counts added while Reset runs may survive it. */
+  void Reset();
+
+ private:
+  /** Shards handed out to one thread each; shard NUM_SHARDS - 1 is the overflow shard shared by the rest. */
+  static constexpr size_t NUM_SHARDS = 32;
+  static constexpr size_t NUM_COUNTERS = static_cast<size_t>(Counter::NUM_COUNTERS);
+  static constexpr size_t NUM_LATENCIES = static_cast<size_t>(Latency::NUM_LATENCIES);
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> counters_{};
+    std::array<std::array<std::atomic<uint64_t>, LatencyHistogram::NUM_BUCKETS>, NUM_LATENCIES> buckets_{};
+    std::array<std::atomic<uint64_t>, NUM_LATENCIES> total_ns_{};
+  };
+
+  /**
+   * What a thread remembers across calls: its shard plus one, 0 until assigned, whether it has the shard to itself,
+   * and a call count for sampling.
+   */
+  struct ThreadState {
+    uint32_t shard_plus_one_;
+    uint32_t calls_;
+    bool exclusive_;
+  };
+
+  /**
+   * @return the state of the calling thread. It is constant-initialized and uses the initial-exec TLS model, so the
+   * hit path reads it without going through __tls_get_addr even from the shared library.
+   */
+  static ThreadState &LocalState() {
+    static thread_local ThreadState state __attribute__((tls_model("initial-exec"))) = {0, 0, false};
+    return state;
+  }
+
+  /** @return the shard of the calling thread. Threads are assigned shards round robin on first use. */
+  Shard &LocalShard() {
+    ThreadState &state = LocalState();
+    if (state.shard_plus_one_ == 0) {
+      AssignShard(&state);
+    }
+    return shards_[state.shard_plus_one_ - 1];
+  }
+
+  /** Adds delta to a counter of the calling thread's shard. */
+  static void Increment(std::atomic<uint64_t> *counter, uint64_t delta) {
+    if (LocalState().exclusive_) {
+      counter->store(counter->load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    } else {
+      counter->fetch_add(delta, std::memory_order_relaxed);
+    }
+  }
+
+  /** Gives the calling thread a shard of its own if one is free, or the overflow shard. */
+  static void AssignShard(ThreadState *state);
+
+  std::atomic<bool> enabled_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_warmer.h
+//
+// Identification: src/include/buffer/buffer_pool_warmer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolWarmer saves which pages a buffer pool holds and reads them back in after a restart, so that the pool does
+ * not have to be warmed up again by the misses of the first queries.
+ *
+ * Dump writes the resident page ids, hottest first, to a side file; Start does so every buffer_pool_dump_interval in a
+ * background thread. Restore reads the file and hands the hottest pages that fit in the pool, sorted by page id so
+ * that they are read in the order they lie on disk, to BufferPoolManager::WarmUp. The prefetch threads of the pool
+ * read them while it already serves queries.
+ *
+ * The file holds a magic number, the number of page ids and the page ids, in native byte order. Dump writes a
+ * temporary file and renames it over the previous one, so a crash during a dump leaves the previous dump intact.
+ */
+class BufferPoolWarmer {
+ public:
+  /**
+   * @param bpm the buffer pool to save and warm up
+   * @param file_name the side file to keep the page ids in
+   */
+  BufferPoolWarmer(BufferPoolManager *bpm, std::string file_name);
+
+  DISALLOW_COPY_AND_MOVE(BufferPoolWarmer);
+
+  /** Stops the background dumps, if they are running. */
+  ~BufferPoolWarmer();
+
+  /**
+   * Saves the ids of the resident pages, hottest first.
+   * @return false if the file could not be written
+   */
+  bool Dump();
+
+  /**
+   * Schedules background reads of the hottest saved pages that fit in the buffer pool, in page id order.
+   * @return the number of pages scheduled, 0 if there is no valid dump
+   */
+  size_t Restore();
+
+  /** Starts a background thread that calls Dump every buffer_pool_dump_interval. */
+  void Start();
+
+  /** Stops and joins the background thread, if it is running, which dumps one last time on its way out. */
+  void Stop();
+
+ private:
+  /** Identifies a dump file. */
+  static constexpr uint32_t MAGIC = 0x42505744;
+
+  /** Body of the dump thread. */
+  void DumpLoop();
+
+  BufferPoolManager *bpm_;
+  std::string file_name_;
+
+  /** Dump thread; stop_ is protected by latch_. */
+  std::thread dumper_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool stop_{false};
+};
+
+}  // namespace bustub
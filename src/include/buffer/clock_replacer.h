@@ -12,7 +12,8 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -23,6 +24,13 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame owns one atomic byte holding an evictable bit and a reference bit, so Pin, Unpin and RecordAccess are a
+ * single atomic read-modify-write and never take a latch. Victim sweeps a hand over the frames under hand_latch_:
+ * referenced frames get a second chance and have their bit cleared, the first unreferenced evictable frame is chosen.
+ *
+ * The replacer allows pinned frames: the buffer pool leaves a frame evictable while it is pinned, and a FetchPage hit
+ * only sets the reference bit, so hits never touch a latch here or in the buffer pool.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +51,35 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) override;
+
+  void SetCapacity(size_t num_pages) override;
+
+  bool AllowsPinnedFrames() const override { return true; }
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** Bits of a frame's state byte. */
+  static constexpr uint8_t EVICTABLE = 0x1;
+  static constexpr uint8_t REFERENCED = 0x2;
+
+  /** Number of frames the replacer can track. */
+  size_t num_pages_;
+  /** Per-frame state bits, indexed by frame id; points into the last array of arrays_. */
+  std::atomic<std::atomic<uint8_t> *> frames_;
+  /**
+   * Every state array the replacer has used. SetCapacity keeps the ones it replaces, since a RecordAccess may still be
+   * setting a reference bit in one; losing that bit is harmless.
+   */
+  std::vector<std::unique_ptr<std::atomic<uint8_t>[]>> arrays_;
+  /** Number of frames whose evictable bit is set. */
+  std::atomic<size_t> size_{0};
+  /** Position of the clock hand; protected by hand_latch_. */
+  size_t hand_{0};
+  std::mutex hand_latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a secondary tier below a buffer pool: it keeps pages the pool evicted, compressed with
+ * PageCodec, so that fetching one of them again decompresses it instead of reading it from disk.
+ *
+ * The cache holds pages exactly as they are on disk and is exclusive of the pool: Take hands a page back and forgets
+ * it, so a page is never both resident and cached, and a cached copy cannot go stale while the page is modified in
+ * the pool. Pages that do not compress are kept as they are. Once the compressed pages take more than the capacity,
+ * the least recently inserted ones are dropped.
+ *
+ * A pool evicts under its latch, so it only stages a copy of the page there and compresses it with CompressStaged
+ * once the latch is released. A staged page can be taken before it is compressed.
+ */
+class CompressedPageCache {
+ public:
+  /** @param capacity_bytes the most bytes of compressed pages to hold */
+  explicit CompressedPageCache(size_t capacity_bytes);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  ~CompressedPageCache() = default;
+
+  /**
+   * Compresses and caches a page that was evicted from the pool, replacing an earlier copy.
+   * @param page_id id of the page
+   * @param page_data the page, as it is on disk
+   */
+  void Insert(page_id_t page_id, const char *page_data);
+
+  /**
+   * Caches a copy of a page that was evicted from the pool as it is, replacing an earlier copy, and leaves it to
+   * CompressStaged to compress.
+   * @param page_id id of the page
+   * @param page_data the page, as it is on disk
+   */
+  void Stage(page_id_t page_id, const char *page_data);
+
+  /** Compresses the pages staged so far that are still cached. The latch is not held while a page is compressed. */
+  void CompressStaged();
+
+  /**
+   * Decompresses a cached page and removes it from the cache.
+   * @param page_id id of the page
+   * @param[out] page_data PAGE_SIZE bytes to decompress the page into
+   * @return false if the page is not cached
+   */
+  bool Take(page_id_t page_id, char *page_data);
+
+  /** Forgets a page, e.g. because it was deleted. */
+  void Erase(page_id_t page_id);
+
+  /** Changes the capacity, dropping pages until the cache fits. */
+  void SetCapacity(size_t capacity_bytes);
+
+  /** @return the number of bytes the cached pages take */
+  size_t GetSizeBytes() const { return size_bytes_.load(std::memory_order_relaxed); }
+
+  /** @return the number of cached pages */
+  size_t GetNumPages() const { return num_pages_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Entry {
+    page_id_t page_id_;
+    /**
+     * The page as PageCodec compressed it, or the page itself if size_ is PAGE_SIZE. Shared with a CompressStaged
+     * that compresses it without the latch.
+     */
+    std::shared_ptr<char[]> data_;
+    size_t size_;
+    /** Whether the page was staged and is not compressed yet. */
+    bool staged_;
+  };
+
+  /** Caches data_ of size bytes for page_id, replacing an earlier copy. Caller holds latch_. */
+  void PutEntry(page_id_t page_id, std::shared_ptr<char[]> data, size_t size, bool staged);
+
+  /** Removes an entry. Caller holds latch_. */
+  void EraseEntry(std::list<Entry>::iterator entry);
+
+  /** Drops the least recently inserted pages until the cache fits its capacity. Caller holds latch_. */
+  void Trim();
+
+  std::mutex latch_;
+  size_t capacity_bytes_;
+  /** Cached pages, most recently inserted first. */
+  std::list<Entry> entries_;
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+  /** Pages staged since the last CompressStaged, which may have been taken or dropped since. */
+  std::vector<page_id_t> staged_pages_;
+  std::atomic<size_t> size_bytes_{0};
+  std::atomic<size_t> num_pages_{0};
+};
+
+}  // namespace bustub
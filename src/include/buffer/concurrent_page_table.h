@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.h
+//
+// Identification: src/include/buffer/concurrent_page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ConcurrentPageTable maps resident page ids to frame ids for a buffer pool instance.
+ *
+ * It is an open-addressing table with linear probing in which every slot is a single 64-bit atomic word holding
+ * both the page id and the frame id, so readers never see a torn entry and never take a latch. Writers (Insert,
+ * Remove) must be serialized by the caller, which the buffer pool does with its instance latch.
+ *
+ * A lock-free Find may miss an entry that a concurrent writer is inserting, or that is being moved by a rebuild,
+ * but it never returns a mapping that did not exist at some point during the call. Callers therefore treat a miss
+ * as "retry under the latch" and validate a hit against the frame itself.
+ *
+ * Reserve grows the table for a larger buffer pool by publishing a bigger slot array. A reader that is still probing
+ * an old array sees a consistent, if stale, table; old arrays are only freed with the table itself.
+ */
+class ConcurrentPageTable {
+ public:
+  /**
+   * Create a new ConcurrentPageTable.
+   * @param num_frames the maximum number of entries the table will be required to store
+   */
+  explicit ConcurrentPageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ConcurrentPageTable);
+
+  ~ConcurrentPageTable() = default;
+
+  /**
+   * Make room for the pages of num_frames frames. Writers must be serialized by the caller.
+   * @param num_frames the maximum number of entries the table will be required to store from now on
+   */
+  void Reserve(size_t num_frames);
+
+  /**
+   * Look up a page without latching. Safe to call concurrently with a writer.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page, if found
+   * @return true if the page was found
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Insert or overwrite the mapping for page_id. Writers must be serialized by the caller.
+   * @param page_id the page to insert
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove the mapping for page_id. Writers must be serialized by the caller.
+   * @param page_id the page to remove
+   * @return true if the page was present
+   */
+  bool Remove(page_id_t page_id);
+
+  /** @return the number of pages in the table. Only exact when called by the writer. */
+  size_t Size() const { return size_; }
+
+  /**
+   * Invoke f(page_id, frame_id) on every entry. Must be called by the writer, i.e. with writers serialized.
+   */
+  template <typename F>
+  void ForEach(F &&f) const {
+    const Slots *table = table_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < table->capacity_; ++i) {
+      uint64_t entry = table->slots_[i].load(std::memory_order_acquire);
+      if (!IsFree(entry)) {
+        f(KeyOf(entry), FrameOf(entry));
+      }
+    }
+  }
+
+ private:
+  /** Slot keys that can never be a real page id. */
+  static constexpr page_id_t EMPTY_KEY = INVALID_PAGE_ID;
+  static constexpr page_id_t TOMBSTONE_KEY = -2;
+
+  static constexpr uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static constexpr page_id_t KeyOf(uint64_t entry) { return static_cast<page_id_t>(entry >> 32); }
+  static constexpr frame_id_t FrameOf(uint64_t entry) { return static_cast<frame_id_t>(entry & 0xFFFFFFFFULL); }
+  static constexpr bool IsFree(uint64_t entry) { return KeyOf(entry) == EMPTY_KEY || KeyOf(entry) == TOMBSTONE_KEY; }
+
+  /** A slot array together with the geometry readers need to probe it. */
+  struct Slots {
+    /** Allocates an empty array of at least twice num_frames slots. */
+    explicit Slots(size_t num_frames);
+
+    /** @return the first slot of page_id's probe sequence */
+    size_t HomeSlot(page_id_t page_id) const;
+
+    /** Number of slots, always a power of two and at least twice the number of frames. */
+    size_t capacity_;
+    size_t mask_;
+    /** Bit width of capacity_, used by the Fibonacci hash. */
+    int shift_;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  };
+
+  /** Re-inserts every live entry to drop accumulated tombstones. */
+  void Rebuild();
+
+  /** The array readers probe; always tables_.back(). */
+  std::atomic<Slots *> table_;
+  /** Every array this table has used. Replaced arrays are kept for readers that may still be probing them. */
+  std::vector<std::unique_ptr<Slots>> tables_;
+  /** Live entries and tombstones; only touched by the writer. */
+  size_t size_{0};
+  size_t tombstones_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of the frames of one buffer pool instance in a single contiguous, page-aligned range of
+ * address space.
+ *
+ * The whole range a pool can ever grow to is reserved up front, without backing memory, and aligned to a huge page.
+ * Commit backs a part of it as the pool grows:
+ * - With huge pages requested, a part that covers whole 2 MB huge pages is mapped from the huge page pool, falling
+ *   back to ordinary pages marked for transparent huge pages when the huge page pool is empty. Fewer, larger pages
+ *   mean fewer TLB misses on large pools.
+ * - With a NUMA node given, committed memory is bound to that node, so that a shard of a parallel buffer pool is
+ *   served from the memory of the socket it is meant for.
+ *
+ * Discard hands the memory behind a range back to the operating system but keeps it mapped; it reads as zeroes
+ * afterwards. Memory mapped from the huge page pool is only given back with the arena.
+ *
+ * Huge pages and NUMA binding use Linux interfaces. Where these are missing the arena maps ordinary pages and the
+ * machine counts as a single node.
+ */
+class FrameArena {
+ public:
+  /** Size of the huge pages the arena is aligned to and maps when asked to. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * Reserves the address space of the arena.
+   * @param max_bytes the most memory the arena will ever commit
+   * @param huge_pages back the arena with huge pages where possible
+   * @param numa_node the NUMA node to bind committed memory to, -1 for the default placement of the process
+   */
+  FrameArena(size_t max_bytes, bool huge_pages, int numa_node);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** Unmaps the whole arena. */
+  ~FrameArena();
+
+  /** @return the start of the arena; the data at offset i * PAGE_SIZE belongs to frame i */
+  char *Base() const { return base_; }
+
+  /**
+   * Backs bytes bytes of the arena, starting at offset, with readable and writable memory.
+   * @param offset a multiple of PAGE_SIZE
+   * @param bytes a multiple of PAGE_SIZE
+   * @return Base() + offset
+   */
+  char *Commit(size_t offset, size_t bytes);
+
+  /** Gives the memory behind [data, data + bytes) back to the operating system. The range stays mapped. */
+  void Discard(char *data, size_t bytes);
+
+  /** @return the number of committed bytes mapped from the huge page pool */
+  size_t GetHugeTlbBytes() const { return huge_tlb_bytes_; }
+
+  /** @return the NUMA node committed memory is bound to, or -1 if it is not bound */
+  int GetNumaNode() const { return numa_node_; }
+
+  /** @return the number of NUMA nodes of the machine, 1 if it cannot tell */
+  static int NumNumaNodes();
+
+ private:
+  /** Binds [data, data + bytes) to numa_node_, or gives up on binding if the kernel refuses. */
+  void BindToNode(char *data, size_t bytes);
+
+  /** Start of the reservation, which is larger than the arena by up to one huge page of alignment slack. */
+  char *reservation_;
+  size_t reservation_bytes_;
+  /** Start of the arena, aligned to HUGE_PAGE_SIZE. */
+  char *base_;
+  const bool huge_pages_;
+  int numa_node_;
+  size_t huge_tlb_bytes_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The backward k-distance of a frame is the time elapsed since its k-th most recent access. The victim is the
+ * evictable frame with the largest backward k-distance. Frames with fewer than k recorded accesses have an infinite
+ * distance and are evicted first, oldest first access first. A page touched once by a sequential scan therefore
+ * leaves before any page that is accessed repeatedly.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of historical accesses used to compute the backward k-distance
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordLoad(frame_id_t frame_id, page_id_t page_id) override;
+
+  void EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) override;
+
+  void SetCapacity(size_t num_pages) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameInfo {
+    /** Timestamps of the last (at most) k accesses, oldest first. */
+    std::deque<uint64_t> history_;
+    bool evictable_{false};
+  };
+
+  /** Key under which an evictable frame is ordered in its queue: the oldest timestamp in its history. */
+  using QueueKey = std::pair<uint64_t, frame_id_t>;
+
+  /** Appends a timestamp to frame_id's history, keeping its queue position up to date. Caller holds latch_. */
+  void RecordAccessLocked(frame_id_t frame_id);
+
+  /** Adds or removes an evictable frame from the queue matching its history length. Caller holds latch_. */
+  void Enqueue(frame_id_t frame_id);
+  void Dequeue(frame_id_t frame_id);
+
+  const size_t k_;
+  std::vector<FrameInfo> frames_;
+  /** Evictable frames with fewer than k accesses, ordered by first access. These are victimized first. */
+  std::set<QueueKey> history_queue_;
+  /** Evictable frames with k accesses, ordered by k-th most recent access, i.e. by descending k-distance. */
+  std::set<QueueKey> cache_queue_;
+  /** Logical clock advanced on every access. */
+  uint64_t current_timestamp_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -44,6 +44,8 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) override;
+
   size_t Size() override;
 
  private:
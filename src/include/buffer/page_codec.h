@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_codec.h
+//
+// Identification: src/include/buffer/page_codec.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageCodec is a small LZ77 compressor for whole pages, in the spirit of LZ4: fast enough to run on every eviction, and
+ * good at the runs of zeroes and the repeated strings of VARCHAR columns that pages are full of.
+ *
+ * A compressed page is a sequence of (literals, match) pairs. Each pair starts with a token byte whose high nibble is
+ * the number of literals and whose low nibble is the match length minus MIN_MATCH; a nibble of 15 is continued by
+ * bytes that are added to it, up to and including the first byte below 255. The literals follow, then the distance
+ * back to the match as two little-endian bytes, then the continuation of the match length. The last pair only has
+ * literals.
+ */
+class PageCodec {
+ public:
+  /** Shortest repetition encoded as a match. */
+  static constexpr size_t MIN_MATCH = 4;
+
+  /**
+   * Compresses one page.
+   * @param page PAGE_SIZE bytes to compress
+   * @param[out] out buffer for the compressed page
+   * @param capacity size of out; compression gives up once it would write more
+   * @return the size of the compressed page, or 0 if it does not fit in capacity bytes
+   */
+  static size_t Compress(const char *page, char *out, size_t capacity);
+
+  /**
+   * Decompresses a page compressed by Compress.
+   * @param in the compressed page
+   * @param size the size of the compressed page
+   * @param[out] page PAGE_SIZE bytes to decompress into
+   * @return false if in is not a valid compressed page
+   */
+  static bool Decompress(const char *in, size_t size, char *page);
+};
+
+}  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards frames across several independent BufferPoolManagerInstances. A page always lives
+ * in instance (page_id mod num_instances), so operations on different pages rarely contend on the same latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used by every instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, i.e. the number of frames summed over all instances */
+  size_t GetPoolSize() override;
+
+  /** @return the number of frames of the smallest instance, which may hold every page of a batch */
+  size_t GetInstancePoolSize() override;
+
+  /** Resizes every instance to its share of pool_size frames; instances differ in size by at most one frame. */
+  bool ResizePool(size_t pool_size) override;
+
+  /** Runs a page cleaner in every instance, each keeping its share of clean_target frames clean. */
+  void RunPageCleaner(size_t clean_target) override;
+
+  void StopPageCleaner() override;
+
+  void StopPrefetcher() override;
+
+  /** @return the page cleaner counters summed over all instances */
+  PageCleanerStats GetPageCleanerStats() override;
+
+  /** @return the statistics of all instances merged; the latency histograms cover every instance */
+  BufferPoolStatsSnapshot GetStats() override;
+
+  void ResetStats() override;
+
+  void EnableStats(bool enabled) override;
+
+  /** Gives every instance an equal share of capacity_bytes for its own compressed tier. */
+  void SetCompressedTierCapacity(size_t capacity_bytes) override;
+
+  /** @return the resident pages of the instances, interleaved so that each instance's hottest pages come first */
+  std::vector<page_id_t> GetResidentPageIds() override;
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  BufferPoolManagerInstance *GetBufferPoolManager(page_id_t page_id);
+
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page in one of the instances. Instances are tried round robin, starting one past the instance
+   * that served the previous call, so new pages are spread evenly across the shards.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  void FlushAllPagesImpl() override;
+
+  /** Hands every instance the pages it is responsible for, so that the instances read them in parallel. */
+  void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy,
+                         PrefetchTracker *tracker) override;
+
+  /** Hands every instance its share of the batch and puts the pages it returns back in the order of page_ids. */
+  std::vector<Page *> FetchPagesImpl(const std::vector<page_id_t> &page_ids) override;
+
+  size_t WarmUpImpl(const std::vector<page_id_t> &page_ids) override;
+
+ private:
+  /** The shards, indexed by page_id mod instances_.size(). */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** Instance NewPageImpl starts searching from. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prefetch_tracker.h
+//
+// Identification: src/include/buffer/prefetch_tracker.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <deque>
+#include <mutex>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PrefetchTracker counts the prefetches that a scan has queued with a buffer pool, so that the scan does not end while
+ * the prefetch thread still works on its behalf.
+ *
+ * Destroying a tracker cancels the prefetches that have not been loaded yet and waits for the rest: the prefetch
+ * thread skips the requests of a cancelled tracker and reports them as done without touching the disk.
+ *
+ * It skips the pages the scan has already reached as well. A prefetch thread that falls behind the scan would load
+ * them only to evict them again, and into a ring it would take the slots the scan is about to use.
+ */
+class PrefetchTracker {
+ public:
+  PrefetchTracker() = default;
+
+  DISALLOW_COPY_AND_MOVE(PrefetchTracker);
+
+  /** Cancels the pending prefetches and waits until the prefetch thread is done with all of them. */
+  ~PrefetchTracker();
+
+  /**
+   * Called when a prefetch is queued with this tracker.
+   * @param page_id the page to be prefetched
+   * @return the sequence number of the request, to be passed to IsWanted
+   */
+  size_t Begin(page_id_t page_id);
+
+  /** Called when a prefetch queued with this tracker is loaded, skipped or dropped. */
+  void Finish();
+
+  /**
+   * Called when the scan moves to a page. The requests queued up to the one for that page are no longer wanted.
+   * @param page_id the page the scan is about to fetch
+   */
+  void Reach(page_id_t page_id);
+
+  /**
+   * @param sequence the sequence number Begin returned for the request
+   * @return false once the request is cancelled or the scan has reached its page
+   */
+  bool IsWanted(size_t sequence);
+
+ private:
+  std::mutex latch_;
+  std::condition_variable done_;
+  size_t pending_{0};
+  bool cancelled_{false};
+  /** The sequence number of the first request that the scan has not passed yet. */
+  size_t passed_{0};
+  /** The pages of the requests from passed_ on, in the order they were queued. */
+  std::deque<page_id_t> queued_;
+};
+
+}  // namespace bustub
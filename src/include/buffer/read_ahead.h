@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.h
+//
+// Identification: src/include/buffer/read_ahead.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/prefetch_tracker.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ReadAhead detects a scan that walks a chain of pages, such as the pages of a TableHeap or the leaves of a B+ tree,
+ * in a predictable order, and prefetches the pages it is about to reach.
+ *
+ * The chain itself is only known page by page, so the prediction is made from page ids: once the last
+ * READ_AHEAD_TRIGGER moves of the scan all advanced by the same positive stride, the pages further along that stride
+ * are prefetched, keeping up to READ_AHEAD_PAGES of them ahead of the scan. Pages are allocated in increasing order,
+ * so a table that was filled on its own is laid out with a stride of one. A move that breaks the stride stops the
+ * read-ahead until a new stride has been confirmed.
+ *
+ * The prefetches are tracked, so that the ones for pages the scan has reached are skipped, and destroying the
+ * ReadAhead at the end of the scan cancels the ones still queued and waits for the ones in progress. A copy starts out
+ * with the prediction state of the original but tracks only the prefetches it issues itself.
+ */
+class ReadAhead {
+ public:
+  /**
+   * Create a new ReadAhead.
+   * @param bpm the buffer pool to prefetch into, nullptr to disable read-ahead
+   * @param strategy the access strategy of the scan, may be nullptr. The window is kept to half its ring, so that
+   * prefetched pages are not recycled before the scan reaches them.
+   */
+  explicit ReadAhead(BufferPoolManager *bpm = nullptr, BufferAccessStrategy *strategy = nullptr);
+
+  ReadAhead(const ReadAhead &other);
+
+  ReadAhead &operator=(const ReadAhead &other);
+
+  /**
+   * Called when the scan moves to a page. Prefetches the pages ahead of it once the access pattern is sequential.
+   * @param page_id the page the scan is about to fetch
+   */
+  void OnPage(page_id_t page_id);
+
+ private:
+  BufferPoolManager *bpm_;
+  BufferAccessStrategy *strategy_;
+  /** Maximum number of pages prefetched ahead of the scan. */
+  page_id_t window_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  /** Page id difference of the last move, and how many moves in a row had it. */
+  page_id_t stride_{0};
+  size_t run_{0};
+  /** The furthest page prefetched along the current stride. */
+  page_id_t prefetched_until_{INVALID_PAGE_ID};
+  /** The prefetches issued by this ReadAhead. */
+  PrefetchTracker tracker_;
+};
+
+}  // namespace bustub
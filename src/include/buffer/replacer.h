@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** Replacement policies that a buffer pool can be constructed with. */
+enum class ReplacerType { LRU, CLOCK, LRUK, ARC };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +48,57 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Records that the page held by a frame was accessed. The buffer pool calls this on every FetchPage, including
+   * hits, without holding its latch, so implementations that override it must synchronize internally.
+   * Policies that only care about pin / unpin transitions ignore it.
+   * @param frame_id the id of the frame that was accessed
+   */
+  virtual void RecordAccess(frame_id_t frame_id) {}
+
+  /**
+   * Records that a frame was just filled with a page, either read from disk or newly allocated. Called with the
+   * frame still pinned, instead of RecordAccess. Policies that remember evicted pages use this to recognize a page
+   * coming back.
+   * @param frame_id the id of the frame that was filled
+   * @param page_id the id of the page it now holds
+   */
+  virtual void RecordLoad(frame_id_t frame_id, page_id_t page_id) { RecordAccess(frame_id); }
+
+  /**
+   * Records which page an evicted frame held. The buffer pool calls this right after a successful Victim, and also
+   * when it evicts a frame it picked itself, e.g. one recycled by a BufferAccessStrategy.
+   * @param frame_id the id of the victim frame
+   * @param page_id the id of the page that was evicted from it
+   */
+  virtual void RecordEviction(frame_id_t frame_id, page_id_t page_id) {}
+
+  /**
+   * Lists the frames Victim would return next, best candidate first, without removing them. The page cleaner uses
+   * this to write back dirty frames before they are evicted. Policies that cannot predict their victims list none.
+   * @param max_candidates the maximum number of frames to list
+   * @param[out] candidates receives the frames
+   */
+  virtual void EvictionCandidates(size_t max_candidates, std::vector<frame_id_t> *candidates) {}
+
+  /**
+   * Resizes the replacer for a buffer pool that now has num_pages frames. Frame ids below num_pages can be used from
+   * now on; frames above it are taken out of use by the buffer pool, which never unpins them again. Storage indexed by
+   * frame id only ever grows, so a retired frame can still be pinned or evicted. Must not run concurrently with any
+   * other call but RecordAccess. Policies that do not depend on the number of frames ignore it.
+   * @param num_pages the new number of frames
+   */
+  virtual void SetCapacity(size_t num_pages) {}
+
+  /**
+   * Whether the buffer pool may leave a frame in the replacer while it is pinned. If so, pinning and unpinning a
+   * resident page never touches the replacer: the buffer pool only calls Pin and Unpin when a frame leaves or enters
+   * use, learns about use through RecordAccess, and hands a pinned frame that Victim returned back with Unpin.
+   * Policies that order frames by when they were unpinned keep the default.
+   * @return true if pinned frames may stay in the replacer
+   */
+  virtual bool AllowsPinnedFrames() const { return false; }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
@@ -12,7 +12,7 @@
 
 #include <string>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -23,7 +23,11 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * @param db_file_name the database file
+   * @param buffer_pool_size the initial number of buffer pool frames; buffer_pool_manager_->ResizePool changes it later
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t buffer_pool_size = BUFFER_POOL_SIZE) {
     enable_logging = false;
 
     // storage related
@@ -32,7 +36,7 @@ class BustubInstance {
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManagerInstance(buffer_pool_size, disk_manager_, log_manager_);
 
     // txn related
     lock_manager_ = new LockManager();
@@ -55,7 +59,7 @@ class BustubInstance {
   }
 
   DiskManager *disk_manager_;
-  BufferPoolManager *buffer_pool_manager_;
+  BufferPoolManagerInstance *buffer_pool_manager_;
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
@@ -24,17 +24,49 @@ extern std::chrono::milliseconds cycle_detection_interval;
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
+/** True if new buffer pools should collect BufferPoolStats, false otherwise. */
+extern std::atomic<bool> enable_buffer_pool_stats;
+
+/** True if new buffer pools should back their frames with 2 MB huge pages where the system provides them. */
+extern std::atomic<bool> buffer_pool_huge_pages;
+
+/** True if the instances of a new parallel buffer pool should bind their frames round robin to the NUMA nodes. */
+extern std::atomic<bool> buffer_pool_numa_binding;
+
+/** True if new disk schedulers should issue their requests through io_uring where the kernel provides it. */
+extern std::atomic<bool> disk_scheduler_io_uring;
+
+/** True if new disk managers should open the database file with O_DIRECT, bypassing the page cache, where allowed. */
+extern std::atomic<bool> disk_manager_direct_io;
+
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running page cleaner wakes up at least every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** A running BufferPoolWarmer saves the resident page ids every BUFFER_POOL_DUMP_INTERVAL milliseconds. */
+extern std::chrono::milliseconds buffer_pool_dump_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_CHECKSUM_SIZE = 4;                                  // checksum bytes at the end of a page
+static constexpr int PAGE_DATA_SIZE = PAGE_SIZE - PAGE_CHECKSUM_SIZE;         // bytes of a page for its contents
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr size_t LRUK_REPLACER_K = 2;                                  // lookback window for lru-k replacer
+static constexpr size_t SCAN_RING_SIZE = 32;  // frames a sequential scan or bulk insert recycles, 0 = no ring
+static constexpr size_t READ_AHEAD_TRIGGER = 2;  // same-stride page moves before a scan starts reading ahead
+static constexpr size_t READ_AHEAD_PAGES = 8;    // pages a scan keeps read ahead of its position
+static constexpr uint32_t STATS_HIT_SAMPLE_INTERVAL = 64;  // a thread times one in this many buffer pool hits
+static constexpr size_t BUFFER_POOL_MAX_CHUNKS = 64;        // a buffer pool instance grows by at most this many chunks
+static constexpr size_t DISK_SCHEDULER_QUEUE_DEPTH = 32;    // disk requests a disk scheduler keeps in flight at most
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;         // alignment of the buffers of O_DIRECT reads and writes
+static constexpr uint32_t EXTENT_SIZE = 64;                 // pages a table or index reserves on disk at a time
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
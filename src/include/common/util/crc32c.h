@@ -0,0 +1,39 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes the CRC-32C (Castagnoli) checksum, which the crc32 instruction of SSE 4.2 and of ARMv8 computes in
+ * hardware. Where the CPU has neither, a table-driven implementation that processes eight bytes at a time is used.
+ */
+class Crc32c {
+ public:
+  /** @return the CRC-32C of the length bytes at data */
+  static uint32_t Compute(const char *data, size_t length) { return Extend(0, data, length); }
+
+  /** @return the CRC-32C of the bytes whose CRC-32C is crc followed by the length bytes at data */
+  static uint32_t Extend(uint32_t crc, const char *data, size_t length);
+
+  /** @return the same as Extend, computed without the crc32 instruction */
+  static uint32_t ExtendPortable(uint32_t crc, const char *data, size_t length);
+
+  /** @return true if Extend uses the crc32 instruction of the CPU */
+  static bool IsHardwareAccelerated();
+};
+
+}  // namespace bustub
@@ -12,10 +12,12 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
@@ -60,12 +62,28 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /** @return the number of frames each sequential scan or bulk insert of this query may recycle, 0 for no limit */
+  size_t GetScanRingSize() const { return scan_ring_size_; }
+
+  /**
+   * Sets the ring size of the BufferAccessStrategy given to each sequential scan or bulk insert of this query.
+   * A small ring keeps a large analytic scan from evicting the pages of concurrent OLTP queries.
+   * @param ring_size the number of frames per ring, 0 to let scans use the whole buffer pool
+   */
+  void SetScanRingSize(size_t ring_size) { scan_ring_size_ = ring_size; }
+
+  /** @return a new access strategy for one scan or bulk insert of this query, or nullptr if rings are disabled */
+  std::unique_ptr<BufferAccessStrategy> MakeBufferAccessStrategy() const {
+    return scan_ring_size_ == 0 ? nullptr : std::make_unique<BufferAccessStrategy>(scan_ring_size_);
+  }
+
  private:
   Transaction *transaction_;
   Catalog *catalog_;
   BufferPoolManager *bpm_;
   TransactionManager *txn_mgr_;
   LockManager *lock_mgr_;
+  size_t scan_ring_size_{SCAN_RING_SIZE};
 };
 
 }  // namespace bustub
@@ -51,5 +51,7 @@ class InsertExecutor : public AbstractExecutor {
   TableMetadata *table_metadata_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   std::vector<IndexInfo *> table_indexes_;
+  /** Keeps inserts fed by the child executor to a private ring of frames; nullptr if the context disables rings. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
 };
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
@@ -43,6 +44,8 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
+  /** Keeps the scan to a private ring of frames; nullptr if the context disables rings. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
   TableIterator table_iterator_;
   TableMetadata *table_metadata_;
 };
@@ -16,6 +16,7 @@
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,6 +26,12 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * The flush thread also commits transactions in groups. A committing transaction appends its commit record and waits
+ * in Flush until the persistent LSN reaches it. The flush thread swaps the log buffers and writes everything that has
+ * accumulated with one write and one sync, then wakes every waiter whose record is now durable. Records appended while
+ * a sync is in progress go into the other buffer and share the next one, so the number of syncs does not grow with the
+ * number of concurrent committers.
  */
 class LogManager {
  public:
@@ -35,6 +42,7 @@ class LogManager {
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -44,15 +52,32 @@ class LogManager {
   void RunFlushThread();
   void StopFlushThread();
 
+  /**
+   * Appends a log record to the log buffer and assigns its LSN. If the buffer is full, waits for the flush thread to
+   * write it, or writes it itself if the flush thread is not running.
+   * @throws Exception if the record is larger than the log buffer
+   * @return the LSN of the record
+   */
   lsn_t AppendLogRecord(LogRecord *log_record);
 
+  /**
+   * Blocks until the log records up to and including lsn are durable. Callers waiting at the same time are served by
+   * the same write and sync. If the flush thread is not running, the buffered records are written by the caller.
+   * @param lsn the LSN that has to be persistent, such as that of a commit record
+   */
+  void Flush(lsn_t lsn);
+
   inline lsn_t GetNextLSN() { return next_lsn_; }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** The body of the flush thread. */
+  void FlushLoop();
+
+  /** Writes the records in log_buffer_ and empties it. Caller holds latch_, and the flush thread is not running. */
+  void WriteBuffer();
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
@@ -62,13 +87,24 @@ class LogManager {
   char *log_buffer_;
   char *flush_buffer_;
 
+  /** Bytes of log_buffer_ in use. */
+  int offset_{0};
+  /** Set when a waiter or a full buffer wants the flush thread to write before the timeout. */
+  bool flush_requested_{false};
+  /** Set to make the flush thread write what is left and exit. */
+  bool stop_{false};
+
+  /** Protects the fields above, the buffers and the LSNs handed out. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
 
+  /** Wakes the flush thread. */
   std::condition_variable cv_;
+  /** Wakes the waiters for the persistent LSN after each flush. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
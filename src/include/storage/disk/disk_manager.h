@@ -12,10 +12,16 @@
 
 #pragma once
 
+#include <sys/uio.h>
+
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
@@ -24,6 +30,34 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with pread and pwrite on one file descriptor, so every method that reads or writes pages
+ * may be called from several threads at once. A written page reaches the operating system right away but is only
+ * durable after the next sync point: WritePages, Sync or ShutDown.
+ *
+ * With disk_manager_direct_io set, the database file is opened with O_DIRECT, so that pages are not cached a second
+ * time by the kernel, unless the filesystem refuses it. On macOS, which has no O_DIRECT, F_NOCACHE is set on the file
+ * instead. Direct I/O needs buffers aligned to DIRECT_IO_ALIGNMENT, such as the frames of a buffer pool; other buffers
+ * are copied through an aligned one.
+ *
+ * Deallocated pages are recorded in a free-page bitmap and handed out again by AllocatePage. The bitmap is kept in
+ * the database file itself: every PAGES_PER_BITMAP pages are preceded by a bitmap page covering them, with a bit set
+ * for each page that is free, so page i lives at file page i + i / PAGES_PER_BITMAP + 1. A bitmap page is written
+ * whenever one of its bits changes, and durable with the pages at the next sync point. On open, the pages in the file
+ * count as allocated, except for those the bitmap records as free.
+ *
+ * A page allocated with a hint is placed in the extent of the hint: a run of EXTENT_SIZE pages that the first such
+ * allocation reserved, so that the pages of a table or an index that grows page by page lie together in the file and
+ * a scan of it reads long runs of adjacent pages. When the extent is full, the next one is reserved. Allocators that
+ * share the file, such as the instances of a parallel buffer pool, have extents of their own ids, and a hint of
+ * another allocator picks the extent that lies next to its own. Pages allocated without a hint are handed out one by
+ * one from outside the reserved extents. Reservations are kept in the bitmap pages as well, as a second bitmap with a
+ * bit set for the first page of each reserved extent, so that a table keeps filling its extent after a restart.
+ *
+ * Every page, the bitmap pages included, is written with a CRC-32C checksum in its last PAGE_CHECKSUM_SIZE bytes and
+ * verified when it is read back, so that a page corrupted on disk is reported as unreadable instead of handed to the
+ * code that interprets it. The checksum covers the position of the page in the file too, which catches a page written
+ * to the wrong place. A page of zeros, which is what a page that was never written reads as, passes.
  */
 class DiskManager {
  public:
@@ -33,7 +67,7 @@ class DiskManager {
    */
   explicit DiskManager(const std::string &db_file);
 
-  ~DiskManager() = default;
+  ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -41,21 +75,34 @@ class DiskManager {
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. Its checksum is stamped into the last PAGE_CHECKSUM_SIZE bytes of page_data,
+   * which are not part of the page contents, so that the page goes out as one PAGE_SIZE transfer.
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  void WritePage(page_id_t page_id, char *page_data);
+
+  /** Make every page written so far durable. */
+  void Sync();
+
+  /**
+   * Write a batch of pages to the database file, such as a checkpoint. The pages are written in ascending page id
+   * order, each run of adjacent pages with a single vectored write, and the file is synced once at the end. Each page
+   * has its checksum stamped as in WritePage.
+   * @param[in,out] pages ids of the pages and their raw data; sorted by page id on return
+   */
+  void WritePages(std::vector<std::pair<page_id_t, char *>> *pages);
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return false if the page could not be read or fails its checksum
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  bool ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Append the entire log buffer to the log file and make it durable with one sync. Called by one thread at a time.
    * @param log_data raw log data
    * @param size size of log entry
    */
@@ -71,17 +118,30 @@ class DiskManager {
   bool ReadLog(char *log_data, int size, int offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk. With a hint, the page comes from the extent of hint, or from a newly reserved extent if
+   * that one is full. Without, the lowest free page outside the reserved extents is reused if there is one; otherwise
+   * the file grows by a page. Only ids with page_id % stride == residue are handed out, so that each instance of a
+   * parallel buffer pool allocates pages of its own; an extent then holds EXTENT_SIZE of its ids. A hint owned by
+   * another allocator picks the extent of this one that covers the same ids of the file.
+   * @param hint id of a page of the table or index the new page belongs to, INVALID_PAGE_ID for none
+   * @param stride the number of allocators that share the file
+   * @param residue the remainder of the ids of this allocator
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID, uint32_t stride = 1, uint32_t residue = 0);
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that AllocatePage can hand out its id again.
    * @param page_id id of the page to deallocate
    */
   void DeallocatePage(page_id_t page_id);
 
+  /** @return true if page_id is allocated, i.e. it was handed out by AllocatePage and not deallocated since */
+  bool IsAllocated(page_id_t page_id);
+
+  /** @return the number of free pages, deallocated ones and the unused ones of reserved extents */
+  size_t GetNumFreePages();
+
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
 
@@ -91,6 +151,18 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of write system calls issued for pages; WritePages writes several pages per call */
+  int GetNumWriteCalls() const;
+
+  /** @return the number of page writes that direct I/O had to copy through an aligned buffer first */
+  int GetNumBouncedWrites() const;
+
+  /** @return the number of pages read that failed their checksum */
+  int GetNumChecksumFailures() const;
+
+  /** @return true if the database file bypasses the page cache */
+  bool UsesDirectIo() const { return direct_io_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -101,16 +173,107 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
+  /** The disk scheduler issues reads and writes of pages on db_fd_ itself. */
+  friend class DiskScheduler;
+
+  /** Number of 64-bit words of each of the two bitmaps of a bitmap page, which together fill it up to its checksum. */
+  static constexpr size_t WORDS_PER_BITMAP = PAGE_DATA_SIZE / sizeof(uint64_t) / 2;
+  /** Number of pages one bitmap page covers, a whole number of extents. */
+  static constexpr page_id_t PAGES_PER_BITMAP = static_cast<page_id_t>(WORDS_PER_BITMAP * 64);
+
+  /** @return the offset of page_id in the database file */
+  static off_t PageOffset(page_id_t page_id) {
+    return (static_cast<off_t>(page_id) + page_id / PAGES_PER_BITMAP + 1) * PAGE_SIZE;
+  }
+  /**
+   * Reads the PAGE_SIZE bytes at offset of the database file into data, zero-filling what lies past its end.
+   * @return false on an I/O error
+   */
+  bool ReadBlock(off_t offset, char *data);
+  /**
+   * @return the checksum of the page at data that is to be written at offset: the CRC-32C of its contents, mixed with
+   * its position in the file so that a page written to the wrong place fails its checksum too
+   */
+  static uint32_t Checksum(off_t offset, const char *data);
+  /** Stores the checksum of the page at data, which is to be written at offset, in its last PAGE_CHECKSUM_SIZE bytes. */
+  static void StampChecksum(off_t offset, char *data);
+  /**
+   * Stamps the checksum of the page at data and appends the buffer that writes it to iov, so that a page aligned for
+   * direct I/O is written from where it is. Readers of the page do not look at the checksum bytes, so data may be a
+   * frame that is shared with them.
+   */
+  static void AppendPage(off_t offset, char *data, std::vector<iovec> *iov);
+  /**
+   * @return true if the PAGE_SIZE bytes of data read at offset pass their checksum; counts and reports a failure.
+   * A page that passes has its checksum cleared, so that it reads back as it was written.
+   */
+  bool VerifyChecksum(off_t offset, char *data);
+  /** @return true if the bitmap records page_id as free. Caller holds allocation_latch_. */
+  bool IsFree(page_id_t page_id) const;
+  /** Marks page_id free or allocated in the in-memory bitmap. Caller holds allocation_latch_. */
+  void SetFree(page_id_t page_id, bool free);
+  /** @return true if the extent that starts at page_id is reserved. Caller holds allocation_latch_. */
+  bool IsReserved(page_id_t page_id) const;
+  /** Marks the extent that starts at page_id reserved in memory. Caller holds allocation_latch_. */
+  void SetReserved(page_id_t page_id);
+  /** Makes the in-memory bitmaps cover the bitmap page of page_id. Caller holds allocation_latch_. */
+  void CoverPage(page_id_t page_id);
+  /** Writes the bitmap page that covers page_id. Caller holds allocation_latch_. */
+  void WriteBitmap(page_id_t page_id);
+  /**
+   * @return the lowest free page with page_id % stride == residue outside the reserved extents, INVALID_PAGE_ID if
+   * there is none. Caller holds allocation_latch_.
+   */
+  page_id_t FindFreePage(uint32_t stride, uint32_t residue);
+  /**
+   * @return the free page of the extent of hint at or after hint most closely, INVALID_PAGE_ID if there is none or
+   * the extent is not reserved. Caller holds allocation_latch_.
+   */
+  page_id_t FindFreePageInExtent(page_id_t hint, uint32_t stride);
+  /**
+   * Reserves an extent for ids with page_id % stride == residue: the extent of near if its pages are all free,
+   * otherwise another one whose pages are or a new one at the end of the file. Caller holds allocation_latch_.
+   * @return near if its extent was reserved, the first page of the extent otherwise; the page is still free
+   */
+  page_id_t ReserveExtent(uint32_t stride, uint32_t residue, page_id_t near);
+  /** Records the pages from next_page_id_ up to end as free and moves next_page_id_ to end. Caller holds the latch. */
+  void GrowTo(page_id_t end);
+  /** @return the first page of the extent that holds page_id, among the ids with the same residue */
+  static page_id_t ExtentOf(page_id_t page_id, uint32_t stride) {
+    const auto span = static_cast<page_id_t>(stride * EXTENT_SIZE);
+    return page_id / span * span + page_id % static_cast<page_id_t>(stride);
+  }
+
   int GetFileSize(const std::string &file_name);
-  // stream to write log file
-  std::fstream log_io_;
+  /** Writes all of the iovcnt buffers of iov at offset, resuming after short writes; iov is consumed. */
+  bool WriteVectored(iovec *iov, int iovcnt, off_t offset);
+  /** @return true if the iovcnt buffers of iov can be transferred as they are, which direct I/O needs aligned */
+  bool CanTransfer(const iovec *iov, int iovcnt) const;
+  // descriptor of the log file, opened for appending; -1 once shut down
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
+  // descriptor of the db file, -1 once shut down
+  int db_fd_{-1};
+  // whether db_fd_ was opened with O_DIRECT, or has F_NOCACHE set
+  bool direct_io_{false};
+  // protects next_page_id_, the bitmaps, num_free_pages_ and the free_word_ cursor
+  std::mutex allocation_latch_;
+  // pages at or above next_page_id_ have never been allocated
+  page_id_t next_page_id_;
+  // the free-page bitmap, a bit per page, WORDS_PER_BITMAP words per bitmap page
+  std::vector<uint64_t> free_pages_;
+  // the reserved extents, a bit set for the first page of each, indexed like free_pages_
+  std::vector<uint64_t> reserved_extents_;
+  size_t num_free_pages_{0};
+  // the words of free_pages_ below free_word_ hold no free page outside the extents reserved with free_word_stride_
+  size_t free_word_{0};
+  uint32_t free_word_stride_{1};
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_write_calls_{0};
+  std::atomic<int> num_bounced_writes_{0};
+  std::atomic<int> num_checksum_failures_{0};
   bool flush_log_;
   std::future<void> *flush_log_f_;
 };
@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a Write or Read request for the DiskScheduler to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /**
+   * Pointer to the start of the memory location where a page is either:
+   *   1. being read into from disk (on a read).
+   *   2. being written out to disk (on a write).
+   */
+  char *data_;
+
+  /** ID of the page being read from / written to disk. */
+  page_id_t page_id_;
+
+  /** Callback used to signal to the request issuer when the request has been completed; false if it failed. */
+  std::promise<bool> callback_;
+};
+
+class IoUring;
+
+/**
+ * @brief The DiskScheduler keeps many reads and writes of the DiskManager in flight at once, so that a device that
+ * needs a deep queue to reach its rated throughput gets one.
+ *
+ * Requests are issued through io_uring where the kernel provides it and disk_scheduler_io_uring is set, and otherwise
+ * by a pool of threads calling pread and pwritev. Either way at most queue_depth requests are in flight; Schedule
+ * blocks until there is room. Completion is signalled through the promise of each request, from a thread of the
+ * scheduler, so the promise must not be waited for from a callback. A read whose page fails its checksum completes
+ * with false; a written page is written with its checksum, which the scheduler keeps apart from the page. Writes are
+ * not durable until DiskManager::Sync.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * Creates a scheduler for the pages of disk_manager.
+   * @param disk_manager the disk manager to read and write pages of
+   * @param queue_depth the number of requests kept in flight at most
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t queue_depth = DISK_SCHEDULER_QUEUE_DEPTH);
+
+  /** Waits for the requests in flight, then stops the threads of the scheduler. */
+  ~DiskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(DiskScheduler);
+
+  /**
+   * Schedules a request for the DiskManager to execute.
+   * @param r the request to be scheduled
+   */
+  void Schedule(DiskRequest r);
+
+  /**
+   * Schedules a batch of requests, handing them to the kernel together where it can.
+   * @param requests the requests to be scheduled; moved from
+   */
+  void Schedule(std::vector<DiskRequest> *requests);
+
+  /**
+   * Schedules the writes of a batch of pages, such as those of a page cleaner round. The pages are sorted by page id
+   * and each run of adjacent pages is written with one vectored write; the runs are in flight at once. Each page has
+   * its checksum stamped as in DiskManager::WritePage.
+   * @param[in,out] pages ids of the pages and their raw data, which must stay valid until the returned future is ready;
+   * sorted by page id on return
+   * @return a future that becomes true once every page is written, false if a write failed
+   */
+  std::future<bool> ScheduleWrites(std::vector<std::pair<page_id_t, char *>> *pages);
+
+  /**
+   * Creates a Promise object. If you want to implement your own version of promise, you can change this function
+   * so that our test cases can use your promise implementation.
+   * @return std::promise<bool>
+   */
+  static auto CreatePromise() -> std::promise<bool> { return {}; };
+
+  /** @return true if requests are issued through io_uring, false if by the thread pool */
+  bool UsesIoUring() const { return ring_ != nullptr; }
+
+  /** @return the largest number of requests that were in flight at once */
+  size_t GetMaxInFlight();
+
+ private:
+  /** A read of one page, or a write of a run of adjacent pages. */
+  struct Operation {
+    bool is_write_;
+    page_id_t page_id_;
+    std::vector<iovec> iov_;
+    /** An aligned copy of the pages written, which iov_ points to instead when direct I/O cannot take them. */
+    std::unique_ptr<char, decltype(&std::free)> bounce_{nullptr, &std::free};
+    /** Called once the operation is done, with true if it succeeded. */
+    std::function<void(bool)> done_;
+  };
+
+  /** Hands ops to the ring or the thread pool, waiting for room whenever queue_depth_ operations are in flight. */
+  void Submit(std::vector<Operation *> *ops);
+  /**
+   * Copies the pages a write writes into an aligned buffer of its own, so that direct I/O can take pages that were
+   * handed over unaligned.
+   * @return false if op is a read, or no buffer could be allocated
+   */
+  static bool GatherWrite(Operation *op);
+  /** Executes op, or what a short transfer of done bytes left of it, with blocking system calls. */
+  bool RunSync(Operation *op, size_t done);
+  /** Reports the outcome of op and frees its room in the queue. */
+  void Finish(Operation *op, bool success);
+  void ReapLoop();
+  void WorkerLoop();
+
+  DiskManager *disk_manager_;
+  const size_t queue_depth_;
+  /** The io_uring instance, nullptr if the thread pool issues the requests. */
+  std::unique_ptr<IoUring> ring_;
+  /** Protects the members below and the submission queue of ring_. */
+  std::mutex latch_;
+  std::condition_variable room_cv_;
+  std::condition_variable work_cv_;
+  size_t in_flight_{0};
+  size_t max_in_flight_{0};
+  bool stop_{false};
+  /** Operations waiting for a thread of the pool. */
+  std::deque<Operation *> queue_;
+  size_t idle_workers_{0};
+  std::vector<std::thread> workers_;
+  /** Reaps the completions of ring_. */
+  std::thread reaper_;
+};
+
+}  // namespace bustub
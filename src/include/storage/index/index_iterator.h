@@ -13,6 +13,7 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include "buffer/read_ahead.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -47,6 +48,8 @@ class IndexIterator {
   BufferPoolManager *buffer_pool_manager_;
   bool is_end_;
   MappingType iter_val_;
+  // prefetches the leaves ahead of a range scan
+  ReadAhead read_ahead_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A page of the free space map of a table heap: the free bytes of up to CAPACITY table pages, in the order the pages
+ * were added to the heap. The pages of one map are linked into a list.
+ *
+ * Format (size in byte):
+ *  --------------------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | Entry_1 page_id (4) | Entry_1 free_space (4) | ... |
+ *  --------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** Number of table pages one map page tracks. */
+  static constexpr uint32_t CAPACITY = (PAGE_DATA_SIZE - 8) / 8;
+
+  /** Initializes an empty map page at the end of the list. */
+  void Init() {
+    SetNextPageId(INVALID_PAGE_ID);
+    SetEntryCount(0);
+  }
+
+  /** @return the page id of the next map page, INVALID_PAGE_ID for the last one */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of table pages this page tracks */
+  uint32_t GetEntryCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRY_COUNT); }
+
+  /** @return the id of the table page in slot */
+  page_id_t GetTablePageId(uint32_t slot) {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_ENTRIES + SIZE_ENTRY * slot);
+  }
+
+  /** @return the free bytes last recorded for the table page in slot */
+  uint32_t GetFreeSpace(uint32_t slot) {
+    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRIES + SIZE_ENTRY * slot + sizeof(page_id_t));
+  }
+
+  void SetFreeSpace(uint32_t slot, uint32_t free_space) {
+    memcpy(GetData() + OFFSET_ENTRIES + SIZE_ENTRY * slot + sizeof(page_id_t), &free_space, sizeof(uint32_t));
+  }
+
+  /**
+   * Tracks one more table page.
+   * @return the slot of the page, or -1 if this map page is full
+   */
+  int32_t AddTablePage(page_id_t page_id, uint32_t free_space) {
+    uint32_t slot = GetEntryCount();
+    if (slot == CAPACITY) {
+      return -1;
+    }
+    memcpy(GetData() + OFFSET_ENTRIES + SIZE_ENTRY * slot, &page_id, sizeof(page_id_t));
+    SetFreeSpace(slot, free_space);
+    SetEntryCount(slot + 1);
+    return static_cast<int32_t>(slot);
+  }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 0;
+  static constexpr size_t OFFSET_ENTRY_COUNT = 4;
+  static constexpr size_t OFFSET_ENTRIES = 8;
+  static constexpr size_t SIZE_ENTRY = 8;
+
+  void SetEntryCount(uint32_t entry_count) { memcpy(GetData() + OFFSET_ENTRY_COUNT, &entry_count, sizeof(uint32_t)); }
+};
+
+}  // namespace bustub
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,14 +27,26 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data of a page is kept apart from this book-keeping: a page created on its own owns a buffer, while the frames
+ * of a buffer pool point into page-aligned memory owned by the pool, which can give it back to the operating system
+ * frame by frame.
+ *
+ * The last PAGE_CHECKSUM_SIZE bytes of the data hold the checksum that the DiskManager writes the page with; the
+ * contents of a page live in the PAGE_DATA_SIZE bytes before them.
+ *
+ * Besides the latch, a page carries a version that every write latch section moves forward: odd while a writer
+ * holds the page, even otherwise. Readers that hold a pin can read the page without latching it and then check that
+ * the version did not change, which keeps them from writing to the latch's cache line; see
+ * BasicPageGuard::OptimisticRead.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates zeroed page data owned by the page. */
+  Page() : owned_data_(std::make_unique<char[]>(PAGE_SIZE)), data_(owned_data_.get()) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -42,21 +57,53 @@ class Page {
   /** @return the page id of this page */
   inline page_id_t GetPageId() { return page_id_; }
 
-  /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  /** @return the pin count of this page, or -1 while the frame is free or being (re)loaded by the buffer pool */
+  inline int GetPinCount() { return pin_count_.load(); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
-  inline bool IsDirty() { return is_dirty_; }
+  inline bool IsDirty() { return is_dirty_.load(); }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    // Writers are serialized by the latch, so a plain load and store is enough; the fence keeps the writes that
+    // follow from becoming visible before the odd version.
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
+
+  /**
+   * Starts an optimistic read section, waiting for a writer that holds the page to finish first.
+   * @return the version to pass to ValidateVersion at the end of the section
+   */
+  inline uint64_t ReadVersion() const {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    while ((version & 1) != 0) {
+      std::this_thread::yield();
+      version = version_.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+
+  /** @return true if no writer latched the page since ReadVersion returned version */
+  inline bool ValidateVersion(uint64_t version) const {
+    // The fence keeps the reads of the section from being reordered after the version check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** @return true if the page read latch was acquired without waiting for a writer */
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
@@ -75,19 +122,26 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Creates a buffer pool frame whose data lives in memory owned by the buffer pool. */
+  explicit Page(char *data) : data_(data) {}
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The buffer of a page that is not a buffer pool frame. */
+  std::unique_ptr<char[]> owned_data_;
+  /** The actual data that is stored within a page: owned_data_, or a frame of the buffer pool. */
+  char *data_;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The pin count of this page. Atomic so that buffer pool hits can pin and unpin without the pool latch. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Incremented when a write latch is acquired and when it is released. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
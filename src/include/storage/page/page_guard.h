@@ -0,0 +1,215 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <type_traits>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard holds the pin on a page fetched from a BufferPoolManager and unpins it when it goes out of scope, is
+ * dropped or is moved from, so that no error path can leak a pin. The page is reported dirty on unpin if it was
+ * accessed through AsMut or SetDirty was called.
+ *
+ * A guard whose page could not be fetched is invalid; check IsValid before using the page.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  /**
+   * Takes over a pin that the caller already holds.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned page, or nullptr for an invalid guard
+   */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+  /** Takes over the pin of that, leaving it invalid. */
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** Drops the pin this guard holds, then takes over the pin of that, leaving it invalid. */
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  ~BasicPageGuard() { Drop(); }
+
+  /** Unpins the page, marking it dirty if it was modified. Does nothing if the guard is invalid. */
+  void Drop();
+
+  /** Read-latches the page and turns this guard into a ReadPageGuard, leaving this one invalid. */
+  ReadPageGuard UpgradeRead();
+
+  /** Write-latches the page and turns this guard into a WritePageGuard, leaving this one invalid. */
+  WritePageGuard UpgradeWrite();
+
+  /** @return true if the guard holds a pinned page */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return page_->GetPageId(); }
+
+  /** @return the guarded page */
+  Page *GetPage() const { return page_; }
+
+  /** Marks the page dirty, so that it is written back before its frame is reused. */
+  void SetDirty() { is_dirty_ = true; }
+
+  /**
+   * @return the page viewed as T. T is either a subclass of Page, such as TablePage, or a layout of the page data,
+   * such as a B+ tree node.
+   */
+  template <class T>
+  T *As() const {
+    if constexpr (std::is_base_of_v<Page, T>) {
+      return static_cast<T *>(page_);
+    } else {
+      return reinterpret_cast<T *>(page_->GetData());
+    }
+  }
+
+  /** @return the page viewed as T, like As, and marks it dirty */
+  template <class T>
+  T *AsMut() {
+    is_dirty_ = true;
+    return As<T>();
+  }
+
+  /**
+   * Runs reader on the page viewed as T without latching it, again and again until no writer latched the page while
+   * it ran. Only the result of the last run escapes, so reader must not act on what it sees, and since it can see a
+   * page in the middle of a modification, it must not trust sizes or offsets read from it to stay inside the page.
+   * Writers are only detected if they hold the write latch, e.g. through a WritePageGuard.
+   * @param reader a callable taking a const T *
+   * @return what reader returned on its consistent run
+   */
+  template <class T, class F>
+  auto OptimisticRead(F &&reader) const {
+    while (true) {
+      uint64_t version = page_->ReadVersion();
+      auto result = reader(static_cast<const T *>(As<T>()));
+      if (page_->ValidateVersion(version)) {
+        return result;
+      }
+    }
+  }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds the pin and the read latch on a page, and releases both when it goes out of scope, is dropped
+ * or is moved from. The page must not be modified through it; As returns a mutable pointer only because the page
+ * classes of the table heap do not have const accessors.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /**
+   * Takes over a pin and a read latch that the caller already holds.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned and read-latched page, or nullptr for an invalid guard
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  /** Releases the latch and pin this guard holds, then takes over those of that, leaving it invalid. */
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Releases the read latch and the pin. Does nothing if the guard is invalid. */
+  void Drop();
+
+  bool IsValid() const { return guard_.IsValid(); }
+
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds the pin and the write latch on a page, and releases both when it goes out of scope, is dropped
+ * or is moved from. The page is unpinned dirty if it was accessed through AsMut or SetDirty was called.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /**
+   * Takes over a pin and a write latch that the caller already holds.
+   * @param bpm the buffer pool the page was fetched from
+   * @param page the pinned and write-latched page, or nullptr for an invalid guard
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  /** Releases the latch and pin this guard holds, then takes over those of that, leaving it invalid. */
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Releases the write latch and the pin. Does nothing if the guard is invalid. */
+  void Drop();
+
+  bool IsValid() const { return guard_.IsValid(); }
+
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  void SetDirty() { guard_.SetDirty(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_free_space_map.h
+//
+// Identification: src/include/storage/table/table_free_space_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TableFreeSpaceMap records about how many bytes each page of a TableHeap has free, in a list of FreeSpaceMapPages,
+ * so that an insert goes straight to a page with room instead of trying every page of the table.
+ *
+ * The map is approximate: it is not logged, and it only learns of a change in a page's free space when the table heap
+ * reports one. An insert checks the page it was sent to and reports what it found, so a stale entry costs one fetch
+ * and is corrected by it. Free space is recorded in buckets of FREE_SPACE_BUCKET_SIZE bytes, rounded down, so that
+ * most inserts leave a page in its bucket and do not write the map at all. In memory the map keeps, for every map
+ * page, an upper bound of the free space its entries record, and where each table page's entry is along with what it
+ * records.
+ *
+ * The in-memory state has a latch of its own that is never held while a page is fetched: the latches of the map pages
+ * order the accesses to them, and an entry is changed together with its copy in memory under its map page's write
+ * latch.
+ */
+class TableFreeSpaceMap {
+ public:
+  /** The granularity of the recorded free space. */
+  static constexpr uint32_t FREE_SPACE_BUCKET_SIZE = PAGE_SIZE / 32;
+
+  /**
+   * Creates an empty map.
+   * @param bpm the buffer pool manager
+   */
+  explicit TableFreeSpaceMap(BufferPoolManager *bpm);
+
+  /**
+   * Opens an existing map, reading each of its pages once.
+   * @param bpm the buffer pool manager
+   * @param first_page_id the id of the first page of the map
+   */
+  TableFreeSpaceMap(BufferPoolManager *bpm, page_id_t first_page_id);
+
+  DISALLOW_COPY_AND_MOVE(TableFreeSpaceMap);
+
+  ~TableFreeSpaceMap() = default;
+
+  /** @return the id of the first page of the map */
+  page_id_t GetFirstPageId() const { return first_page_id_; }
+
+  /** @return the table page added last, i.e. the last page of the table */
+  page_id_t GetLastTablePageId();
+
+  /**
+   * Tracks a table page that was added to the end of the table. A page the map tracks already only becomes the last
+   * table page.
+   * @param page_id id of the table page
+   * @param free_space its free bytes
+   * @return false if the map could not fetch or extend its last page; the map is unchanged then
+   */
+  bool AddTablePage(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Records the free space a table page was seen to have. The map page is only written if the free space moved to
+   * another bucket. Callers should not hold the latch of the table page, so that inserts into other pages do not wait
+   * for it on the map page.
+   * @param page_id id of the table page
+   * @param free_space its free bytes
+   */
+  void UpdateTablePage(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Finds a table page to insert into. Callers on different threads are sent to different pages where several have
+   * room, so that concurrent inserts do not queue for the latch of one page.
+   * @param space_needed the free bytes the insert needs
+   * @return a page that had at least space_needed free bytes when it was last recorded, INVALID_PAGE_ID if none did
+   */
+  page_id_t FindTablePage(uint32_t space_needed);
+
+ private:
+  /** Where the entry of a table page is, and the free space it records. */
+  struct Location {
+    size_t map_page_;
+    uint32_t slot_;
+    uint32_t free_space_;
+  };
+
+  /** @return free_space rounded down to its bucket */
+  static uint32_t ToBucket(uint32_t free_space) {
+    return free_space / FREE_SPACE_BUCKET_SIZE * FREE_SPACE_BUCKET_SIZE;
+  }
+
+  BufferPoolManager *bpm_;
+  page_id_t first_page_id_;
+  /** Protects the members below. It is taken after the latch of a map page, and never held while fetching one. */
+  std::mutex latch_;
+  std::vector<page_id_t> map_page_ids_;
+  /** For each map page, at least the largest free space one of its entries records. */
+  std::vector<uint32_t> max_free_space_;
+  std::unordered_map<page_id_t, Location> locations_;
+  page_id_t last_table_page_id_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
@@ -12,9 +12,15 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/table_free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -23,6 +29,9 @@ namespace bustub {
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * A TableFreeSpaceMap, kept in pages of its own, tells inserts which page has room, so an insert does not walk the
+ * list. A table opened without the id of its map rebuilds the map with one walk of the list before its first insert.
  */
 class TableHeap {
   friend class TableIterator;
@@ -36,9 +45,11 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param first_page_id the id of the first page
+   * @param free_space_map_page_id the id of the first page of the table's free space map, INVALID_PAGE_ID to rebuild
+   * the map, e.g. after a crash, since the map is not logged
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, page_id_t free_space_map_page_id = INVALID_PAGE_ID);
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -55,9 +66,10 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy access strategy of a bulk insert, which keeps the page walk to a private ring of frames
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -99,8 +111,23 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * Read a batch of tuples from the table, such as the matches of an index scan. The pages are fetched together
+   * through BufferPoolManager::FetchPages, in chunks that fit in the buffer pool, and each page is read once, however
+   * many of the tuples it holds.
+   * @param rids rids of the tuples to read
+   * @param[out] tuples the tuples, in the order of rids
+   * @param txn transaction performing the read
+   * @return for each rid, true if the read was successful (i.e. the tuple exists)
+   */
+  std::vector<bool> GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn);
+
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy access strategy of the scan, which keeps it to a private ring of frames; nullptr for none
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -108,11 +135,24 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the id of the first page of the free space map, to open the table with later */
+  page_id_t GetFreeSpaceMapPageId() { return GetFreeSpaceMap()->GetFirstPageId(); }
+
  private:
+  /** @return the free space map, which is opened or rebuilt on first use */
+  TableFreeSpaceMap *GetFreeSpaceMap();
+
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+
+  page_id_t free_space_map_page_id_{INVALID_PAGE_ID};
+  std::unique_ptr<TableFreeSpaceMap> free_space_map_;
+  std::once_flag free_space_map_loaded_;
+  /** Serializes adding pages to the end of the table. */
+  std::mutex append_latch_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,11 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,12 +27,91 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock latch(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  enable_logging = true;
+  stop_ = false;
+  flush_thread_ = new std::thread(&LogManager::FlushLoop, this);
+}
 
 /*
- * Stop and join the flush thread, set enable_logging = false
+ * Set enable_logging = false, stop and join the flush thread
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock latch(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    // Logging is turned off before the final round, so that no record is appended for it to miss.
+    enable_logging = false;
+    stop_ = true;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  delete flush_thread;
+  {
+    std::scoped_lock latch(latch_);
+    flush_thread_ = nullptr;
+    // A record whose append started before logging was turned off may still have missed the final round.
+    WriteBuffer();
+  }
+  // Whoever still waits is served by WriteBuffer from now on.
+  flushed_cv_.notify_all();
+}
+
+void LogManager::FlushLoop() {
+  std::unique_lock<std::mutex> latch(latch_);
+  while (true) {
+    cv_.wait_for(latch, log_timeout, [this] { return flush_requested_ || stop_; });
+    flush_requested_ = false;
+    if (offset_ > 0) {
+      // Everything appended so far goes out with one write and one sync. Records appended meanwhile fill the other
+      // buffer, and their waiters are served by the next round, which starts right after this one.
+      std::swap(log_buffer_, flush_buffer_);
+      const int size = offset_;
+      const lsn_t last_lsn = next_lsn_ - 1;
+      offset_ = 0;
+      latch.unlock();
+      disk_manager_->WriteLog(flush_buffer_, size);
+      latch.lock();
+      persistent_lsn_ = last_lsn;
+    }
+    flushed_cv_.notify_all();
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock<std::mutex> latch(latch_);
+  while (persistent_lsn_ < lsn) {
+    if (flush_thread_ == nullptr) {
+      WriteBuffer();
+      return;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(latch);
+  }
+}
+
+void LogManager::WriteBuffer() {
+  if (offset_ == 0) {
+    return;
+  }
+  // The buffers are swapped like the flush thread does, as the disk manager expects them to alternate.
+  std::swap(log_buffer_, flush_buffer_);
+  disk_manager_->WriteLog(flush_buffer_, offset_);
+  persistent_lsn_ = next_lsn_ - 1;
+  offset_ = 0;
+}
 
 /*
  * append a log record into log buffer
@@ -49,6 +133,57 @@ void LogManager::StopFlushThread() {}
  *  }
  *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  if (log_record->size_ > LOG_BUFFER_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "log record does not fit in the log buffer");
+  }
+  std::unique_lock<std::mutex> latch(latch_);
+  // A full buffer is handed to the flush thread; the record goes into the other one once that has been written.
+  // Without a flush thread, the buffer is written right here.
+  while (offset_ + log_record->size_ > LOG_BUFFER_SIZE) {
+    if (flush_thread_ == nullptr) {
+      WriteBuffer();
+      break;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(latch);
+  }
+
+  log_record->lsn_ = next_lsn_++;
+  memcpy(log_buffer_ + offset_, log_record, LogRecord::HEADER_SIZE);
+  int pos = offset_ + LogRecord::HEADER_SIZE;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(log_buffer_ + pos, &log_record->insert_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->insert_tuple_.SerializeTo(log_buffer_ + pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(log_buffer_ + pos, &log_record->delete_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->delete_tuple_.SerializeTo(log_buffer_ + pos);
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(log_buffer_ + pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.SerializeTo(log_buffer_ + pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(log_buffer_ + pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(log_buffer_ + pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      pos += sizeof(page_id_t);
+      memcpy(log_buffer_ + pos, &log_record->page_id_, sizeof(page_id_t));
+      break;
+    default:
+      // BEGIN, COMMIT and ABORT records are the header alone.
+      break;
+  }
+  offset_ += log_record->size_;
+  return log_record->lsn_;
+}
 
 }  // namespace bustub
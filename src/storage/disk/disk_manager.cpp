@@ -10,21 +10,63 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/crc32c.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+static_assert(PAGE_SIZE % DIRECT_IO_ALIGNMENT == 0, "Direct I/O transfers whole pages.");
+static_assert(PAGE_CHECKSUM_SIZE == sizeof(uint32_t), "A page holds a CRC-32C.");
+
+/**
+ * Makes the data written to fd durable. fdatasync skips the metadata that reading the data back does not need, but
+ * only Linux has it; elsewhere fsync does the job.
+ */
+static int SyncData(int fd) {
+#if defined(__linux__)
+  return fdatasync(fd);
+#else
+  return fsync(fd);
+#endif
+}
+
+uint32_t DiskManager::Checksum(off_t offset, const char *data) {
+  return Crc32c::Compute(data, PAGE_DATA_SIZE) ^ static_cast<uint32_t>(offset / PAGE_SIZE);
+}
+
+void DiskManager::StampChecksum(off_t offset, char *data) {
+  const uint32_t checksum = Checksum(offset, data);
+  memcpy(data + PAGE_DATA_SIZE, &checksum, sizeof(checksum));
+}
+
+void DiskManager::AppendPage(off_t offset, char *data, std::vector<iovec> *iov) {
+  StampChecksum(offset, data);
+  iov->push_back({data, PAGE_SIZE});
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
@@ -38,93 +80,261 @@ DiskManager::DiskManager(const std::string &db_file)
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
-
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // The log is only ever appended to, and read back with pread during recovery.
+  log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
+  }
+
+  // Pages are read and written with pread and pwrite, which do not share a file position, so that I/O at different
+  // offsets from different threads proceeds in parallel.
+  if (disk_manager_direct_io.load()) {
+#if defined(O_DIRECT)
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+    if (!direct_io_ && errno == EINVAL) {
+      LOG_WARN("The file system of %s does not support O_DIRECT, using the page cache.", db_file.c_str());
+    }
+#elif defined(F_NOCACHE)
+    // macOS has no O_DIRECT, but can keep the pages of a single file out of its cache.
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+    direct_io_ = db_fd_ >= 0 && fcntl(db_fd_, F_NOCACHE, 1) == 0;
+    if (db_fd_ >= 0 && !direct_io_) {
+      LOG_WARN("Cannot turn off caching for %s, using the page cache.", db_file.c_str());
     }
+#else
+    LOG_WARN("Direct I/O is not supported on this platform, using the page cache.");
+#endif
+  }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
   }
   buffer_used = nullptr;
+
+  // Every page in the file counts as allocated, except for the free ones in the bitmap pages.
+  struct stat stat_buf;
+  const off_t file_pages = fstat(db_fd_, &stat_buf) == 0 ? (stat_buf.st_size + PAGE_SIZE - 1) / PAGE_SIZE : 0;
+  const off_t bitmaps = (file_pages + PAGES_PER_BITMAP) / (PAGES_PER_BITMAP + 1);
+  next_page_id_ = static_cast<page_id_t>(file_pages - bitmaps);
+  free_pages_.resize(bitmaps * WORDS_PER_BITMAP);
+  reserved_extents_.resize(bitmaps * WORDS_PER_BITMAP);
+  alignas(DIRECT_IO_ALIGNMENT) char block[PAGE_SIZE];
+  for (off_t bitmap = 0; bitmap < bitmaps; ++bitmap) {
+    const off_t offset = bitmap * (PAGES_PER_BITMAP + 1) * PAGE_SIZE;
+    // The free pages of a bitmap page that cannot be trusted are lost, rather than handed out while in use.
+    if (ReadBlock(offset, block) && VerifyChecksum(offset, block)) {
+      memcpy(&free_pages_[bitmap * WORDS_PER_BITMAP], block, WORDS_PER_BITMAP * sizeof(uint64_t));
+      memcpy(&reserved_extents_[bitmap * WORDS_PER_BITMAP], block + WORDS_PER_BITMAP * sizeof(uint64_t),
+             WORDS_PER_BITMAP * sizeof(uint64_t));
+    }
+  }
+  // A page recorded as free past the end of the file was never written after all; it is handed out as a new one. An
+  // extent that starts there was never used either.
+  for (page_id_t page_id = next_page_id_; page_id < static_cast<page_id_t>(bitmaps * PAGES_PER_BITMAP); ++page_id) {
+    free_pages_[page_id / 64] &= ~(uint64_t{1} << (page_id % 64));
+    reserved_extents_[page_id / 64] &= ~(uint64_t{1} << (page_id % 64));
+  }
+  for (uint64_t word : free_pages_) {
+    num_free_pages_ += __builtin_popcountll(word);
+  }
+}
+
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
-  log_io_.close();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
+  if (db_fd_ >= 0) {
+    Sync();
+    close(db_fd_);
+    db_fd_ = -1;
+  }
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+void DiskManager::WritePage(page_id_t page_id, char *page_data) {
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  StampChecksum(PageOffset(page_id), page_data);
+  iovec iov = {page_data, PAGE_SIZE};
+  if (!WriteVectored(&iov, 1, PageOffset(page_id))) {
     LOG_DEBUG("I/O error while writing");
-    return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
 }
 
 /**
- * Read the contents of the specified page into the given memory area
+ * Write a batch of pages: sort them by page id, write each run of adjacent pages with one pwritev and sync once
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, char *>> *pages) {
+  std::sort(pages->begin(), pages->end());
+  std::vector<iovec> iovecs;
+  size_t begin = 0;
+  while (begin < pages->size()) {
+    size_t end = begin + 1;
+    while (end < pages->size() && PageOffset((*pages)[end].first) == PageOffset((*pages)[end - 1].first) + PAGE_SIZE &&
+           end - begin < IOV_MAX) {
+      end++;
+    }
+    iovecs.clear();
+    for (size_t i = begin; i < end; ++i) {
+      AppendPage(PageOffset((*pages)[i].first), (*pages)[i].second, &iovecs);
+    }
+    num_writes_ += static_cast<int>(end - begin);
+    if (!WriteVectored(iovecs.data(), static_cast<int>(iovecs.size()),
+                       PageOffset((*pages)[begin].first))) {
+      LOG_DEBUG("I/O error while writing");
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page %d", page_id);
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    begin = end;
+  }
+  if (!pages->empty()) {
+    Sync();
+  }
+}
+
+/**
+ * Make the pages written so far durable
+ */
+void DiskManager::Sync() {
+  if (SyncData(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+bool DiskManager::WriteVectored(iovec *iov, int iovcnt, off_t offset) {
+  if (!CanTransfer(iov, iovcnt)) {
+    // Gather the data into an aligned buffer for direct I/O.
+    size_t bytes = 0;
+    for (int i = 0; i < iovcnt; ++i) {
+      bytes += iov[i].iov_len;
+    }
+    const size_t aligned_bytes = (bytes + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+    std::unique_ptr<char, decltype(&std::free)> bounce(
+        static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, aligned_bytes)), &std::free);
+    if (bounce == nullptr) {
+      return false;
+    }
+    char *end = bounce.get();
+    for (int i = 0; i < iovcnt; ++i) {
+      memcpy(end, iov[i].iov_base, iov[i].iov_len);
+      end += iov[i].iov_len;
+    }
+    num_bounced_writes_ += 1;
+    iovec gathered = {bounce.get(), bytes};
+    return WriteVectored(&gathered, 1, offset);
+  }
+  while (iovcnt > 0) {
+    num_write_calls_ += 1;
+    ssize_t written = pwritev(db_fd_, iov, iovcnt, offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    // Skip what a short write got through and go on from there.
+    offset += written;
+    while (iovcnt > 0 && static_cast<size_t>(written) >= iov->iov_len) {
+      written -= static_cast<ssize_t>(iov->iov_len);
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + written;
+      iov->iov_len -= written;
+    }
+  }
+  return true;
+}
+
+bool DiskManager::CanTransfer(const iovec *iov, int iovcnt) const {
+  if (!direct_io_) {
+    return true;
+  }
+  for (int i = 0; i < iovcnt; ++i) {
+    if (reinterpret_cast<uintptr_t>(iov[i].iov_base) % DIRECT_IO_ALIGNMENT != 0 ||
+        iov[i].iov_len % DIRECT_IO_ALIGNMENT != 0) {
+      return false;
     }
   }
+  return true;
+}
+
+/**
+ * Read the contents of the specified page into the given memory area and verify its checksum
+ */
+bool DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  return ReadBlock(PageOffset(page_id), page_data) && VerifyChecksum(PageOffset(page_id), page_data);
+}
+
+bool DiskManager::ReadBlock(off_t offset, char *data) {
+  iovec iov = {data, PAGE_SIZE};
+  if (!CanTransfer(&iov, 1)) {
+    // Read into an aligned buffer for direct I/O and copy the page out.
+    alignas(DIRECT_IO_ALIGNMENT) static thread_local char bounce[PAGE_SIZE];
+    if (!ReadBlock(offset, bounce)) {
+      return false;
+    }
+    memcpy(data, bounce, PAGE_SIZE);
+    return true;
+  }
+  char *page_data = data;
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t n = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_count += n;
+  }
+  // if file ends before reading PAGE_SIZE, which includes reading past its end
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page at offset %jd", static_cast<intmax_t>(offset));
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  return true;
+}
+
+bool DiskManager::VerifyChecksum(off_t offset, char *data) {
+  uint32_t checksum;
+  memcpy(&checksum, data + PAGE_DATA_SIZE, sizeof(checksum));
+  if (checksum == Checksum(offset, data) ||
+      (checksum == 0 && std::all_of(data, data + PAGE_DATA_SIZE, [](char c) { return c == 0; }))) {
+    memset(data + PAGE_DATA_SIZE, 0, PAGE_CHECKSUM_SIZE);
+    return true;
+  }
+  num_checksum_failures_ += 1;
+  LOG_ERROR("The block at offset %jd of %s fails its checksum", static_cast<intmax_t>(offset), file_name_.c_str());
+  return false;
 }
 
 /**
  * Write the contents of the log into disk file
- * Only return when sync is done, and only perform sequence write
+ * Only return when sync is done, and only perform sequence write. A single sync makes the whole buffer durable,
+ * so the records of every transaction that committed into it share one sync.
  */
 void DiskManager::WriteLog(char *log_data, int size) {
   // enforce swap log buffer
@@ -144,15 +354,21 @@ void DiskManager::WriteLog(char *log_data, int size) {
 
   num_flushes_ += 1;
   // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
+  for (int written = 0; written < size;) {
+    ssize_t n = write(log_fd_, log_data + written, size - written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing log");
+      return;
+    }
+    written += static_cast<int>(n);
+  }
+  if (SyncData(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
   flush_log_ = false;
 }
 
@@ -167,17 +383,23 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+  int read_count = 0;
+  while (read_count < size) {
+    ssize_t n = pread(log_fd_, log_data + read_count, size - read_count, offset + read_count);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_count += static_cast<int>(n);
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
@@ -186,16 +408,222 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Reuse the free page closest to the hint, or grow the file
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(page_id_t hint, uint32_t stride, uint32_t residue) {
+  std::scoped_lock guard(allocation_latch_);
+  page_id_t page_id;
+  if (hint >= 0) {
+    // The hint picks a run of stride * EXTENT_SIZE ids; the page comes from the extent of this allocator in it.
+    const page_id_t near = hint - hint % static_cast<page_id_t>(stride) + static_cast<page_id_t>(residue);
+    page_id = FindFreePageInExtent(near, stride);
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = ReserveExtent(stride, residue, near);
+    }
+  } else {
+    page_id = FindFreePage(stride, residue);
+    if (page_id == INVALID_PAGE_ID) {
+      // The ids skipped to get to the residue belong to the other allocators; they are recorded as free for them.
+      GrowTo(next_page_id_ + static_cast<page_id_t>((residue + stride - next_page_id_ % stride) % stride));
+      return next_page_id_++;
+    }
+  }
+  SetFree(page_id, false);
+  WriteBitmap(page_id);
+  return page_id;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * Mark the page free in the bitmap, so that AllocatePage reuses it
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock guard(allocation_latch_);
+  if (page_id < 0 || page_id >= next_page_id_ || IsFree(page_id)) {
+    return;
+  }
+  SetFree(page_id, true);
+  WriteBitmap(page_id);
+}
+
+bool DiskManager::IsAllocated(page_id_t page_id) {
+  std::scoped_lock guard(allocation_latch_);
+  return page_id >= 0 && page_id < next_page_id_ && !IsFree(page_id);
+}
+
+size_t DiskManager::GetNumFreePages() {
+  std::scoped_lock guard(allocation_latch_);
+  return num_free_pages_;
+}
+
+bool DiskManager::IsFree(page_id_t page_id) const {
+  const auto word = static_cast<size_t>(page_id / 64);
+  return word < free_pages_.size() && (free_pages_[word] >> (page_id % 64) & 1) != 0;
+}
+
+void DiskManager::SetFree(page_id_t page_id, bool free) {
+  CoverPage(page_id);
+  const uint64_t bit = uint64_t{1} << (page_id % 64);
+  if (free) {
+    free_pages_[page_id / 64] |= bit;
+    num_free_pages_++;
+    free_word_ = std::min(free_word_, static_cast<size_t>(page_id / 64));
+  } else {
+    free_pages_[page_id / 64] &= ~bit;
+    num_free_pages_--;
+  }
+}
+
+bool DiskManager::IsReserved(page_id_t page_id) const {
+  const auto word = static_cast<size_t>(page_id / 64);
+  return word < reserved_extents_.size() && (reserved_extents_[word] >> (page_id % 64) & 1) != 0;
+}
+
+void DiskManager::SetReserved(page_id_t page_id) {
+  CoverPage(page_id);
+  reserved_extents_[page_id / 64] |= uint64_t{1} << (page_id % 64);
+}
+
+void DiskManager::CoverPage(page_id_t page_id) {
+  const size_t words = (page_id / PAGES_PER_BITMAP + 1) * WORDS_PER_BITMAP;
+  if (free_pages_.size() < words) {
+    free_pages_.resize(words);
+    reserved_extents_.resize(words);
+  }
+}
+
+void DiskManager::WriteBitmap(page_id_t page_id) {
+  const page_id_t bitmap = page_id / PAGES_PER_BITMAP;
+  const off_t offset = static_cast<off_t>(bitmap) * (PAGES_PER_BITMAP + 1) * PAGE_SIZE;
+  alignas(DIRECT_IO_ALIGNMENT) char block[PAGE_SIZE];
+  memcpy(block, &free_pages_[bitmap * WORDS_PER_BITMAP], WORDS_PER_BITMAP * sizeof(uint64_t));
+  memcpy(block + WORDS_PER_BITMAP * sizeof(uint64_t), &reserved_extents_[bitmap * WORDS_PER_BITMAP],
+         WORDS_PER_BITMAP * sizeof(uint64_t));
+  memset(block + 2 * WORDS_PER_BITMAP * sizeof(uint64_t), 0, PAGE_DATA_SIZE - 2 * WORDS_PER_BITMAP * sizeof(uint64_t));
+  StampChecksum(offset, block);
+  iovec iov = {block, PAGE_SIZE};
+  if (!WriteVectored(&iov, 1, offset)) {
+    LOG_DEBUG("I/O error while writing the free-page bitmap");
+  }
+}
+
+void DiskManager::GrowTo(page_id_t end) {
+  for (page_id_t page_id = next_page_id_; page_id < end; ++page_id) {
+    SetFree(page_id, true);
+    if (page_id == end - 1 || (page_id + 1) % PAGES_PER_BITMAP == 0) {
+      WriteBitmap(page_id);
+    }
+  }
+  next_page_id_ = std::max(next_page_id_, end);
+}
+
+page_id_t DiskManager::FindFreePage(uint32_t stride, uint32_t residue) {
+  if (num_free_pages_ == 0) {
+    return INVALID_PAGE_ID;
+  }
+  // The bits of a word that stand for pages with the right residue.
+  auto residue_mask = [&](size_t word) {
+    if (stride == 1) {
+      return ~uint64_t{0};
+    }
+    uint64_t mask = 0;
+    for (uint64_t bit = (residue + stride - word * 64 % stride) % stride; bit < 64; bit += stride) {
+      mask |= uint64_t{1} << bit;
+    }
+    return mask;
+  };
+  // The free pages of a word that lie outside the reserved extents.
+  auto unreserved = [&](size_t word) {
+    uint64_t free = free_pages_[word];
+    for (uint64_t bits = free; bits != 0; bits &= bits - 1) {
+      const auto page_id = static_cast<page_id_t>(word * 64 + __builtin_ctzll(bits));
+      if (IsReserved(ExtentOf(page_id, stride))) {
+        free &= ~(uint64_t{1} << (page_id % 64));
+      }
+    }
+    return free;
+  };
+  // Which extents a page belongs to depends on the stride, and so does the cursor.
+  if (stride != free_word_stride_) {
+    free_word_ = 0;
+    free_word_stride_ = stride;
+  }
+  // The search starts at the cursor, and moves it past the words at its start that hold no page to hand out.
+  for (size_t word = free_word_; word < free_pages_.size(); ++word) {
+    const uint64_t free = unreserved(word);
+    if (free == 0 && word == free_word_) {
+      free_word_++;
+    }
+    const uint64_t bits = free & residue_mask(word);
+    if (bits != 0) {
+      return static_cast<page_id_t>(word * 64 + __builtin_ctzll(bits));
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+page_id_t DiskManager::FindFreePageInExtent(page_id_t hint, uint32_t stride) {
+  const page_id_t extent = ExtentOf(hint, stride);
+  if (!IsReserved(extent)) {
+    return INVALID_PAGE_ID;
+  }
+  // After a restart, an extent reserved at the end of the file only reaches as far as its pages that were written.
+  const page_id_t last = extent + static_cast<page_id_t>(stride * (EXTENT_SIZE - 1));
+  if (last >= next_page_id_) {
+    GrowTo(last + 1);
+  }
+  // The pages from hint on come first, as a table or an index mostly grows at its end.
+  const auto extent_size = static_cast<page_id_t>(EXTENT_SIZE);
+  const page_id_t position = (hint - extent) / static_cast<page_id_t>(stride);
+  for (page_id_t i = 0; i < extent_size; ++i) {
+    const page_id_t page_id = extent + (position + i) % extent_size * static_cast<page_id_t>(stride);
+    if (page_id < next_page_id_ && IsFree(page_id)) {
+      return page_id;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+page_id_t DiskManager::ReserveExtent(uint32_t stride, uint32_t residue, page_id_t near) {
+  const auto span = static_cast<page_id_t>(stride * EXTENT_SIZE);
+  const auto last = static_cast<page_id_t>(stride * (EXTENT_SIZE - 1));
+  // The extent of near comes first, so that the extents the instances of a parallel buffer pool reserve for one
+  // table lie side by side.
+  const page_id_t preferred = ExtentOf(near, stride);
+  if (!IsReserved(preferred)) {
+    page_id_t page_id = preferred;
+    while (page_id <= preferred + last && (page_id >= next_page_id_ || IsFree(page_id))) {
+      page_id += static_cast<page_id_t>(stride);
+    }
+    if (page_id > preferred + last) {
+      SetReserved(preferred);
+      WriteBitmap(preferred);
+      GrowTo(preferred + last + 1);
+      return near;
+    }
+  }
+  // An extent whose pages were all deallocated, such as one of a dropped table, is reused before the file grows.
+  if (num_free_pages_ >= EXTENT_SIZE) {
+    for (auto extent = static_cast<page_id_t>(residue); extent + last < next_page_id_; extent += span) {
+      page_id_t page_id = extent;
+      while (page_id <= extent + last && IsFree(page_id)) {
+        page_id += static_cast<page_id_t>(stride);
+      }
+      if (page_id > extent + last) {
+        SetReserved(extent);
+        return extent;
+      }
+    }
+  }
+  // Otherwise the file grows by an extent. The pages skipped to get to its start are handed out one by one.
+  page_id_t extent = next_page_id_ / span * span + static_cast<page_id_t>(residue);
+  if (extent < next_page_id_) {
+    extent += span;
+  }
+  SetReserved(extent);
+  GrowTo(extent + last + 1);
+  return extent;
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,6 +635,21 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of write system calls issued for pages
+ */
+int DiskManager::GetNumWriteCalls() const { return num_write_calls_; }
+
+/**
+ * Returns number of page writes copied through an aligned buffer for direct I/O
+ */
+int DiskManager::GetNumBouncedWrites() const { return num_bounced_writes_; }
+
+/**
+ * Returns number of pages read that failed their checksum
+ */
+int DiskManager::GetNumChecksumFailures() const { return num_checksum_failures_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -0,0 +1,493 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef __linux__
+/**
+ * A minimal io_uring instance, set up with raw system calls: the submission and completion rings are mapped into
+ * the process and shared with the kernel. The submission side is used by one thread at a time, under the latch of the
+ * scheduler, and the completion side by the reaper thread alone.
+ */
+class IoUring {
+ public:
+  /** @return an instance with room for at least entries submissions, nullptr if the kernel does not provide one */
+  static std::unique_ptr<IoUring> Create(unsigned entries) {
+    std::unique_ptr<IoUring> ring(new IoUring());
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring->fd_ < 0 || params.sq_entries < entries) {
+      return nullptr;
+    }
+    ring->entries_ = params.sq_entries;
+    ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+    }
+    ring->sq_ring_ = ring->Map(ring->sq_ring_size_, IORING_OFF_SQ_RING);
+    if (ring->sq_ring_ == nullptr) {
+      return nullptr;
+    }
+    if (single_mmap) {
+      ring->cq_ring_ = ring->sq_ring_;
+    } else if ((ring->cq_ring_ = ring->Map(ring->cq_ring_size_, IORING_OFF_CQ_RING)) == nullptr) {
+      return nullptr;
+    }
+    ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes_ = static_cast<io_uring_sqe *>(ring->Map(ring->sqes_size_, IORING_OFF_SQES));
+    if (ring->sqes_ == nullptr) {
+      return nullptr;
+    }
+
+    auto *sq = static_cast<char *>(ring->sq_ring_);
+    ring->sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    ring->sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(ring->cq_ring_);
+    ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    ring->cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    ring->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return ring;
+  }
+
+  ~IoUring() {
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(IoUring);
+
+  /**
+   * Queues a vectored read or write, to be handed to the kernel by the next Submit.
+   * @return false if the queue is full
+   */
+  bool QueueTransfer(bool is_write, int fd, off_t offset, const std::vector<iovec> &iov, void *user_data) {
+    io_uring_sqe *sqe = NextSqe();
+    if (sqe == nullptr) {
+      return false;
+    }
+    sqe->opcode = is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = static_cast<uint64_t>(offset);
+    sqe->addr = reinterpret_cast<uint64_t>(iov.data());
+    sqe->len = static_cast<uint32_t>(iov.size());
+    sqe->user_data = reinterpret_cast<uint64_t>(user_data);
+    return true;
+  }
+
+  /**
+   * Queues a no-op, whose completion carries no user data.
+   * @return false if the queue is full
+   */
+  bool QueueNop() {
+    io_uring_sqe *sqe = NextSqe();
+    if (sqe == nullptr) {
+      return false;
+    }
+    sqe->opcode = IORING_OP_NOP;
+    return true;
+  }
+
+  /**
+   * Hands the entries taken since the last call to the kernel. If the kernel refuses some of them, they are taken
+   * back out of the queue.
+   * @return the number of entries, the last ones taken, that were not submitted
+   */
+  unsigned Submit() {
+    while (pending_ > 0) {
+      long submitted = syscall(__NR_io_uring_enter, fd_, pending_, 0, 0, nullptr, 0);  // NOLINT
+      if (submitted >= 0) {
+        pending_ -= static_cast<unsigned>(submitted);
+      } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        LOG_WARN("io_uring_enter failed: %s", strerror(errno));
+        __atomic_store_n(sq_tail_, *sq_tail_ - pending_, __ATOMIC_RELEASE);
+        return std::exchange(pending_, 0);
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * Takes the next completion, waiting for one if there is none yet.
+   * @param[out] result the number of bytes transferred, or a negated errno
+   * @return the user data of the completed entry
+   */
+  void *WaitCompletion(int *result) {
+    while (true) {
+      const unsigned head = *cq_head_;
+      if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        *result = cqe.res;
+        void *user_data = reinterpret_cast<void *>(cqe.user_data);
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        return user_data;
+      }
+      syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+  }
+
+ private:
+  IoUring() = default;
+
+  /**
+   * Takes the next submission queue entry. Without a kernel polling thread the kernel only looks at the queue while
+   * Submit runs, so the entry may be filled in after it is queued.
+   * @return the zeroed entry, nullptr if the queue is full
+   */
+  io_uring_sqe *NextSqe() {
+    const unsigned tail = *sq_tail_;
+    if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= entries_) {
+      return nullptr;
+    }
+    io_uring_sqe *sqe = &sqes_[tail & sq_mask_];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[tail & sq_mask_] = tail & sq_mask_;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    pending_++;
+    return sqe;
+  }
+
+  void *Map(size_t size, off_t offset) {
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+    return data == MAP_FAILED ? nullptr : data;
+  }
+
+  int fd_{-1};
+  unsigned entries_{0};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+  /** Entries taken but not submitted yet. */
+  unsigned pending_{0};
+};
+#else
+/** io_uring is specific to Linux. Elsewhere no instance can be created, and the scheduler uses its thread pool. */
+class IoUring {
+ public:
+  static std::unique_ptr<IoUring> Create(unsigned /*entries*/) { return nullptr; }
+  bool QueueTransfer(bool /*is_write*/, int /*fd*/, off_t /*offset*/, const std::vector<iovec> & /*iov*/,
+                     void * /*user_data*/) {
+    return false;
+  }
+  bool QueueNop() { return false; }
+  unsigned Submit() { return 0; }
+  void *WaitCompletion(int *result) {
+    *result = 0;
+    return nullptr;
+  }
+};
+#endif
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t queue_depth)
+    : disk_manager_(disk_manager), queue_depth_(queue_depth) {
+  BUSTUB_ASSERT(queue_depth > 0, "A disk scheduler needs room for at least one request.");
+  if (disk_scheduler_io_uring.load()) {
+    ring_ = IoUring::Create(static_cast<unsigned>(queue_depth));
+    if (ring_ == nullptr) {
+      LOG_WARN("io_uring is not available, issuing disk requests from a thread pool.");
+    } else {
+      reaper_ = std::thread(&DiskScheduler::ReapLoop, this);
+    }
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    room_cv_.wait(lock, [this] { return in_flight_ == 0; });
+    stop_ = true;
+    if (ring_ != nullptr) {
+      // A no-op without an operation tells the reaper to exit.
+      ring_->QueueNop();
+      ring_->Submit();
+    }
+  }
+  work_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  if (reaper_.joinable()) {
+    reaper_.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) {
+  std::vector<DiskRequest> requests;
+  requests.push_back(std::move(r));
+  Schedule(&requests);
+}
+
+void DiskScheduler::Schedule(std::vector<DiskRequest> *requests) {
+  std::vector<Operation *> ops;
+  ops.reserve(requests->size());
+  for (auto &request : *requests) {
+    auto callback = std::make_shared<std::promise<bool>>(std::move(request.callback_));
+    auto *op = new Operation{request.is_write_, request.page_id_, {}, {nullptr, &std::free},
+                             [callback](bool success) { callback->set_value(success); }};
+    if (request.is_write_) {
+      DiskManager::AppendPage(DiskManager::PageOffset(request.page_id_), request.data_, &op->iov_);
+      disk_manager_->num_writes_ += 1;
+    } else {
+      op->iov_.push_back({request.data_, PAGE_SIZE});
+    }
+    ops.push_back(op);
+  }
+  requests->clear();
+  Submit(&ops);
+}
+
+std::future<bool> DiskScheduler::ScheduleWrites(std::vector<std::pair<page_id_t, char *>> *pages) {
+  struct Batch {
+    std::promise<bool> promise_;
+    std::atomic<size_t> remaining_{0};
+    std::atomic<bool> success_{true};
+  };
+  auto batch = std::make_shared<Batch>();
+  std::future<bool> future = batch->promise_.get_future();
+  std::sort(pages->begin(), pages->end());
+
+  std::vector<Operation *> ops;
+  size_t begin = 0;
+  while (begin < pages->size()) {
+    size_t end = begin + 1;
+    // A run of adjacent page ids is split where a bitmap page sits between two of its pages in the file.
+    while (end < pages->size() && end - begin < IOV_MAX &&
+           DiskManager::PageOffset((*pages)[end].first) ==
+               DiskManager::PageOffset((*pages)[end - 1].first) + PAGE_SIZE) {
+      end++;
+    }
+    auto *op = new Operation{true, (*pages)[begin].first, {}, {nullptr, &std::free}, [batch](bool success) {
+                               if (!success) {
+                                 batch->success_ = false;
+                               }
+                               if (--batch->remaining_ == 0) {
+                                 batch->promise_.set_value(batch->success_);
+                               }
+                             }};
+    for (size_t i = begin; i < end; ++i) {
+      DiskManager::AppendPage(DiskManager::PageOffset((*pages)[i].first), (*pages)[i].second, &op->iov_);
+    }
+    disk_manager_->num_writes_ += static_cast<int>(end - begin);
+    ops.push_back(op);
+    begin = end;
+  }
+  if (ops.empty()) {
+    batch->promise_.set_value(true);
+    return future;
+  }
+  batch->remaining_ = ops.size();
+  Submit(&ops);
+  return future;
+}
+
+size_t DiskScheduler::GetMaxInFlight() {
+  std::scoped_lock guard(latch_);
+  return max_in_flight_;
+}
+
+void DiskScheduler::Submit(std::vector<Operation *> *ops) {
+  std::unique_lock<std::mutex> lock(latch_);
+  // Operations whose entries are queued in the ring but not handed to the kernel yet, and operations that the ring
+  // cannot take and that are executed with blocking calls instead.
+  std::vector<Operation *> queued;
+  std::vector<Operation *> sync_ops;
+  auto submit_queued = [&] {
+    unsigned unsubmitted = ring_->Submit();
+    sync_ops.insert(sync_ops.end(), queued.end() - unsubmitted, queued.end());
+    queued.clear();
+    if (sync_ops.empty()) {
+      return;
+    }
+    lock.unlock();
+    for (Operation *op : sync_ops) {
+      Finish(op, RunSync(op, 0));
+    }
+    sync_ops.clear();
+    lock.lock();
+  };
+
+  for (Operation *op : *ops) {
+    if (in_flight_ == queue_depth_) {
+      // Nothing completes that the kernel has not seen, so hand it what is queued before waiting for room.
+      if (ring_ != nullptr) {
+        submit_queued();
+      }
+      room_cv_.wait(lock, [this] { return in_flight_ < queue_depth_; });
+    }
+    in_flight_++;
+    max_in_flight_ = std::max(max_in_flight_, in_flight_);
+    if (ring_ == nullptr) {
+      queue_.push_back(op);
+      // Grow the pool until every operation in flight can have a thread of its own.
+      if (queue_.size() > idle_workers_ && workers_.size() < queue_depth_) {
+        workers_.emplace_back(&DiskScheduler::WorkerLoop, this);
+      }
+      work_cv_.notify_one();
+      continue;
+    }
+    if (!disk_manager_->CanTransfer(op->iov_.data(), static_cast<int>(op->iov_.size())) && !GatherWrite(op)) {
+      // The DiskManager reads unaligned buffers through an aligned one for direct I/O.
+      sync_ops.push_back(op);
+      continue;
+    }
+    // At most queue_depth_ operations are in flight and the ring has room for as many, so there is always an entry.
+    [[maybe_unused]] const bool queued_op =
+        ring_->QueueTransfer(op->is_write_, disk_manager_->db_fd_, DiskManager::PageOffset(op->page_id_), op->iov_, op);
+    BUSTUB_ASSERT(queued_op, "The submission queue cannot be full.");
+    if (op->is_write_) {
+      disk_manager_->num_write_calls_ += 1;
+    }
+    queued.push_back(op);
+  }
+  if (ring_ != nullptr) {
+    submit_queued();
+  }
+  ops->clear();
+}
+
+bool DiskScheduler::GatherWrite(Operation *op) {
+  if (!op->is_write_) {
+    return false;
+  }
+  size_t bytes = 0;
+  for (const auto &iov : op->iov_) {
+    bytes += iov.iov_len;
+  }
+  op->bounce_.reset(static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, bytes)));
+  if (op->bounce_ == nullptr) {
+    return false;
+  }
+  char *end = op->bounce_.get();
+  for (const auto &iov : op->iov_) {
+    memcpy(end, iov.iov_base, iov.iov_len);
+    end += iov.iov_len;
+  }
+  op->iov_ = {{op->bounce_.get(), bytes}};
+  return true;
+}
+
+bool DiskScheduler::RunSync(Operation *op, size_t done) {
+  if (!op->is_write_) {
+    // A short read is nearly always one at the end of the file; reading the page again zero-fills the rest.
+    return disk_manager_->ReadPage(op->page_id_, static_cast<char *>(op->iov_[0].iov_base));
+  }
+  std::vector<iovec> iov = op->iov_;
+  auto it = iov.begin();
+  size_t skip = done;
+  while (skip >= it->iov_len) {
+    skip -= it->iov_len;
+    ++it;
+  }
+  it->iov_base = static_cast<char *>(it->iov_base) + skip;
+  it->iov_len -= skip;
+  return disk_manager_->WriteVectored(&*it, static_cast<int>(iov.end() - it),
+                                      DiskManager::PageOffset(op->page_id_) + static_cast<off_t>(done));
+}
+
+void DiskScheduler::Finish(Operation *op, bool success) {
+  op->done_(success);
+  delete op;
+  std::scoped_lock guard(latch_);
+  in_flight_--;
+  room_cv_.notify_all();
+}
+
+void DiskScheduler::ReapLoop() {
+  while (true) {
+    int result;
+    auto *op = static_cast<Operation *>(ring_->WaitCompletion(&result));
+    if (op == nullptr) {
+      return;
+    }
+    size_t bytes = 0;
+    for (const auto &iov : op->iov_) {
+      bytes += iov.iov_len;
+    }
+    bool success;
+    if (result < 0 && result != -EINTR && result != -EAGAIN) {
+      LOG_DEBUG("I/O error on page %d: %s", op->page_id_, strerror(-result));
+      success = false;
+    } else {
+      // Finish what an interrupted or short transfer left undone with blocking calls, which verify a read page.
+      const auto done = static_cast<size_t>(std::max(result, 0));
+      if (done < bytes) {
+        success = RunSync(op, done);
+      } else {
+        success = op->is_write_ || disk_manager_->VerifyChecksum(DiskManager::PageOffset(op->page_id_),
+                                                                 static_cast<char *>(op->iov_[0].iov_base));
+      }
+    }
+    Finish(op, success);
+  }
+}
+
+void DiskScheduler::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    idle_workers_++;
+    work_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    idle_workers_--;
+    if (queue_.empty()) {
+      return;
+    }
+    Operation *op = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    Finish(op, RunSync(op, 0));
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
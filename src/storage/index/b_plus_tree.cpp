@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
 
 #include "common/exception.h"
@@ -24,7 +25,9 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
+      // A full leaf takes one more pair before it is split; keep room for it inside the page.
+      leaf_max_size_(std::min(leaf_max_size, static_cast<int>((PAGE_DATA_SIZE - LEAF_PAGE_HEADER_SIZE) /
+                                                              sizeof(std::pair<KeyType, ValueType>)) - 1)),
       internal_max_size_(internal_max_size) {}
 
 /*
@@ -44,16 +47,19 @@ bool BPLUSTREE_TYPE::IsEmpty() const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  Page *page = FindLeafPage(key);
-  LOG_DEBUG("leaf page %d", page->GetPageId());
-  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  if (IsEmpty()) {
+    return false;
+  }
+  BasicPageGuard page = FindLeafPage(key);
+  if (!page.IsValid()) {
+    return false;
+  }
+  LOG_DEBUG("leaf page %d", page.PageId());
   ValueType tmp;
-  if (leaf_page->Lookup(key, &tmp, comparator_)) {
+  if (page.As<LeafPage>()->Lookup(key, &tmp, comparator_)) {
     result->push_back(tmp);
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
     return true;
   }
-  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
   return false;
 }
 
@@ -88,13 +94,14 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   page_id_t new_root_page_id;
-  Page *root_page = buffer_pool_manager_->NewPage(&new_root_page_id);
+  BasicPageGuard root_page = buffer_pool_manager_->NewPageGuarded(&new_root_page_id);
+  if (!root_page.IsValid()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a root page");
+  }
   LOG_DEBUG("new root page id %d", new_root_page_id);
-  LeafPage *bplus_root_page = reinterpret_cast<LeafPage *>(root_page->GetData());
-  bplus_root_page->Init(new_root_page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root_page.AsMut<LeafPage>()->Init(new_root_page_id, INVALID_PAGE_ID, leaf_max_size_);
   root_page_id_ = new_root_page_id;
   UpdateRootPageId(false);
-  buffer_pool_manager_->UnpinPage(new_root_page_id, true);
 }
 
 /*
@@ -107,32 +114,30 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  Page* page = FindLeafPage(key);
-  LeafPage* leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  BasicPageGuard page = FindLeafPage(key);
+  LeafPage* leaf_page = page.As<LeafPage>();
   LOG_DEBUG("insert into leaf page_id: %d, max_size: %d\n", int(leaf_page->GetPageId()), leaf_page->GetMaxSize());
   ValueType tmp;
   if (leaf_page->Lookup(key, &tmp, comparator_)) {
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
     return false;
   }
 
+  page.SetDirty();
   /* insert normally*/
   if (leaf_page->GetSize() < leaf_page->GetMaxSize()) {
     leaf_page->Insert(key, value, comparator_);
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
   } else {
     // Insert and split
     leaf_page->Insert(key, value, comparator_);
     LOG_DEBUG("[SPLIT] insert into leaf page_id: %d, value %s", int(leaf_page->GetPageId()), value.ToString().c_str());
-    LeafPage* new_leaf_page = Split(leaf_page);
+    BasicPageGuard new_page = Split(leaf_page);
+    LeafPage* new_leaf_page = new_page.As<LeafPage>();
     page_id_t tmp = leaf_page->GetNextPageId();
     leaf_page->SetNextPageId(new_leaf_page->GetPageId());
     new_leaf_page->SetNextPageId(tmp);
     InsertIntoParent(reinterpret_cast<BPlusTreePage *>(leaf_page), 
                       new_leaf_page->KeyAt(0),
                       reinterpret_cast<BPlusTreePage *>(new_leaf_page));
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId(), true);
   }
   return true;
 }
@@ -143,14 +148,20 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * @return: a guard holding the pin on the new page, which is marked dirty
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
+BasicPageGuard BPLUSTREE_TYPE::Split(N *node) {
   page_id_t new_page_id;
-  auto page = buffer_pool_manager_->NewPage(&new_page_id);
+  // The new sibling goes into the extent of node, so that the pages of the tree lie together on disk and a range scan
+  // reads runs of adjacent pages.
+  BasicPageGuard page = buffer_pool_manager_->NewPageGuarded(&new_page_id, nullptr, node->GetPageId());
+  if (!page.IsValid()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a page to split into");
+  }
   LOG_DEBUG("new_page_id %d", new_page_id);
-  N *recipient_page = reinterpret_cast<N *>(page->GetData());
+  N *recipient_page = page.AsMut<N>();
   if (node->IsLeafPage()) {
     recipient_page->Init(new_page_id, INVALID_PAGE_ID, leaf_max_size_);
   } else {
@@ -158,7 +169,7 @@ N *BPLUSTREE_TYPE::Split(N *node) {
   }
   node->MoveHalfTo(recipient_page, buffer_pool_manager_);
   LOG_DEBUG("split success recipient_page %d, original_page %d", new_page_id, node->GetPageId());
-  return recipient_page;
+  return page;
 }
 
 /*
@@ -169,20 +180,19 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The caller keeps old_node and new_node pinned and marks them dirty.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                                       Transaction *transaction) {
-  // TODO: consider old_node is root node case
-
   if (old_node->IsRootPage()) {
     page_id_t new_root_page_id;
-    auto new_page = buffer_pool_manager_->NewPage(&new_root_page_id);
-    if (new_page == nullptr) {
-      throw std::invalid_argument("invalid page");
+    BasicPageGuard new_page = buffer_pool_manager_->NewPageGuarded(&new_root_page_id, nullptr, old_node->GetPageId());
+    if (!new_page.IsValid()) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a root page");
     }
 
-    InternalPage *new_root_page = reinterpret_cast<InternalPage *>(new_page->GetData());
+    InternalPage *new_root_page = new_page.AsMut<InternalPage>();
     new_root_page->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_);
     new_root_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
 
@@ -191,15 +201,16 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     
     root_page_id_ = new_root_page_id;
     UpdateRootPageId(false);
-
-    buffer_pool_manager_->UnpinPage(old_node->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
     return;
   }
 
+  // Lookups read internal pages optimistically; the write latch lets them notice the change.
   page_id_t parent_page_id = old_node->GetParentPageId();
-  InternalPage *parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  WritePageGuard parent = buffer_pool_manager_->FetchPageWrite(parent_page_id);
+  if (!parent.IsValid()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch the parent page");
+  }
+  InternalPage *parent_page = parent.AsMut<InternalPage>();
   // if no need split check
   LOG_DEBUG("parent_page: id %d, size %d, max_size %d", parent_page->GetPageId(), parent_page->GetSize(), parent_page->GetMaxSize());
   if (parent_page->GetSize() < parent_page->GetMaxSize()) {
@@ -207,26 +218,19 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     page_id_t old_node_page_id = old_node->GetPageId();
     parent_page->InsertNodeAfter(old_node_page_id, key, new_node->GetPageId());
     new_node->SetParentPageId(parent_page_id);
-
-    buffer_pool_manager_->UnpinPage(parent_page_id, true);
-    buffer_pool_manager_->UnpinPage(old_node_page_id, true);
-    buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
     return;
   } else {
     new_node->SetParentPageId(parent_page_id);
     parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
     LOG_DEBUG("[InsertToParent BeforeSplit] old_node %d, key %lld, new_node %d", old_node->GetPageId(), key.ToString(), new_node->GetPageId());
-    InternalPage *new_parent_page = Split(parent_page);
+    BasicPageGuard new_parent = Split(parent_page);
+    InternalPage *new_parent_page = new_parent.As<InternalPage>();
     LOG_DEBUG("[InsertToParent Split] old_node %d, key %lld, new_node %d", old_node->GetPageId(), key.ToString(), new_node->GetPageId());
-    buffer_pool_manager_->UnpinPage(old_node->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
 
     InsertIntoParent(reinterpret_cast<BPlusTreePage *>(parent_page),
                     new_parent_page->KeyAt(0),
                     reinterpret_cast<BPlusTreePage *>(new_parent_page),
                     transaction);
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(new_parent_page->GetPageId(), true);
   }
 }
 
@@ -245,47 +249,50 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   if (IsEmpty()) {
     return;
   }
-  Page *page = FindLeafPage(key);
-  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  BasicPageGuard page = FindLeafPage(key);
+  LeafPage *leaf_page = page.AsMut<LeafPage>();
   leaf_page->RemoveAndDeleteRecord(key, comparator_);
-  LOG_DEBUG("leaf page id %d, min_size %d, curr_size %d", page->GetPageId(), leaf_page->GetMinSize(), leaf_page->GetSize());
+  LOG_DEBUG("leaf page id %d, min_size %d, curr_size %d", page.PageId(), leaf_page->GetMinSize(), leaf_page->GetSize());
 
+  bool delete_leaf = false;
   if (leaf_page->GetSize() < leaf_page->GetMinSize()) {
     if (!leaf_page->IsRootPage()) {
-      CoalesceOrRedistribute(leaf_page, transaction);
+      delete_leaf = CoalesceOrRedistribute(leaf_page, transaction);
     } else if (leaf_page->GetSize() == 0) {
-      AdjustRoot(reinterpret_cast<BPlusTreePage *>(leaf_page));
+      delete_leaf = AdjustRoot(reinterpret_cast<BPlusTreePage *>(leaf_page));
     }
   }
-  LOG_DEBUG("leaf page id %d", page->GetPageId());
-
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  // A page can only be deleted once it is no longer pinned.
+  const page_id_t leaf_page_id = page.PageId();
+  page.Drop();
+  if (delete_leaf) {
+    buffer_pool_manager_->DeletePage(leaf_page_id);
+  }
+  LOG_DEBUG("leaf page id %d", leaf_page_id);
 }
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * The caller keeps node pinned, and write-latched if it is an internal page.
  * @return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * deletion happens. The caller deletes it once it has unpinned it.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  // GetParentPageId, fetch_this_page, find_sibling (left or right base on index), fetch sibling page, check size to coalesce or redistribute
-  // process if it is the root page
-
-  // no need coalesce or redistrubtion
-  /*if (node->GetSize() >= node->GetMinSize()) {
-    return false;
-  }*/
-
   if (node->IsRootPage()) {
     return AdjustRoot(node);
   }
+  // Lookups read internal pages optimistically; the write latches on the parent and the sibling let them notice the
+  // change.
   page_id_t parent_page_id = node->GetParentPageId();
-  Page *page = buffer_pool_manager_->FetchPage(parent_page_id);
-  InternalPage *parent_node = reinterpret_cast<InternalPage *>(page->GetData());
+  WritePageGuard parent = buffer_pool_manager_->FetchPageWrite(parent_page_id);
+  if (!parent.IsValid()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch the parent page");
+  }
+  InternalPage *parent_node = parent.AsMut<InternalPage>();
   int node_idx = parent_node->ValueIndex(node->GetPageId());
 
   int neighbor_idx;
@@ -296,28 +303,38 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
   }
 
   page_id_t sibling_page_id = parent_node->ValueAt(neighbor_idx);
-  page = buffer_pool_manager_->FetchPage(sibling_page_id);
-  N *sibling_node = reinterpret_cast<N *>(page->GetData());
+  WritePageGuard sibling = buffer_pool_manager_->FetchPageWrite(sibling_page_id);
+  if (!sibling.IsValid()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch the sibling page");
+  }
+  N *sibling_node = sibling.AsMut<N>();
   LOG_DEBUG("current_page_id %d, parent page id %d, sibling page id %d", node->GetPageId(), parent_page_id, sibling_page_id);
-  if (node->GetSize() + sibling_node->GetSize() <= node->GetMaxSize()) {
-    Coalesce(sibling_node, node, parent_node, node_idx, transaction);
-  } else {
-    Redistribute(sibling_node, node, node_idx);
+  if (node->GetSize() + sibling_node->GetSize() > node->GetMaxSize()) {
+    Redistribute(sibling_node, node, parent_node, node_idx);
+    return false;
   }
-  buffer_pool_manager_->UnpinPage(parent_page_id, false);
-  buffer_pool_manager_->UnpinPage(sibling_page_id, false);
-  return false;
+  if (Coalesce(sibling_node, node, parent_node, node_idx, transaction)) {
+    parent.Drop();
+    buffer_pool_manager_->DeletePage(parent_page_id);
+  }
+  // The right one of the two pages is emptied into the left one.
+  if (node_idx == 0) {
+    sibling.Drop();
+    buffer_pool_manager_->DeletePage(sibling_page_id);
+    return false;
+  }
+  return true;
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
+ * Move all the key & value pairs from one page to its sibling page. Parent
+ * page must be adjusted to take info of deletion into account. Remember to
+ * deal with coalesce or redistribute recursively if necessary. The emptied
+ * page is deleted by the caller, once it has unpinned it.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
+ * @param   parent             parent page of input "node", write-latched
  * @param   index              define left or right sibling node
  * @return  true means parent node should be deleted, false means no deletion
  * happend
@@ -330,26 +347,15 @@ bool BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node,
   if (index == 0) {
     KeyType middle_key = parent->KeyAt(index + 1);
     neighbor_node->MoveAllTo(node, middle_key, buffer_pool_manager_);
-    
-    buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
-    buffer_pool_manager_->DeletePage(neighbor_node->GetPageId());
-    
     parent->Remove(index + 1);
   } else {
     KeyType middle_key = parent->KeyAt(index);
     node->MoveAllTo(neighbor_node, middle_key, buffer_pool_manager_);
-
-    buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
-    buffer_pool_manager_->DeletePage(node->GetPageId());
-
     parent->Remove(index);
   }
   if (parent->GetSize() < parent->GetMinSize()) {
     return CoalesceOrRedistribute(parent, transaction);
   }
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
   return false;
 }
 
@@ -361,27 +367,21 @@ bool BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node,
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of input "node", write-latched
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
-  page_id_t parent_page_id = neighbor_node->GetParentPageId();
-  Page *page = buffer_pool_manager_->FetchPage(parent_page_id);
-  InternalPage *parent_node = reinterpret_cast<InternalPage *>(page->GetData());
-
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node,
+                                  BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent, int index) {
   if (index == 0) {
-    KeyType middle_key = parent_node->KeyAt(index + 1);
+    KeyType middle_key = parent->KeyAt(index + 1);
     neighbor_node->MoveFirstToEndOf(node, middle_key, buffer_pool_manager_);
-    parent_node->SetKeyAt(index + 1, neighbor_node->KeyAt(0));
+    parent->SetKeyAt(index + 1, neighbor_node->KeyAt(0));
   } else {
-    KeyType middle_key = parent_node->KeyAt(index);
+    KeyType middle_key = parent->KeyAt(index);
     neighbor_node->MoveLastToFrontOf(node, middle_key, buffer_pool_manager_);
-    parent_node->SetKeyAt(index, node->KeyAt(0));
+    parent->SetKeyAt(index, node->KeyAt(0));
   }
-
-  buffer_pool_manager_->UnpinPage(parent_page_id, true);
-  buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
 }
 
 /*
@@ -392,7 +392,7 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
  * @return : true means root page should be deleted, false means no deletion
- * happend
+ * happend. The caller deletes it once it has unpinned it.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
@@ -405,16 +405,11 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
   } else {
     InternalPage *internal_page = reinterpret_cast<InternalPage *>(old_root_node);
     root_page_id_ = internal_page->ValueAt(0);
-    Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
-    BPlusTreePage *b_plus_tree_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
-    b_plus_tree_page->SetParentPageId(INVALID_PAGE_ID);
-    buffer_pool_manager_->UnpinPage(b_plus_tree_page->GetPageId(), true);
+    BasicPageGuard page = buffer_pool_manager_->FetchPageBasic(root_page_id_);
+    page.AsMut<BPlusTreePage>()->SetParentPageId(INVALID_PAGE_ID);
   }
 
   LOG_DEBUG("delete root_page id %d", old_root_node->GetPageId());
-
-  buffer_pool_manager_->UnpinPage(old_root_node->GetPageId(), false);
-  buffer_pool_manager_->DeletePage(old_root_node->GetPageId());
   UpdateRootPageId(false);
   return true;
 }
@@ -429,9 +424,11 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
+  if (IsEmpty()) {
+    return end();
+  }
   KeyType key;
-  page_id_t left_most_page_id_ = FindLeafPage(key, true)->GetPageId();
-  buffer_pool_manager_->UnpinPage(left_most_page_id_, false);
+  page_id_t left_most_page_id_ = FindLeafPage(key, true).PageId();
   return INDEXITERATOR_TYPE(buffer_pool_manager_, left_most_page_id_, 0, false);
 }
 
@@ -443,11 +440,13 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
   LOG_DEBUG("begin iterator");
-  page_id_t leaf_page_id_ = FindLeafPage(key)->GetPageId();
+  if (IsEmpty()) {
+    return end();
+  }
+  BasicPageGuard page = FindLeafPage(key);
+  page_id_t leaf_page_id_ = page.PageId();
   LOG_DEBUG("start page_id iterator %d", leaf_page_id_);
-  LeafPage *leaf_page_ = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(leaf_page_id_)->GetData());
-  int idx = leaf_page_->KeyIndex(key, comparator_);
-  buffer_pool_manager_->UnpinPage(leaf_page_id_, false);
+  int idx = page.As<LeafPage>()->KeyIndex(key, comparator_);
   return INDEXITERATOR_TYPE(buffer_pool_manager_, leaf_page_id_, idx, false);
 }
 
@@ -467,30 +466,29 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() {
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * @return: a guard holding the pin on the leaf page, invalid if a page on the
+ * way could not be fetched. Pages passed on the way down are unpinned as soon
+ * as their child is pinned. Internal pages are read optimistically, without
+ * latching them, and re-read if a writer changed them meanwhile.
  */
 INDEX_TEMPLATE_ARGUMENTS
-Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
+BasicPageGuard BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
+  // A page read in the middle of a modification can claim any size; keep the lookup inside the page.
+  constexpr int max_internal_size =
+      static_cast<int>((PAGE_DATA_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>));
   // start from root_page
-  // TODO: consider memory leak issue
-  Page* curr_page = buffer_pool_manager_->FetchPage(root_page_id_);
-  BPlusTreePage *curr_bplus_page = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
-  while (!curr_bplus_page->IsLeafPage()) {
-    InternalPage *curr_internal_page = reinterpret_cast<InternalPage *>(curr_bplus_page);
-    page_id_t next_page;
-    if (leftMost) {
-      next_page = curr_internal_page->ValueAt(0);
-    } else {
-      next_page = curr_internal_page->Lookup(key, comparator_);
-    }
-    //LOG_DEBUG("curr_internal_page %d, next_page %d", curr_bplus_page->GetPageId(), next_page);
+  BasicPageGuard curr_page = buffer_pool_manager_->FetchPageBasic(root_page_id_);
+  while (curr_page.IsValid()) {
+    page_id_t next_page = curr_page.OptimisticRead<InternalPage>([&](const InternalPage *page) -> page_id_t {
+      if (page->IsLeafPage() || page->GetSize() <= 0 || page->GetSize() > max_internal_size) {
+        return INVALID_PAGE_ID;
+      }
+      return leftMost ? page->ValueAt(0) : page->Lookup(key, comparator_);
+    });
     if (next_page == INVALID_PAGE_ID) {
       break;
     }
-    buffer_pool_manager_->UnpinPage(curr_bplus_page->GetPageId(), false);
-    //LOG_DEBUG("curr_internal_page %d, next_page %d", curr_bplus_page->GetPageId(), next_page);
-    curr_page = buffer_pool_manager_->FetchPage(next_page);
-    curr_bplus_page = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
-    //LOG_DEBUG("new_curr_page %d, new_curr_blus_page %d, parent page_id %d", curr_page->GetPageId(), curr_bplus_page->GetPageId(), curr_bplus_page->GetParentPageId());
+    curr_page = buffer_pool_manager_->FetchPageBasic(next_page);
   }
   return curr_page;
 }
@@ -505,7 +503,8 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  BasicPageGuard page = buffer_pool_manager_->FetchPageBasic(HEADER_PAGE_ID);
+  HeaderPage *header_page = page.AsMut<HeaderPage>();
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -513,7 +512,6 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
 /*
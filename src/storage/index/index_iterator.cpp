@@ -16,7 +16,12 @@ INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, page_id_t leaf_page_id
                           curr_page_id_(leaf_page_id_),
                           curr_index_(idx),
                           buffer_pool_manager_(bpm),
-                          is_end_(is_end_) {};
+                          is_end_(is_end_),
+                          read_ahead_(bpm) {
+  if (!is_end_) {
+    read_ahead_.OnPage(curr_page_id_);
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;
@@ -32,10 +37,8 @@ const MappingType &INDEXITERATOR_TYPE::operator*() {
     throw std::runtime_error("invalid operator");
   }
 
-  auto page = buffer_pool_manager_->FetchPage(curr_page_id_);
-  B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
-  iter_val_ = leaf_page_->GetItem(curr_index_);
-  buffer_pool_manager_->UnpinPage(curr_page_id_, false);
+  BasicPageGuard page = buffer_pool_manager_->FetchPageBasic(curr_page_id_);
+  iter_val_ = page.As<B_PLUS_TREE_LEAF_PAGE_TYPE>()->GetItem(curr_index_);
   return iter_val_;
 }
 
@@ -44,9 +47,8 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   if (is_end_) {
     return *this;
   }
-  auto page = buffer_pool_manager_->FetchPage(curr_page_id_);
-  page_id_t unpin_page_id_ = curr_page_id_;
-  BPlusTreePage *bplus_page_ = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  BasicPageGuard page = buffer_pool_manager_->FetchPageBasic(curr_page_id_);
+  BPlusTreePage *bplus_page_ = page.As<BPlusTreePage>();
   if (!bplus_page_->IsLeafPage()) {
     throw std::runtime_error("not a bplus leaf page");
   }
@@ -57,9 +59,10 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
     curr_page_id_ = leaf_page_->GetNextPageId();
     if (curr_page_id_ == INVALID_PAGE_ID) {
       is_end_ = true;
+    } else {
+      read_ahead_.OnPage(curr_page_id_);
     }
   }
-  buffer_pool_manager_->UnpinPage(unpin_page_id_, false);
   return *this;
 }
 
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_free_space_map.cpp
+//
+// Identification: src/storage/table/table_free_space_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_free_space_map.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>  // NOLINT
+
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+TableFreeSpaceMap::TableFreeSpaceMap(BufferPoolManager *bpm) : bpm_(bpm) {
+  WritePageGuard first_page = bpm_->NewPageGuarded(&first_page_id_).UpgradeWrite();
+  BUSTUB_ASSERT(first_page.IsValid(), "Couldn't create a page for the free space map.");
+  first_page.AsMut<FreeSpaceMapPage>()->Init();
+  map_page_ids_.push_back(first_page_id_);
+  max_free_space_.push_back(0);
+}
+
+TableFreeSpaceMap::TableFreeSpaceMap(BufferPoolManager *bpm, page_id_t first_page_id)
+    : bpm_(bpm), first_page_id_(first_page_id) {
+  for (page_id_t map_page_id = first_page_id; map_page_id != INVALID_PAGE_ID;) {
+    ReadPageGuard guard = bpm_->FetchPageRead(map_page_id);
+    BUSTUB_ASSERT(guard.IsValid(), "Couldn't read a page of the free space map.");
+    auto *map_page = guard.As<FreeSpaceMapPage>();
+    uint32_t max_free_space = 0;
+    for (uint32_t slot = 0; slot < map_page->GetEntryCount(); ++slot) {
+      last_table_page_id_ = map_page->GetTablePageId(slot);
+      locations_[last_table_page_id_] = {map_page_ids_.size(), slot, map_page->GetFreeSpace(slot)};
+      max_free_space = std::max(max_free_space, map_page->GetFreeSpace(slot));
+    }
+    map_page_ids_.push_back(map_page_id);
+    max_free_space_.push_back(max_free_space);
+    map_page_id = map_page->GetNextPageId();
+  }
+}
+
+page_id_t TableFreeSpaceMap::GetLastTablePageId() {
+  std::scoped_lock guard(latch_);
+  return last_table_page_id_;
+}
+
+bool TableFreeSpaceMap::AddTablePage(page_id_t page_id, uint32_t free_space) {
+  free_space = ToBucket(free_space);
+  while (true) {
+    page_id_t last_map_page_id;
+    {
+      std::scoped_lock guard(latch_);
+      if (locations_.count(page_id) > 0) {
+        last_table_page_id_ = page_id;
+        return true;
+      }
+      last_map_page_id = map_page_ids_.back();
+    }
+    WritePageGuard map_page = bpm_->FetchPageWrite(last_map_page_id);
+    if (!map_page.IsValid()) {
+      return false;
+    }
+    if (map_page.As<FreeSpaceMapPage>()->GetNextPageId() != INVALID_PAGE_ID) {
+      // Another page was added in the meantime, and filled this map page.
+      continue;
+    }
+    {
+      std::scoped_lock guard(latch_);
+      if (locations_.count(page_id) > 0) {
+        last_table_page_id_ = page_id;
+        return true;
+      }
+    }
+    // Holding the last map page keeps other callers from adding pages until the entry is in memory as well.
+    int32_t slot = map_page.AsMut<FreeSpaceMapPage>()->AddTablePage(page_id, free_space);
+    WritePageGuard new_map_page;
+    page_id_t new_page_id = INVALID_PAGE_ID;
+    if (slot < 0) {
+      // The last map page is full; start a new one. Map pages are few and far between, so it is allocated on its own
+      // rather than in an extent.
+      new_map_page = bpm_->NewPageGuarded(&new_page_id).UpgradeWrite();
+      if (!new_map_page.IsValid()) {
+        return false;
+      }
+      new_map_page.AsMut<FreeSpaceMapPage>()->Init();
+      map_page.AsMut<FreeSpaceMapPage>()->SetNextPageId(new_page_id);
+      slot = new_map_page.AsMut<FreeSpaceMapPage>()->AddTablePage(page_id, free_space);
+    }
+    std::scoped_lock guard(latch_);
+    if (new_page_id != INVALID_PAGE_ID) {
+      map_page_ids_.push_back(new_page_id);
+      max_free_space_.push_back(0);
+    }
+    locations_[page_id] = {map_page_ids_.size() - 1, static_cast<uint32_t>(slot), free_space};
+    max_free_space_.back() = std::max(max_free_space_.back(), free_space);
+    last_table_page_id_ = page_id;
+    return true;
+  }
+}
+
+void TableFreeSpaceMap::UpdateTablePage(page_id_t page_id, uint32_t free_space) {
+  free_space = ToBucket(free_space);
+  Location location;
+  page_id_t map_page_id;
+  {
+    std::scoped_lock guard(latch_);
+    auto it = locations_.find(page_id);
+    if (it == locations_.end() || it->second.free_space_ == free_space) {
+      return;
+    }
+    location = it->second;
+    map_page_id = map_page_ids_[location.map_page_];
+  }
+  WritePageGuard map_page = bpm_->FetchPageWrite(map_page_id);
+  if (!map_page.IsValid()) {
+    return;
+  }
+  map_page.AsMut<FreeSpaceMapPage>()->SetFreeSpace(location.slot_, free_space);
+  std::scoped_lock guard(latch_);
+  locations_[page_id].free_space_ = free_space;
+  max_free_space_[location.map_page_] = std::max(max_free_space_[location.map_page_], free_space);
+}
+
+page_id_t TableFreeSpaceMap::FindTablePage(uint32_t space_needed) {
+  // Each thread starts looking at its own slot of a map page, so that concurrent inserters spread out over the pages
+  // with room. Earlier map pages are still searched first, to fill the table from its start.
+  static thread_local const size_t start_slot = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  std::vector<std::pair<size_t, page_id_t>> candidates;
+  {
+    std::scoped_lock guard(latch_);
+    for (size_t i = 0; i < map_page_ids_.size(); ++i) {
+      if (max_free_space_[i] >= space_needed) {
+        candidates.emplace_back(i, map_page_ids_[i]);
+      }
+    }
+  }
+  for (const auto &[index, map_page_id] : candidates) {
+    ReadPageGuard map_page = bpm_->FetchPageRead(map_page_id);
+    if (!map_page.IsValid()) {
+      return INVALID_PAGE_ID;
+    }
+    auto *map = map_page.As<FreeSpaceMapPage>();
+    const uint32_t entry_count = map->GetEntryCount();
+    uint32_t max_free_space = 0;
+    for (uint32_t j = 0; j < entry_count; ++j) {
+      uint32_t slot = (start_slot + j) % entry_count;
+      if (map->GetFreeSpace(slot) >= space_needed) {
+        return map->GetTablePageId(slot);
+      }
+      max_free_space = std::max(max_free_space, map->GetFreeSpace(slot));
+    }
+    // Nothing fits here after all; tighten the bound so that the page is skipped next time. The read latch keeps the
+    // entries from growing in the meantime.
+    std::scoped_lock guard(latch_);
+    max_free_space_[index] = max_free_space;
+  }
+  return INVALID_PAGE_ID;
+}
+
+}  // namespace bustub
@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <utility>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -18,73 +22,130 @@
 namespace bustub {
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id, page_id_t free_space_map_page_id)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      free_space_map_page_id_(free_space_map_page_id) {}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
-  BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
-  first_page->WLatch();
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
-  first_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  WritePageGuard first_page = buffer_pool_manager_->NewPageGuarded(&first_page_id_).UpgradeWrite();
+  BUSTUB_ASSERT(first_page.IsValid(), "Couldn't create a page for the table heap.");
+  first_page.AsMut<TablePage>()->Init(first_page_id_, PAGE_DATA_SIZE, INVALID_LSN, log_manager_, txn);
+  uint32_t free_space = first_page.As<TablePage>()->GetFreeSpaceRemaining();
+  first_page.Drop();
+  free_space_map_ = std::make_unique<TableFreeSpaceMap>(buffer_pool_manager_);
+  [[maybe_unused]] bool tracked = free_space_map_->AddTablePage(first_page_id_, free_space);
+  BUSTUB_ASSERT(tracked, "Couldn't add the first page of the table heap to its free space map.");
 }
 
-bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+TableFreeSpaceMap *TableHeap::GetFreeSpaceMap() {
+  std::call_once(free_space_map_loaded_, [this] {
+    if (free_space_map_ != nullptr) {
+      return;
+    }
+    if (free_space_map_page_id_ != INVALID_PAGE_ID) {
+      free_space_map_ = std::make_unique<TableFreeSpaceMap>(buffer_pool_manager_, free_space_map_page_id_);
+      return;
+    }
+    // Rebuild the map from the pages themselves.
+    free_space_map_ = std::make_unique<TableFreeSpaceMap>(buffer_pool_manager_);
+    for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+      ReadPageGuard page = buffer_pool_manager_->FetchPageRead(page_id);
+      BUSTUB_ASSERT(page.IsValid(), "Couldn't read a page of the table heap.");
+      [[maybe_unused]] bool tracked =
+          free_space_map_->AddTablePage(page_id, page.As<TablePage>()->GetFreeSpaceRemaining());
+      BUSTUB_ASSERT(tracked, "Couldn't add a page of the table heap to its free space map.");
+      page_id = page.As<TablePage>()->GetNextPageId();
+    }
+  });
+  return free_space_map_.get();
+}
+
+bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy) {
+  if (tuple.size_ + 32 > PAGE_DATA_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  // Insert into a page the free space map says has room. A page that turns out to be too full corrects its entry,
+  // so this ends once the map has no such page left.
+  TableFreeSpaceMap *free_space_map = GetFreeSpaceMap();
+  const uint32_t space_needed = TablePage::GetSpaceNeeded(tuple.GetLength());
+  for (page_id_t page_id = free_space_map->FindTablePage(space_needed); page_id != INVALID_PAGE_ID;
+       page_id = free_space_map->FindTablePage(space_needed)) {
+    WritePageGuard cur_page = buffer_pool_manager_->FetchPageWrite(page_id, strategy);
+    if (!cur_page.IsValid()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    bool inserted = cur_page.As<TablePage>()->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    uint32_t free_space = cur_page.As<TablePage>()->GetFreeSpaceRemaining();
+    if (inserted) {
+      cur_page.SetDirty();
+    }
+    // The map is updated once the page is released, so that other inserters never wait for its latch on the map.
+    cur_page.Drop();
+    free_space_map->UpdateTablePage(page_id, free_space);
+    if (inserted) {
+      // Update the transaction's write set.
+      txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+  }
+
+  // No page has room, so we create a new page at the end of the table and insert into that. Inserters that get here
+  // together each add a page, and then go on to fill different pages instead of queueing for the last one.
+  std::scoped_lock append(append_latch_);
+  WritePageGuard last_page = buffer_pool_manager_->FetchPageWrite(free_space_map->GetLastTablePageId(), strategy);
+  if (!last_page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-
-  cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+  // The map is not logged, so after a crash it can end before the table does. Walk to the real end, tracking the pages
+  // the map missed, rather than linking the new page over them.
+  for (page_id_t page_id = last_page.As<TablePage>()->GetNextPageId(); page_id != INVALID_PAGE_ID;
+       page_id = last_page.As<TablePage>()->GetNextPageId()) {
+    last_page = buffer_pool_manager_->FetchPageWrite(page_id, strategy);
+    if (!last_page.IsValid() ||
+        !free_space_map->AddTablePage(page_id, last_page.As<TablePage>()->GetFreeSpaceRemaining())) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
     }
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  page_id_t next_page_id;
+  BasicPageGuard new_page = buffer_pool_manager_->NewPageGuarded(&next_page_id, strategy, last_page.PageId());
+  // If we could not create a new page,
+  if (!new_page.IsValid()) {
+    // Then life sucks and we abort the transaction.
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  // The map tracks the page before it is linked, so that no page of the table goes untracked. With no free space
+  // recorded yet, no other inserter is sent to it.
+  if (!free_space_map->AddTablePage(next_page_id, 0)) {
+    new_page.Drop();
+    buffer_pool_manager_->DeletePage(next_page_id);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  // Otherwise we were able to create a new page. We initialize it now.
+  WritePageGuard cur_page = new_page.UpgradeWrite();
+  last_page.AsMut<TablePage>()->SetNextPageId(next_page_id);
+  cur_page.AsMut<TablePage>()->Init(next_page_id, PAGE_DATA_SIZE, last_page.PageId(), log_manager_, txn);
+  last_page.Drop();
+  if (!cur_page.As<TablePage>()->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  uint32_t free_space = cur_page.As<TablePage>()->GetFreeSpaceRemaining();
+  cur_page.SetDirty();
+  cur_page.Drop();
+  free_space_map->UpdateTablePage(next_page_id, free_space);
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
@@ -93,17 +154,15 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  WritePageGuard page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Otherwise, mark the tuple as deleted.
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  page.AsMut<TablePage>()->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  page.Drop();
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
@@ -111,18 +170,19 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  WritePageGuard page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
-  page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  bool is_updated = page.As<TablePage>()->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    page.SetDirty();
+  }
+  page.Drop();
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -132,61 +192,97 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  WritePageGuard page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(page.IsValid(), "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
-  page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  page.AsMut<TablePage>()->ApplyDelete(rid, txn, log_manager_);
+  uint32_t free_space = page.As<TablePage>()->GetFreeSpaceRemaining();
+  page.Drop();
+  // The page has room again. Loading the map may read every page, so the latch is released first.
+  GetFreeSpaceMap()->UpdateTablePage(rid.GetPageId(), free_space);
   lock_manager_->Unlock(txn, rid);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  WritePageGuard page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(page.IsValid(), "Couldn't find a page containing that RID.");
   // Rollback the delete.
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  page.AsMut<TablePage>()->RollbackDelete(rid, txn, log_manager_);
 }
 
 bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  ReadPageGuard page = buffer_pool_manager_->FetchPageRead(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Read the tuple from the page.
-  page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-  return res;
+  return page.As<TablePage>()->GetTuple(rid, tuple, txn, lock_manager_);
+}
+
+std::vector<bool> TableHeap::GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn) {
+  tuples->resize(rids.size());
+  std::vector<bool> found(rids.size(), false);
+  // Visit the tuples page by page, in slot order within a page.
+  std::vector<size_t> order(rids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return std::make_pair(rids[a].GetPageId(), rids[a].GetSlotNum()) <
+           std::make_pair(rids[b].GetPageId(), rids[b].GetSlotNum());
+  });
+  std::vector<page_id_t> page_ids;
+  for (size_t index : order) {
+    if (page_ids.empty() || page_ids.back() != rids[index].GetPageId()) {
+      page_ids.push_back(rids[index].GetPageId());
+    }
+  }
+
+  // Fetch the pages in chunks that leave room for other pins even if they all fall in one instance of the buffer pool,
+  // so a batch may span more pages than the pool has frames.
+  const size_t chunk_size = std::max<size_t>(buffer_pool_manager_->GetInstancePoolSize() / 2, 1);
+  auto next = order.begin();
+  for (size_t begin = 0; begin < page_ids.size(); begin += chunk_size) {
+    std::vector<page_id_t> chunk(page_ids.begin() + begin,
+                                 page_ids.begin() + std::min(begin + chunk_size, page_ids.size()));
+    // Guard every pin first, so that the pages after a failed one are unpinned too.
+    std::vector<BasicPageGuard> pages;
+    pages.reserve(chunk.size());
+    for (Page *page : buffer_pool_manager_->FetchPages(chunk)) {
+      pages.emplace_back(buffer_pool_manager_, page);
+    }
+    for (auto &basic : pages) {
+      // If the page could not be found, then abort the transaction.
+      if (!basic.IsValid()) {
+        txn->SetState(TransactionState::ABORTED);
+        return found;
+      }
+      ReadPageGuard page = basic.UpgradeRead();
+      page_id_t page_id = page.PageId();
+      for (; next != order.end() && rids[*next].GetPageId() == page_id; ++next) {
+        found[*next] = page.As<TablePage>()->GetTuple(rids[*next], &(*tuples)[*next], txn, lock_manager_);
+      }
+    }
+  }
+  return found;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    page->RLatch();
+    ReadPageGuard page = buffer_pool_manager_->FetchPageRead(page_id, strategy);
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_id, false);
-    if (found_tuple) {
+    if (page.As<TablePage>()->GetFirstTupleRid(&rid)) {
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = page.As<TablePage>()->GetNextPageId();
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, strategy);
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
@@ -16,11 +16,16 @@
 
 namespace bustub {
 
-TableIterator::TableIterator() : table_heap_(nullptr), tuple_(new Tuple()), txn_(nullptr){}
+TableIterator::TableIterator() : table_heap_(nullptr), tuple_(new Tuple()), txn_(nullptr), strategy_(nullptr) {}
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap),
+      tuple_(new Tuple(rid)),
+      txn_(txn),
+      strategy_(strategy),
+      read_ahead_(table_heap->buffer_pool_manager_, strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
+    read_ahead_.OnPage(rid.GetPageId());
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
 }
@@ -37,32 +42,30 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
+  ReadPageGuard cur_page = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(), strategy_);
+  assert(cur_page.IsValid());  // all pages are pinned
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+  if (!cur_page.As<TablePage>()->GetNextTupleRid(tuple_->rid_,
+                                                 &next_tuple_rid)) {  // end of this page
+    while (cur_page.As<TablePage>()->GetNextPageId() != INVALID_PAGE_ID) {
+      page_id_t next_page_id = cur_page.As<TablePage>()->GetNextPageId();
+      read_ahead_.OnPage(next_page_id);
+      // Pin the next page before letting go of the current one, but only latch it afterwards.
+      BasicPageGuard next_page = buffer_pool_manager->FetchPageBasic(next_page_id, strategy_);
+      cur_page.Drop();
+      cur_page = next_page.UpgradeRead();
+      if (cur_page.As<TablePage>()->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
     }
   }
   tuple_->rid_ = next_tuple_rid;
 
+  // cur_page is only released once the tuple has been copied.
   if (*this != table_heap_->End()) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
   return *this;
 }
 
@@ -0,0 +1,179 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/trace_replay_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(3);
+
+  // Scenario: load pages 10, 11 and 12 into frames 0, 1 and 2. All of them are in T1.
+  for (frame_id_t frame_id = 0; frame_id < 3; ++frame_id) {
+    arc_replacer.RecordLoad(frame_id, 10 + frame_id);
+    arc_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(3, arc_replacer.Size());
+
+  // Scenario: a second access moves frame 1 to T2.
+  arc_replacer.Pin(1);
+  arc_replacer.RecordAccess(1);
+  arc_replacer.Unpin(1);
+
+  // Scenario: T1 is above its target of 0, so its least recently used frame goes, and page 10 becomes a B1 ghost.
+  int value;
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  arc_replacer.RecordEviction(0, 10);
+  EXPECT_EQ(2, arc_replacer.Size());
+
+  // Scenario: page 10 comes back. The B1 ghost hit grows the T1 target, and the page goes straight to T2.
+  arc_replacer.RecordLoad(0, 10);
+  arc_replacer.Unpin(0);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+
+  // Scenario: T1 is at its target now, so T2 is evicted from; page 11 becomes a B2 ghost.
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  arc_replacer.RecordEviction(1, 11);
+
+  // Scenario: with every T2 frame pinned the victim comes from T1.
+  arc_replacer.Pin(0);
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  arc_replacer.RecordEviction(2, 12);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+
+  // Scenario: a B2 ghost hit shrinks the T1 target again.
+  arc_replacer.RecordLoad(1, 11);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+  arc_replacer.Unpin(1);
+  EXPECT_EQ(1, arc_replacer.Size());
+}
+
+TEST(ARCReplacerTest, BufferPoolTest) {
+  // Scenario: pages cycled through an ARC-backed pool twice its size are written back and read in again intact.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::ARC);
+
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  char expected[PAGE_SIZE];
+  for (page_id_t id : page_ids) {
+    Page *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Replays a recorded page access log against every replacement policy and reports the hit ratio of each.
+ * Set BUSTUB_REPLACER_TRACE to a file of page ids (one per line) to replay a captured workload; otherwise a
+ * synthetic log mixing Zipfian point lookups with large one-off scans is recorded and replayed.
+ */
+TEST(ARCReplacerTest, ScanResistanceTest) {
+  // Scenario: a skewed workload interrupted by scans of pages that are never used again. ARC keeps the hot pages
+  // that LRU lets the scans push out.
+  const size_t num_frames = 100;
+  std::vector<page_id_t> lookups = MakeZipfianTrace(1000, 20000, 0.9);
+  std::vector<page_id_t> trace;
+  page_id_t next_scan_page = 1000;
+  for (size_t i = 0; i < lookups.size(); ++i) {
+    trace.push_back(lookups[i]);
+    if (i % 2000 == 1999) {
+      for (int j = 0; j < 200; ++j) {
+        trace.push_back(next_scan_page++);
+      }
+    }
+  }
+
+  LRUReplacer lru_replacer(num_frames);
+  ARCReplacer arc_replacer(num_frames);
+  TraceReplayResult lru = ReplayTrace(&lru_replacer, num_frames, trace);
+  TraceReplayResult arc = ReplayTrace(&arc_replacer, num_frames, trace);
+  EXPECT_GT(arc.HitRatio(), lru.HitRatio());
+}
+
+TEST(ARCReplacerTest, DISABLED_TraceReplayBenchmark) {
+  const size_t num_frames = 500;
+  std::string trace_file = "replacer_trace.log";
+  const char *env_trace = std::getenv("BUSTUB_REPLACER_TRACE");
+  bool synthetic = env_trace == nullptr;
+  if (synthetic) {
+    std::vector<page_id_t> lookups = MakeZipfianTrace(5000, 200000, 0.9);
+    std::vector<page_id_t> trace;
+    page_id_t next_scan_page = 5000;
+    for (size_t i = 0; i < lookups.size(); ++i) {
+      trace.push_back(lookups[i]);
+      if (i % 20000 == 19999) {
+        for (int j = 0; j < 2000; ++j) {
+          trace.push_back(next_scan_page++);
+        }
+      }
+    }
+    SaveTrace(trace_file, trace);
+  } else {
+    trace_file = env_trace;
+  }
+  std::vector<page_id_t> trace = LoadTrace(trace_file);
+  if (synthetic) {
+    remove(trace_file.c_str());
+  }
+
+  LRUReplacer lru_replacer(num_frames);
+  ClockReplacer clock_replacer(num_frames);
+  LRUKReplacer lru_k_replacer(num_frames);
+  ARCReplacer arc_replacer(num_frames);
+  TraceReplayResult lru = ReplayTrace(&lru_replacer, num_frames, trace);
+  TraceReplayResult clock = ReplayTrace(&clock_replacer, num_frames, trace);
+  TraceReplayResult lru_k = ReplayTrace(&lru_k_replacer, num_frames, trace);
+  TraceReplayResult arc = ReplayTrace(&arc_replacer, num_frames, trace);
+  printf("%zu accesses, %zu frames\n", trace.size(), num_frames);
+  printf("%8s  hit ratio %.4f\n", "lru", lru.HitRatio());
+  printf("%8s  hit ratio %.4f\n", "clock", clock.HitRatio());
+  printf("%8s  hit ratio %.4f\n", "lru-k", lru_k.HitRatio());
+  printf("%8s  hit ratio %.4f\n", "arc", arc.HitRatio());
+  if (synthetic) {
+    EXPECT_GT(arc.HitRatio(), lru.HitRatio());
+  }
+}
+
+}  // namespace bustub
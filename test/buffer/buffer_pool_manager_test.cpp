@@ -10,10 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 #include "gtest/gtest.h"
 #include "common/logger.h"
 
@@ -30,7 +35,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -48,6 +53,8 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   // Insert terminal characters both in the middle and at end
   random_binary_data[PAGE_SIZE / 2] = '\0';
   random_binary_data[PAGE_SIZE - 1] = '\0';
+  // The end of the page holds the checksum of the page on disk, which reads back as zeros.
+  std::memset(random_binary_data + PAGE_DATA_SIZE, 0, PAGE_CHECKSUM_SIZE);
 
   // Scenario: Once we have a page, we should be able to read and write content.
   std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
@@ -92,7 +99,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
   const size_t buffer_pool_size = 10;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -153,7 +160,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest3) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -171,6 +178,8 @@ TEST(BufferPoolManagerTest, BinaryDataTest3) {
   // Insert terminal characters both in the middle and at end
   random_binary_data[PAGE_SIZE / 2] = '\0';
   random_binary_data[PAGE_SIZE - 1] = '\0';
+  // The end of the page holds the checksum of the page on disk, which reads back as zeros.
+  std::memset(random_binary_data + PAGE_DATA_SIZE, 0, PAGE_CHECKSUM_SIZE);
 
   // Scenario: Once we have a page, we should be able to read and write content.
   std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
@@ -218,7 +227,7 @@ TEST(BufferPoolManagerTest, SampleTest2) {
   const size_t buffer_pool_size = 1;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -254,4 +263,58 @@ TEST(BufferPoolManagerTest, SampleTest2) {
   delete disk_manager;
 }
 
+/**
+ * Measures FetchPage / UnpinPage throughput on resident pages. Every thread cycles over pages of its own, so that each
+ * fetch takes the pin count of a frame from 0 to 1 and each unpin takes it back.
+ */
+TEST(BufferPoolManagerTest, DISABLED_HitThroughputBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t fetches_per_thread = 200000;
+
+  const std::vector<std::pair<const char *, ReplacerType>> policies = {
+      {"LRU", ReplacerType::LRU}, {"CLOCK", ReplacerType::CLOCK}, {"LRUK", ReplacerType::LRUK},
+      {"ARC", ReplacerType::ARC}};
+
+  printf("%8s %8s %16s\n", "policy", "threads", "M fetches/s");
+  for (const auto &[name, replacer_type] : policies) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+    std::vector<page_id_t> page_ids(buffer_pool_size);
+    for (auto &page_id : page_ids) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    for (size_t num_threads : {1, 4, 8}) {
+      const size_t pages_per_thread = buffer_pool_size / num_threads;
+      std::vector<std::thread> threads;
+      std::atomic<size_t> failed{0};
+      auto start = std::chrono::steady_clock::now();
+      for (size_t tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([&, tid] {
+          for (size_t i = 0; i < fetches_per_thread; ++i) {
+            page_id_t page_id = page_ids[tid * pages_per_thread + i % pages_per_thread];
+            if (bpm->FetchPage(page_id) == nullptr || !bpm->UnpinPage(page_id, false)) {
+              failed++;
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+      printf("%8s %8zu %16.2f\n", name, num_threads, num_threads * fetches_per_thread / elapsed.count());
+      EXPECT_EQ(0, failed);
+    }
+    EXPECT_EQ(0, bpm->GetStats().misses_);
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,254 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_resize_test.cpp
+//
+// Identification: test/buffer/buffer_pool_resize_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Fetches page_id and checks that it still holds the text WritePageId put there. */
+bool HoldsPageId(BufferPoolManager *bpm, page_id_t page_id) {
+  Page *page = bpm->FetchPage(page_id);
+  if (page == nullptr) {
+    return false;
+  }
+  bool holds = std::to_string(page_id) == page->GetData();
+  bpm->UnpinPage(page_id, false);
+  return holds;
+}
+
+void WritePageId(Page *page) { snprintf(page->GetData(), PAGE_SIZE, "%d", page->GetPageId()); }
+
+}  // namespace
+
+TEST(BufferPoolResizeTest, GrowTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: once every frame is pinned, growing the pool makes room for more pages, spread over new chunks.
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    WritePageId(page);
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  ASSERT_TRUE(bpm->ResizePool(3 * buffer_pool_size + 1));
+  EXPECT_EQ(3 * buffer_pool_size + 1, bpm->GetPoolSize());
+  EXPECT_EQ(3 * buffer_pool_size + 1, bpm->GetStats().free_list_length_ + buffer_pool_size);
+  for (size_t i = buffer_pool_size; i < 3 * buffer_pool_size + 1; ++i) {
+    Page *page = bpm->NewPage(&page_ids.emplace_back());
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, page->GetData()[0]);
+    WritePageId(page);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  // Scenario: pages in old and new frames are found again, and survive being written back and read in.
+  for (page_id_t id : page_ids) {
+    EXPECT_TRUE(HoldsPageId(bpm, id));
+    EXPECT_TRUE(bpm->UnpinPage(id, true));
+  }
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t id : page_ids) {
+    EXPECT_TRUE(HoldsPageId(bpm, id));
+  }
+
+  // Scenario: sizes the pool cannot have are rejected.
+  EXPECT_FALSE(bpm->ResizePool(0));
+  EXPECT_FALSE(bpm->ResizePool(bpm->GetMaxPoolSize() + 1));
+  EXPECT_EQ(3 * buffer_pool_size + 1, bpm->GetPoolSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolResizeTest, ShrinkTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t shrunk_size = 4;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Fill the pool with dirty pages and keep the two in the highest frames pinned.
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    WritePageId(page);
+  }
+  for (size_t i = 0; i < buffer_pool_size - 2; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+
+  // Scenario: shrinking releases the unpinned frames at once and leaves the pinned ones in use.
+  ASSERT_TRUE(bpm->ResizePool(shrunk_size));
+  EXPECT_EQ(shrunk_size, bpm->GetPoolSize());
+  EXPECT_EQ(shrunk_size + 2, bpm->GetFramesInUse());
+  EXPECT_EQ(0, bpm->GetStats().free_list_length_);
+
+  // Scenario: the pinned pages stay usable, and their frames are released as soon as they are unpinned.
+  EXPECT_TRUE(HoldsPageId(bpm, page_ids[buffer_pool_size - 2]));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[buffer_pool_size - 2], true));
+  EXPECT_EQ(shrunk_size + 1, bpm->GetFramesInUse());
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[buffer_pool_size - 1], true));
+  EXPECT_EQ(shrunk_size, bpm->GetFramesInUse());
+
+  // Scenario: only the remaining frames can be pinned, and every page was written back on the way out.
+  std::vector<Page *> pinned;
+  for (size_t i = 0; i < shrunk_size; ++i) {
+    pinned.push_back(bpm->FetchPage(page_ids[i]));
+    ASSERT_NE(nullptr, pinned.back());
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_ids.back()));
+  for (size_t i = 0; i < shrunk_size; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+  for (page_id_t id : page_ids) {
+    EXPECT_TRUE(HoldsPageId(bpm, id));
+  }
+
+  // Scenario: a frame that is still retiring when the pool grows again is simply back in use.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0]));
+  ASSERT_TRUE(bpm->ResizePool(1));
+  EXPECT_EQ(1, bpm->GetPoolSize());
+  ASSERT_TRUE(bpm->ResizePool(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, bpm->GetFramesInUse());
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[0], false));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  for (page_id_t id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+    EXPECT_TRUE(HoldsPageId(bpm, id));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolResizeTest, ParallelTest) {
+  // Scenario: a parallel buffer pool splits the new size across its instances.
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(3, 2, disk_manager);
+
+  ASSERT_TRUE(bpm->ResizePool(11));
+  EXPECT_EQ(11, bpm->GetPoolSize());
+  std::vector<page_id_t> page_ids(11);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  for (page_id_t id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+
+  EXPECT_FALSE(bpm->ResizePool(2));
+  EXPECT_EQ(11, bpm->GetPoolSize());
+  ASSERT_TRUE(bpm->ResizePool(3));
+  EXPECT_EQ(3, bpm->GetPoolSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolResizeTest, ConcurrentTest) {
+  // Scenario: threads keep fetching pages while the pool grows and shrinks underneath them.
+  const std::string db_name = "test.db";
+  const size_t num_pages = 64;
+  const size_t num_threads = 4;
+  for (ReplacerType replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRUK, ReplacerType::ARC}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(8, disk_manager, nullptr, replacer_type);
+    ASSERT_TRUE(bpm->ResizePool(num_pages));
+    std::vector<page_id_t> page_ids(num_pages);
+    for (auto &page_id : page_ids) {
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      WritePageId(page);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<size_t> corrupted{0};
+    std::vector<std::thread> threads;
+    for (size_t tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        std::mt19937 gen(tid);
+        while (!done) {
+          page_id_t page_id = page_ids[gen() % num_pages];
+          Page *page = bpm->FetchPage(page_id);
+          // With every frame pinned by the other threads, a small pool has no room.
+          if (page == nullptr) {
+            continue;
+          }
+          if (std::to_string(page_id) != page->GetData()) {
+            corrupted++;
+          }
+          bpm->UnpinPage(page_id, gen() % 4 == 0);
+        }
+      });
+    }
+    for (size_t round = 0; round < 200; ++round) {
+      ASSERT_TRUE(bpm->ResizePool(round % 2 == 0 ? num_threads + round % 7 : 2 * num_pages - round % 13));
+    }
+    done = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    EXPECT_EQ(0, corrupted);
+    ASSERT_TRUE(bpm->ResizePool(num_threads));
+    EXPECT_EQ(num_threads, bpm->GetFramesInUse());
+    for (page_id_t page_id : page_ids) {
+      EXPECT_TRUE(HoldsPageId(bpm, page_id));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,232 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats_test.cpp
+//
+// Identification: test/buffer/buffer_pool_stats_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(BufferPoolStatsTest, HistogramTest) {
+  EXPECT_EQ(0, LatencyHistogram::BucketOf(0));
+  EXPECT_EQ(1, LatencyHistogram::BucketOf(1));
+  EXPECT_EQ(2, LatencyHistogram::BucketOf(2));
+  EXPECT_EQ(2, LatencyHistogram::BucketOf(3));
+  EXPECT_EQ(10, LatencyHistogram::BucketOf(1000));
+  EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::BucketOf(UINT64_MAX));
+
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.PercentileNs(0.5));
+  for (uint64_t ns : {100, 100, 100, 100, 100, 100, 100, 100, 100, 5000}) {
+    histogram.buckets_[LatencyHistogram::BucketOf(ns)]++;
+    histogram.count_++;
+    histogram.total_ns_ += ns;
+  }
+  EXPECT_EQ(128, histogram.PercentileNs(0.5));
+  EXPECT_EQ(8192, histogram.PercentileNs(0.99));
+  EXPECT_DOUBLE_EQ(590, histogram.MeanNs());
+}
+
+TEST(BufferPoolStatsTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: a fresh pool has every frame on the free list and nothing counted.
+  BufferPoolStatsSnapshot stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.free_list_length_);
+  EXPECT_EQ(0, stats.hits_ + stats.misses_ + stats.evictions_ + stats.dirty_write_backs_ + stats.pin_waits_);
+
+  // Scenario: new pages, a hit, then enough new pages to evict every dirty page.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  // Fetching page 0 again misses, and evicts one of the new pages, which are dirty until written.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.free_list_length_);
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(buffer_pool_size + 1, stats.evictions_);
+  EXPECT_EQ(buffer_pool_size + 1, stats.dirty_write_backs_);
+  EXPECT_EQ(0, stats.pin_waits_);
+  EXPECT_EQ(2 * buffer_pool_size, stats.new_page_latency_.count_);
+  EXPECT_EQ(1, stats.fetch_miss_latency_.count_);
+  EXPECT_GT(stats.fetch_miss_latency_.total_ns_, 0);
+  // Hits are sampled, so at most the one hit was timed.
+  EXPECT_LE(stats.fetch_hit_latency_.count_, 1);
+
+  // Scenario: flushing a clean page is not a dirty write-back, flushing a dirty one is.
+  ASSERT_TRUE(bpm->FlushPage(0));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  ASSERT_TRUE(bpm->FlushPage(0));
+  EXPECT_EQ(buffer_pool_size + 2, bpm->GetStats().dirty_write_backs_);
+
+  // Scenario: the snapshot is dumped as JSON.
+  std::string json = bpm->GetStats().ToJson();
+  EXPECT_NE(std::string::npos, json.find(R"("hits":2,"misses":1,)"));
+  EXPECT_NE(std::string::npos, json.find(R"("free_list_length":0,)"));
+  EXPECT_NE(std::string::npos, json.find(R"("fetch_miss":{"count":1,)"));
+  EXPECT_EQ('{', json.front());
+  EXPECT_EQ('}', json.back());
+  EXPECT_EQ(std::count(json.begin(), json.end(), '{'), std::count(json.begin(), json.end(), '}'));
+  EXPECT_EQ(std::count(json.begin(), json.end(), '['), std::count(json.begin(), json.end(), ']'));
+
+  // Scenario: reset zeroes the counters, and nothing is counted while collection is off.
+  bpm->ResetStats();
+  bpm->EnableStats(false);
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.new_page_latency_.count_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolStatsTest, ParallelTest) {
+  // Scenario: a parallel buffer pool reports the sum of its instances, with concurrent threads counted exactly.
+  const std::string db_name = "test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 4;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+
+  std::vector<page_id_t> page_ids(num_instances * pool_size);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  const size_t num_threads = 8;
+  const size_t fetches_per_thread = 1000;
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      for (size_t i = 0; i < fetches_per_thread; ++i) {
+        page_id_t page_id = page_ids[(i + tid) % page_ids.size()];
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  BufferPoolStatsSnapshot stats = bpm->GetStats();
+  EXPECT_EQ(num_threads * fetches_per_thread, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(0, stats.evictions_);
+  EXPECT_EQ(0, stats.free_list_length_);
+  EXPECT_EQ(page_ids.size(), stats.new_page_latency_.count_);
+  EXPECT_GE(stats.fetch_hit_latency_.count_, num_threads * fetches_per_thread / STATS_HIT_SAMPLE_INTERVAL / 2);
+  EXPECT_LE(stats.fetch_hit_latency_.count_, stats.hits_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Measures the cost of collecting statistics on the FetchPage hit path: num_threads threads fetch and unpin resident
+ * pages with collection on and off.
+ */
+TEST(BufferPoolStatsTest, DISABLED_HitPathOverheadBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t fetches_per_thread = 100000;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  auto run = [&](size_t num_threads) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        for (size_t i = 0; i < fetches_per_thread; ++i) {
+          page_id_t page_id = page_ids[(i * 7 + tid * 13) % buffer_pool_size];
+          bpm->FetchPage(page_id);
+          bpm->UnpinPage(page_id, false);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(fetches_per_thread);
+  };
+
+  // Each round runs collection off and on back to back, in alternating order; the median of the per-round ratios
+  // filters out rounds in which the machine was busy with something else.
+  printf("%8s %16s %16s %10s\n", "threads", "off ns/fetch", "on ns/fetch", "overhead");
+  for (size_t num_threads : {1, 4, 8}) {
+    std::vector<double> off;
+    std::vector<double> on;
+    std::vector<double> ratios;
+    for (int round = 0; round < 15; ++round) {
+      for (bool enabled : {round % 2 == 0, round % 2 != 0}) {
+        bpm->EnableStats(enabled);
+        (enabled ? on : off).push_back(run(num_threads));
+      }
+      ratios.push_back(on.back() / off.back());
+    }
+    std::sort(off.begin(), off.end());
+    std::sort(on.begin(), on.end());
+    std::sort(ratios.begin(), ratios.end());
+    printf("%8zu %16.1f %16.1f %9.1f%%\n", num_threads, off[off.size() / 2], on[on.size() / 2],
+           100 * (ratios[ratios.size() / 2] - 1));
+  }
+  EXPECT_EQ(0, bpm->GetStats().misses_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
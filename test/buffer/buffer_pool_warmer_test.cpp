@@ -0,0 +1,259 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_warmer_test.cpp
+//
+// Identification: test/buffer/buffer_pool_warmer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_warmer.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Waits until the prefetch threads of bpm have read num_pages pages. */
+bool WaitForResidentPages(BufferPoolManager *bpm, size_t num_pages) {
+  for (int i = 0; i < 1000; ++i) {
+    if (bpm->GetResidentPageIds().size() >= num_pages) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(BufferPoolWarmerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const std::string dump_name = "test.warmup";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(8, disk_manager);
+
+  // Scenario: pages 8 to 15 stay resident. The pinned page is the hottest, then the unpinned pages follow from the
+  // most to the least recently used.
+  for (page_id_t expected = 0; expected < 16; ++expected) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(expected, page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id : {12, 9, 14}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    if (page_id != 14) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  EXPECT_EQ(std::vector<page_id_t>({14, 9, 12, 15, 13, 11, 10, 8}), bpm->GetResidentPageIds());
+
+  BufferPoolWarmer warmer(bpm, dump_name);
+  ASSERT_TRUE(warmer.Dump());
+  ASSERT_TRUE(bpm->UnpinPage(14, false));
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: after a restart into a smaller pool, the hottest pages that fit are read back in the background and
+  // fetching them is a hit.
+  bpm = new BufferPoolManagerInstance(4, disk_manager);
+  BufferPoolWarmer restarted(bpm, dump_name);
+  EXPECT_EQ(4, restarted.Restore());
+  ASSERT_TRUE(WaitForResidentPages(bpm, 4));
+  std::vector<page_id_t> resident = bpm->GetResidentPageIds();
+  std::sort(resident.begin(), resident.end());
+  EXPECT_EQ(std::vector<page_id_t>({9, 12, 14, 15}), resident);
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : resident) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_STREQ(expected, page->GetData());
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetStats().misses_);
+
+  // Scenario: the restored pages count as allocated, so a new page does not reuse their ids.
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(16, page_id);
+  ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: a warm-up is scheduled in full even behind a queue full of read-ahead hints.
+  bpm->PrefetchPages({0, 1, 2, 3, 4, 5, 6, 7});
+  EXPECT_EQ(4, bpm->WarmUp({0, 1, 2, 3}));
+
+  // Scenario: a dump that announces more page ids than it holds is rejected, however many it announces.
+  for (uint32_t count : {5U, 0xffffffffU}) {
+    FILE *file = fopen(dump_name.c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+    const uint32_t header[2] = {0x42505744, count};
+    const page_id_t page_ids[4] = {9, 12, 14, 15};
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(page_ids, sizeof(page_ids), 1, file);
+    fclose(file);
+    EXPECT_EQ(0, restarted.Restore());
+  }
+
+  // Scenario: without a dump there is nothing to restore.
+  remove(dump_name.c_str());
+  EXPECT_EQ(0, restarted.Restore());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolWarmerTest, ParallelTest) {
+  const std::string db_name = "test.db";
+  const std::string dump_name = "test.warmup";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, 4, disk_manager);
+
+  std::vector<page_id_t> page_ids(16);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Scenario: the background thread dumps periodically, and once more when it is stopped.
+  auto interval = buffer_pool_dump_interval;
+  buffer_pool_dump_interval = std::chrono::milliseconds(5);
+  {
+    BufferPoolWarmer warmer(bpm, dump_name);
+    warmer.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    warmer.Stop();
+  }
+  buffer_pool_dump_interval = interval;
+  std::vector<page_id_t> resident = bpm->GetResidentPageIds();
+  ASSERT_EQ(8, resident.size());
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: every instance reads back its own share of the pages.
+  bpm = new ParallelBufferPoolManager(2, 4, disk_manager);
+  BufferPoolWarmer warmer(bpm, dump_name);
+  EXPECT_EQ(8, warmer.Restore());
+  ASSERT_TRUE(WaitForResidentPages(bpm, 8));
+  std::vector<page_id_t> restored = bpm->GetResidentPageIds();
+  std::sort(resident.begin(), resident.end());
+  std::sort(restored.begin(), restored.end());
+  EXPECT_EQ(resident, restored);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove(dump_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolWarmerTest, DISABLED_TimeToSteadyStateBenchmark) {
+  const std::string db_name = "test.db";
+  const std::string dump_name = "test.warmup";
+  const size_t buffer_pool_size = 1024;
+  const size_t num_pages = 4 * buffer_pool_size;
+  const size_t window = 200;
+  const size_t max_fetches = 200000;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Nine in ten fetches go to a hot set of three quarters of a pool scattered over the file, the rest anywhere.
+  std::mt19937 gen(0);
+  std::vector<page_id_t> hot(num_pages);
+  std::iota(hot.begin(), hot.end(), 0);
+  std::shuffle(hot.begin(), hot.end(), gen);
+  hot.resize(3 * buffer_pool_size / 4);
+  auto next_page = [&] {
+    if (gen() % 10 != 0) {
+      return hot[gen() % hot.size()];
+    }
+    return static_cast<page_id_t>(gen() % num_pages);
+  };
+  // Runs windows of fetches until one reaches target_hit_rate; returns the hit rate of the last window.
+  auto run = [&](double target_hit_rate, size_t *fetches) {
+    double hit_rate = 0;
+    for (*fetches = 0; *fetches < max_fetches && hit_rate < target_hit_rate; *fetches += window) {
+      BufferPoolStatsSnapshot before = bpm->GetStats();
+      for (size_t i = 0; i < window; ++i) {
+        page_id_t page_id = next_page();
+        EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+        bpm->UnpinPage(page_id, false);
+      }
+      BufferPoolStatsSnapshot after = bpm->GetStats();
+      hit_rate = static_cast<double>(after.hits_ - before.hits_) / window;
+    }
+    return hit_rate;
+  };
+
+  size_t fetches;
+  run(1.0, &fetches);
+  bpm->ResetStats();
+  run(1.0, &fetches);
+  double steady_hit_rate = static_cast<double>(bpm->GetStats().hits_) / fetches;
+  ASSERT_TRUE(BufferPoolWarmer(bpm, dump_name).Dump());
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Restart three times: cold, warming up while queries run right away, and warming up before they start. Steady
+  // state is the first window within five percent of the hit rate before the restart; the time includes the warm-up.
+  // The pages come from the page cache here, so a miss is cheap and the queries race the prefetch thread; on a real
+  // disk every miss avoided saves a read.
+  printf("steady-state hit rate %.3f\n", steady_hit_rate);
+  printf("%8s %10s %10s\n", "warm-up", "fetches", "ms");
+  size_t cold_fetches = 0;
+  for (const char *mode : {"off", "while", "before"}) {
+    bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    auto start = std::chrono::steady_clock::now();
+    if (std::string(mode) != "off") {
+      EXPECT_EQ(buffer_pool_size, BufferPoolWarmer(bpm, dump_name).Restore());
+    }
+    if (std::string(mode) == "before") {
+      ASSERT_TRUE(WaitForResidentPages(bpm, buffer_pool_size));
+    }
+    run(0.95 * steady_hit_rate, &fetches);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%8s %10zu %10.1f\n", mode, fetches, elapsed.count());
+    if (std::string(mode) == "off") {
+      cold_fetches = fetches;
+    } else if (std::string(mode) == "before") {
+      // A warmed-up pool is in steady state from the first window on.
+      EXPECT_EQ(window, fetches);
+      EXPECT_LT(fetches, cold_fetches);
+    }
+    delete bpm;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove(dump_name.c_str());
+
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,268 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/page_codec.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Fills a page with rows of text, like a table page of VARCHAR columns. */
+void FillText(char *page, int seed) {
+  std::string text;
+  for (int row = 0; text.size() < PAGE_SIZE; ++row) {
+    text += "customer#" + std::to_string(seed * 1000 + row) + "|furiously regular deposits sleep quickly|";
+  }
+  memcpy(page, text.data(), PAGE_SIZE);
+}
+
+void ExpectRoundTrip(const char *page) {
+  char compressed[PAGE_SIZE];
+  char decompressed[PAGE_SIZE];
+  size_t size = PageCodec::Compress(page, compressed, sizeof(compressed));
+  ASSERT_GT(size, 0);
+  ASSERT_TRUE(PageCodec::Decompress(compressed, size, decompressed));
+  EXPECT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+}
+
+}  // namespace
+
+TEST(CompressedPageCacheTest, CodecTest) {
+  char page[PAGE_SIZE] = {};
+  char compressed[PAGE_SIZE];
+
+  // Scenario: an empty page shrinks to a few bytes.
+  ExpectRoundTrip(page);
+  EXPECT_LT(PageCodec::Compress(page, compressed, sizeof(compressed)), 64);
+
+  // Scenario: text compresses to well under half a page.
+  FillText(page, 1);
+  ExpectRoundTrip(page);
+  EXPECT_LT(PageCodec::Compress(page, compressed, sizeof(compressed)), PAGE_SIZE / 2);
+
+  // Scenario: a half-empty page, the way a table page fills up from both ends.
+  memset(page + PAGE_SIZE / 4, 0, PAGE_SIZE / 2);
+  ExpectRoundTrip(page);
+
+  // Scenario: random bytes do not fit in less than a page, which Compress reports.
+  std::mt19937 gen(0);
+  for (auto &byte : page) {
+    byte = static_cast<char>(gen());
+  }
+  EXPECT_EQ(0, PageCodec::Compress(page, compressed, PAGE_SIZE - 1));
+  std::vector<char> large(2 * PAGE_SIZE);
+  size_t size = PageCodec::Compress(page, large.data(), large.size());
+  ASSERT_GT(size, 0);
+  char decompressed[PAGE_SIZE];
+  ASSERT_TRUE(PageCodec::Decompress(large.data(), size, decompressed));
+  EXPECT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+
+  // Scenario: truncated input is rejected rather than read past its end.
+  FillText(page, 2);
+  size = PageCodec::Compress(page, compressed, sizeof(compressed));
+  EXPECT_FALSE(PageCodec::Decompress(compressed, size / 2, decompressed));
+}
+
+TEST(CompressedPageCacheTest, SampleTest) {
+  char page[PAGE_SIZE];
+  char out[PAGE_SIZE];
+  FillText(page, 0);
+  size_t compressed_size = PageCodec::Compress(page, out, sizeof(out));
+  // Room for three compressed pages.
+  CompressedPageCache cache(3 * compressed_size + compressed_size / 2);
+
+  // Scenario: a cached page comes back intact, and only once.
+  cache.Insert(1, page);
+  EXPECT_EQ(1, cache.GetNumPages());
+  EXPECT_EQ(compressed_size, cache.GetSizeBytes());
+  ASSERT_TRUE(cache.Take(1, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  EXPECT_FALSE(cache.Take(1, out));
+  EXPECT_EQ(0, cache.GetSizeBytes());
+
+  // Scenario: once full, the least recently inserted page is dropped.
+  for (page_id_t page_id = 1; page_id <= 4; ++page_id) {
+    cache.Insert(page_id, page);
+  }
+  EXPECT_EQ(3, cache.GetNumPages());
+  EXPECT_FALSE(cache.Take(1, out));
+  EXPECT_TRUE(cache.Take(4, out));
+
+  // Scenario: erased pages and pages dropped by a smaller capacity are gone.
+  cache.Erase(2);
+  EXPECT_FALSE(cache.Take(2, out));
+  cache.Insert(2, page);
+  cache.SetCapacity(compressed_size);
+  EXPECT_EQ(1, cache.GetNumPages());
+  EXPECT_FALSE(cache.Take(3, out));
+  EXPECT_TRUE(cache.Take(2, out));
+
+  // Scenario: a page that does not compress is kept as it is.
+  std::mt19937 gen(0);
+  for (auto &byte : page) {
+    byte = static_cast<char>(gen());
+  }
+  cache.SetCapacity(PAGE_SIZE);
+  cache.Insert(5, page);
+  EXPECT_EQ(PAGE_SIZE, cache.GetSizeBytes());
+  ASSERT_TRUE(cache.Take(5, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+}
+
+TEST(CompressedPageCacheTest, StageTest) {
+  char page[PAGE_SIZE];
+  char out[PAGE_SIZE];
+  FillText(page, 0);
+  size_t compressed_size = PageCodec::Compress(page, out, sizeof(out));
+  CompressedPageCache cache(4 * PAGE_SIZE);
+
+  // Scenario: a staged page is kept as it is until it is compressed, and can be taken either way.
+  cache.Stage(1, page);
+  EXPECT_EQ(PAGE_SIZE, cache.GetSizeBytes());
+  ASSERT_TRUE(cache.Take(1, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  cache.Stage(1, page);
+  cache.CompressStaged();
+  EXPECT_EQ(compressed_size, cache.GetSizeBytes());
+  ASSERT_TRUE(cache.Take(1, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+
+  // Scenario: a page taken, erased or staged again before it is compressed is not brought back or left stale.
+  cache.Stage(1, page);
+  cache.Stage(2, page);
+  cache.Stage(3, page);
+  ASSERT_TRUE(cache.Take(1, out));
+  cache.Erase(2);
+  FillText(page, 1);
+  cache.Stage(3, page);
+  cache.CompressStaged();
+  EXPECT_EQ(1, cache.GetNumPages());
+  EXPECT_FALSE(cache.Take(1, out));
+  EXPECT_FALSE(cache.Take(2, out));
+  ASSERT_TRUE(cache.Take(3, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  EXPECT_EQ(0, cache.GetSizeBytes());
+}
+
+TEST(CompressedPageCacheTest, BufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 4 * buffer_pool_size;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->SetCompressedTierCapacity(num_pages * PAGE_SIZE / 2);
+
+  // Scenario: text pages evicted from a small pool are kept compressed, and served from there when fetched again.
+  std::vector<page_id_t> page_ids(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    FillText(page->GetData(), page_ids[i]);
+    ASSERT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+  BufferPoolStatsSnapshot stats = bpm->GetStats();
+  EXPECT_EQ(num_pages - buffer_pool_size, stats.compressed_pages_);
+  EXPECT_LT(stats.compressed_bytes_, stats.compressed_pages_ * PAGE_SIZE / 2);
+
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    FillText(expected, page_id);
+    EXPECT_EQ(0, memcmp(expected, page->GetData(), PAGE_SIZE));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(num_pages, stats.misses_);
+  EXPECT_EQ(num_pages, stats.compressed_hits_);
+
+  // Scenario: a page modified after it came back from the tier is written back and cached again with its new
+  // contents, and a deleted page leaves the tier.
+  Page *page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "modified");
+  ASSERT_TRUE(bpm->UnpinPage(page_ids[0], true));
+  for (size_t i = 1; i <= buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    ASSERT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+  page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("modified", page->GetData());
+  ASSERT_TRUE(bpm->UnpinPage(page_ids[0], false));
+  // The last page was evicted again by the fetches since.
+  size_t cached = bpm->GetStats().compressed_pages_;
+  ASSERT_TRUE(bpm->DeletePage(page_ids[num_pages - 1]));
+  EXPECT_EQ(cached - 1, bpm->GetStats().compressed_pages_);
+
+  // Scenario: turning the tier off drops it; misses go to disk again.
+  bpm->SetCompressedTierCapacity(0);
+  EXPECT_EQ(0, bpm->GetStats().compressed_pages_);
+  bpm->ResetStats();
+  for (page_id_t page_id : page_ids) {
+    if (page_id != page_ids[num_pages - 1]) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  EXPECT_EQ(0, bpm->GetStats().compressed_hits_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(CompressedPageCacheTest, ParallelTest) {
+  // Scenario: a parallel buffer pool splits the capacity across its instances and reports their tiers together.
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(4, 4, disk_manager);
+  bpm->SetCompressedTierCapacity(64 * PAGE_SIZE);
+
+  std::vector<page_id_t> page_ids(64);
+  for (auto &page_id : page_ids) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    FillText(page->GetData(), page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(64 - 16, bpm->GetStats().compressed_pages_);
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    FillText(expected, page_id);
+    EXPECT_EQ(0, memcmp(expected, page->GetData(), PAGE_SIZE));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(64, bpm->GetStats().compressed_hits_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,224 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table_test.cpp
+//
+// Identification: test/buffer/concurrent_page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/concurrent_page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ConcurrentPageTableTest, SampleTest) {
+  ConcurrentPageTable page_table(8);
+  frame_id_t frame_id;
+
+  // Scenario: an empty table finds nothing.
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  EXPECT_EQ(0, page_table.Size());
+
+  // Scenario: insert a few pages and look them up.
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    page_table.Insert(page_id, 7 - page_id);
+  }
+  EXPECT_EQ(8, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    EXPECT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(7 - page_id, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(8, &frame_id));
+
+  // Scenario: inserting an existing page overwrites its frame.
+  page_table.Insert(3, 0);
+  EXPECT_TRUE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(0, frame_id);
+  EXPECT_EQ(8, page_table.Size());
+
+  // Scenario: removed pages are gone, the others are still reachable.
+  EXPECT_TRUE(page_table.Remove(3));
+  EXPECT_FALSE(page_table.Remove(3));
+  EXPECT_FALSE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(7, page_table.Size());
+  EXPECT_TRUE(page_table.Find(4, &frame_id));
+  EXPECT_EQ(3, frame_id);
+
+  // Scenario: ForEach visits exactly the live entries.
+  size_t visited = 0;
+  page_table.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+    EXPECT_NE(3, page_id);
+    EXPECT_EQ(7 - page_id, frame_id);
+    visited++;
+  });
+  EXPECT_EQ(7, visited);
+}
+
+TEST(ConcurrentPageTableTest, ChurnTest) {
+  // Scenario: a long stream of evictions, as in a buffer pool cycling through many pages, keeps creating
+  // tombstones. The table must rebuild itself and stay correct.
+  const size_t num_frames = 16;
+  ConcurrentPageTable page_table(num_frames);
+  frame_id_t frame_id;
+
+  for (page_id_t page_id = 0; page_id < 10000; ++page_id) {
+    if (page_id >= static_cast<page_id_t>(num_frames)) {
+      EXPECT_TRUE(page_table.Remove(page_id - num_frames));
+    }
+    page_table.Insert(page_id, page_id % num_frames);
+    EXPECT_EQ(std::min<size_t>(page_id + 1, num_frames), page_table.Size());
+  }
+  for (page_id_t page_id = 10000 - num_frames; page_id < 10000; ++page_id) {
+    EXPECT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(page_id % static_cast<page_id_t>(num_frames), frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(10000 - num_frames - 1, &frame_id));
+}
+
+TEST(ConcurrentPageTableTest, ConcurrentReadWriteTest) {
+  // Scenario: readers never see a mapping that was never inserted while a writer churns through pages.
+  // Page p is always mapped to frame p % num_frames, so any hit can be checked.
+  const size_t num_frames = 32;
+  const page_id_t num_pages = 20000;
+  ConcurrentPageTable page_table(num_frames);
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.emplace_back([&] {
+      frame_id_t frame_id;
+      while (!done) {
+        for (page_id_t page_id = 0; page_id < num_pages; page_id += 7) {
+          if (page_table.Find(page_id, &frame_id)) {
+            ASSERT_EQ(page_id % static_cast<page_id_t>(num_frames), frame_id);
+          }
+        }
+      }
+    });
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    if (page_id >= static_cast<page_id_t>(num_frames)) {
+      page_table.Remove(page_id - num_frames);
+    }
+    page_table.Insert(page_id, page_id % num_frames);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+/**
+ * Measures lookups/sec when num_threads threads hammer a table of resident pages, as the buffer pool does on hits.
+ * The baseline is the previous design: a std::unordered_map behind the instance latch.
+ */
+TEST(ConcurrentPageTableTest, DISABLED_ContentionBenchmark) {
+  const size_t num_frames = 1024;
+  const size_t lookups_per_thread = 50000;
+
+  ConcurrentPageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> latched_table;
+  std::mutex latch;
+  for (size_t i = 0; i < num_frames; ++i) {
+    page_table.Insert(static_cast<page_id_t>(i), static_cast<frame_id_t>(i));
+    latched_table[static_cast<page_id_t>(i)] = static_cast<frame_id_t>(i);
+  }
+
+  auto run = [&](size_t num_threads, auto &&lookup) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        size_t hits = 0;
+        for (size_t i = 0; i < lookups_per_thread; ++i) {
+          hits += lookup(static_cast<page_id_t>((i * 31 + tid) % num_frames)) ? 1 : 0;
+        }
+        EXPECT_EQ(lookups_per_thread, hits);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(num_threads * lookups_per_thread) / elapsed.count();
+  };
+
+  printf("%8s %20s %20s\n", "threads", "lock-free ops/s", "latched map ops/s");
+  for (size_t num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    double lock_free = run(num_threads, [&](page_id_t page_id) {
+      frame_id_t frame_id;
+      return page_table.Find(page_id, &frame_id);
+    });
+    double latched = run(num_threads, [&](page_id_t page_id) {
+      std::scoped_lock guard(latch);
+      return latched_table.find(page_id) != latched_table.end();
+    });
+    printf("%8zu %20.0f %20.0f\n", num_threads, lock_free, latched);
+  }
+}
+
+TEST(ConcurrentPageTableTest, BufferPoolHitTest) {
+  // Scenario: many threads fetch and unpin the same resident pages without ever missing, while every frame
+  // keeps a consistent pin count.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_ids[i]));
+    snprintf(bpm->FetchPage(page_ids[i])->GetData(), PAGE_SIZE, "page %d", page_ids[i]);
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 8; ++tid) {
+    threads.emplace_back([&, tid] {
+      char expected[PAGE_SIZE];
+      for (size_t i = 0; i < 2000; ++i) {
+        page_id_t page_id = page_ids[(i + tid) % buffer_pool_size];
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+  // Every frame is evictable again.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
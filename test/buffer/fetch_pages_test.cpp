@@ -0,0 +1,308 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// fetch_pages_test.cpp
+//
+// Identification: test/buffer/fetch_pages_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Creates num_pages pages whose contents name their page id. */
+std::vector<page_id_t> CreatePages(BufferPoolManager *bpm, size_t num_pages) {
+  std::vector<page_id_t> page_ids(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_ids[i]);
+    EXPECT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_ids[i]);
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+  return page_ids;
+}
+
+std::string Contents(page_id_t page_id) { return "page " + std::to_string(page_id); }
+
+}  // namespace
+
+TEST(FetchPagesTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Pages 8..15 are resident, pages 0..7 were evicted to disk.
+  std::vector<page_id_t> page_ids = CreatePages(bpm, 2 * buffer_pool_size);
+
+  // Scenario: a batch of resident and evicted pages, with repeats, comes back in order with the right contents.
+  bpm->ResetStats();
+  std::vector<page_id_t> batch = {12, 3, 12, 0, 9, 3, 3};
+  std::vector<Page *> pages = bpm->FetchPages(batch);
+  ASSERT_EQ(batch.size(), pages.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(batch[i], pages[i]->GetPageId());
+    EXPECT_EQ(Contents(batch[i]), pages[i]->GetData());
+  }
+  // Each page is looked up and read once, but pinned once per occurrence.
+  EXPECT_EQ(pages[0], pages[2]);
+  EXPECT_EQ(2, pages[0]->GetPinCount());
+  EXPECT_EQ(3, pages[1]->GetPinCount());
+  EXPECT_EQ(1, pages[3]->GetPinCount());
+  BufferPoolStatsSnapshot stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.hits_);
+  EXPECT_EQ(2, stats.misses_);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(batch[i], false));
+  }
+  for (Page *page : pages) {
+    EXPECT_EQ(0, page->GetPinCount());
+  }
+
+  // Scenario: a batch larger than the pool gets a frame for as many pages as fit, and nullptr for the rest.
+  pages = bpm->FetchPages(page_ids);
+  size_t fetched = 0;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (pages[i] != nullptr) {
+      EXPECT_EQ(Contents(page_ids[i]), pages[i]->GetData());
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+      fetched++;
+    }
+  }
+  EXPECT_EQ(buffer_pool_size, fetched);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(FetchPagesTest, ParallelTest) {
+  // Scenario: a parallel buffer pool splits the batch across its instances and returns the pages in batch order.
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(4, 4, disk_manager);
+
+  std::vector<page_id_t> page_ids = CreatePages(bpm, 32);
+  std::vector<page_id_t> batch = {31, 0, 5, 18, 5, 2, 27, 12};
+  std::vector<Page *> pages = bpm->FetchPages(batch);
+  ASSERT_EQ(batch.size(), pages.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(Contents(batch[i]), pages[i]->GetData());
+  }
+  for (page_id_t page_id : batch) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(FetchPagesTest, ConcurrentTest) {
+  // Scenario: batches and single fetches of overlapping pages race while the batches' reads are in flight without the
+  // latch. Every page is loaded into one frame only and comes back with its contents.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids = CreatePages(bpm, 4 * buffer_pool_size);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      std::default_random_engine rng(t);
+      std::uniform_int_distribution<size_t> pick(0, page_ids.size() - 1);
+      for (int round = 0; round < 200; ++round) {
+        // Each thread holds at most three pins, so the pool always has a frame for it.
+        std::vector<page_id_t> batch = {page_ids[pick(rng)], page_ids[pick(rng)]};
+        std::vector<Page *> pages = bpm->FetchPages(batch);
+        page_id_t single = page_ids[pick(rng)];
+        Page *page = bpm->FetchPage(single);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(Contents(single), page->GetData());
+        for (size_t i = 0; i < batch.size(); ++i) {
+          ASSERT_NE(nullptr, pages[i]);
+          EXPECT_EQ(Contents(batch[i]), pages[i]->GetData());
+          EXPECT_TRUE(bpm->UnpinPage(batch[i], false));
+        }
+        EXPECT_TRUE(bpm->UnpinPage(single, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_GE(0, bpm->GetPages()[i].GetPinCount());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(FetchPagesTest, GetTuplesTest) {
+  // Scenario: reading a shuffled batch of RIDs, as an index scan returns them, returns every tuple at its position in
+  // the batch.
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, txn);
+
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 200)});
+  const int num_tuples = 1000;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(150, 'x'))}, &schema);
+    ASSERT_TRUE(table->InsertTuple(tuple, &rids[i], txn));
+  }
+
+  std::vector<int> expected(num_tuples);
+  for (int i = 0; i < num_tuples; ++i) {
+    expected[i] = i;
+  }
+  std::shuffle(expected.begin(), expected.end(), std::default_random_engine(0));
+  expected.resize(40);
+  std::vector<RID> batch;
+  for (int i : expected) {
+    batch.push_back(rids[i]);
+  }
+  // A RID can be asked for twice.
+  batch.push_back(batch.front());
+  expected.push_back(expected.front());
+
+  std::vector<Tuple> tuples;
+  std::vector<bool> found = table->GetTuples(batch, &tuples, txn);
+  ASSERT_EQ(batch.size(), found.size());
+  ASSERT_EQ(batch.size(), tuples.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_TRUE(found[i]);
+    EXPECT_EQ(expected[i], tuples[i].GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(batch[i], tuples[i].GetRid());
+  }
+  // Every pin taken for the batch is gone again.
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    EXPECT_GE(0, bpm->GetPages()[i].GetPinCount());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete table;
+  delete txn;
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(FetchPagesTest, GetTuplesLargeBatchTest) {
+  // Scenario: a batch whose tuples lie on more pages than the buffer pool holds is read in chunks that fit.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, txn);
+
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 200)});
+  const int num_tuples = 1000;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(150, 'x'))}, &schema);
+    ASSERT_TRUE(table->InsertTuple(tuple, &rids[i], txn));
+  }
+  ASSERT_LT(buffer_pool_size, static_cast<size_t>(rids.back().GetPageId() - rids.front().GetPageId()));
+
+  std::vector<Tuple> tuples;
+  std::vector<bool> found = table->GetTuples(rids, &tuples, txn);
+  EXPECT_NE(TransactionState::ABORTED, txn->GetState());
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(found[i]);
+    EXPECT_EQ(i, tuples[i].GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    EXPECT_GE(0, bpm->GetPages()[i].GetPinCount());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete table;
+  delete txn;
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(FetchPagesTest, GetTuplesParallelTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t num_instances = 4;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  auto *txn = new Transaction(0);
+  std::vector<std::unique_ptr<TableHeap>> tables;
+  for (size_t i = 0; i < num_instances; ++i) {
+    tables.push_back(std::make_unique<TableHeap>(bpm, nullptr, nullptr, txn));
+  }
+
+  // Scenario: tables filled in turns take new pages from the instances in turns, so that the pages of each table
+  // crowd into fewer instances than it would have alone. A batch of one of them is read in chunks that fit into the
+  // frames of a single instance.
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 200)});
+  const int num_tuples = 1000;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; ++i) {
+    for (auto &table : tables) {
+      Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(150, 'x'))}, &schema);
+      ASSERT_TRUE(table->InsertTuple(tuple, &rids[i], txn));
+    }
+  }
+  std::vector<Tuple> tuples;
+  std::vector<bool> found = tables.back()->GetTuples(rids, &tuples, txn);
+  EXPECT_NE(TransactionState::ABORTED, txn->GetState());
+  for (int i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(found[i]);
+    EXPECT_EQ(i, tuples[i].GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  // Every page can be fetched and unpinned again, so none was left pinned.
+  for (const RID &rid : rids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(rid.GetPageId()));
+    EXPECT_TRUE(bpm->UnpinPage(rid.GetPageId(), false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  tables.clear();
+  delete txn;
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
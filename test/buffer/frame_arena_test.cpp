@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/frame_arena.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 16;
+  FrameArena arena(num_frames * PAGE_SIZE, false, -1);
+
+  // Scenario: the arena starts on a huge page boundary and commits parts of itself in place.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.Base()) % FrameArena::HUGE_PAGE_SIZE);
+  char *first = arena.Commit(0, 4 * PAGE_SIZE);
+  EXPECT_EQ(arena.Base(), first);
+  char *second = arena.Commit(4 * PAGE_SIZE, 12 * PAGE_SIZE);
+  EXPECT_EQ(arena.Base() + 4 * PAGE_SIZE, second);
+  EXPECT_EQ(0, arena.GetHugeTlbBytes());
+  EXPECT_EQ(-1, arena.GetNumaNode());
+
+  // Scenario: committed memory is zeroed and writable, and reads as zeroes again once discarded.
+  for (size_t i = 0; i < num_frames; ++i) {
+    EXPECT_EQ(0, arena.Base()[i * PAGE_SIZE]);
+    snprintf(arena.Base() + i * PAGE_SIZE, PAGE_SIZE, "frame %zu", i);
+  }
+  arena.Discard(arena.Base() + 3 * PAGE_SIZE, PAGE_SIZE);
+  EXPECT_EQ(0, arena.Base()[3 * PAGE_SIZE]);
+  EXPECT_EQ(0, strcmp(arena.Base() + 4 * PAGE_SIZE, "frame 4"));
+}
+
+TEST(FrameArenaTest, HugePageTest) {
+  // Scenario: a huge page arena works whether or not the machine has huge pages reserved.
+  FrameArena arena(2 * FrameArena::HUGE_PAGE_SIZE, true, -1);
+  char *data = arena.Commit(0, FrameArena::HUGE_PAGE_SIZE);
+  memset(data, 'x', FrameArena::HUGE_PAGE_SIZE);
+  EXPECT_EQ('x', data[FrameArena::HUGE_PAGE_SIZE - 1]);
+  EXPECT_TRUE(arena.GetHugeTlbBytes() == 0 || arena.GetHugeTlbBytes() == FrameArena::HUGE_PAGE_SIZE);
+  printf("huge page pool backs %zu of %zu bytes\n", arena.GetHugeTlbBytes(), FrameArena::HUGE_PAGE_SIZE);
+
+  // Scenario: memory bound to a NUMA node is usable, or the arena falls back to the default placement.
+  EXPECT_GE(FrameArena::NumNumaNodes(), 1);
+  FrameArena bound(FrameArena::HUGE_PAGE_SIZE, false, 0);
+  data = bound.Commit(0, FrameArena::HUGE_PAGE_SIZE);
+  memset(data, 'y', FrameArena::HUGE_PAGE_SIZE);
+  EXPECT_TRUE(bound.GetNumaNode() == 0 || bound.GetNumaNode() == -1);
+}
+
+TEST(FrameArenaTest, BufferPoolLayoutTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: frame data is contiguous in the arena, also for frames added by growing the pool.
+  for (bool huge_pages : {false, true}) {
+    buffer_pool_huge_pages = huge_pages;
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    const char *base = bpm->GetFrameArena().Base();
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_EQ(base + i * PAGE_SIZE, bpm->GetPages()[i].GetData());
+    }
+    const size_t grown_size = huge_pages ? 3 * FrameArena::HUGE_PAGE_SIZE / PAGE_SIZE : 8 * buffer_pool_size;
+    ASSERT_TRUE(bpm->ResizePool(grown_size));
+    std::vector<page_id_t> page_ids(grown_size);
+    std::vector<bool> used(grown_size, false);
+    for (auto &page_id : page_ids) {
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      ptrdiff_t offset = page->GetData() - base;
+      ASSERT_EQ(0, offset % PAGE_SIZE);
+      ASSERT_LT(offset / PAGE_SIZE, grown_size);
+      EXPECT_FALSE(used[offset / PAGE_SIZE]);
+      used[offset / PAGE_SIZE] = true;
+      page->GetData()[PAGE_SIZE - 1] = 'z';
+    }
+    for (page_id_t page_id : page_ids) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    delete bpm;
+  }
+  buffer_pool_huge_pages = false;
+
+  // Scenario: a parallel pool binds its shards to NUMA nodes where the machine has several, and works either way.
+  auto *parallel = new ParallelBufferPoolManager(2, buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, parallel->NewPage(&page_id));
+  EXPECT_TRUE(parallel->UnpinPage(page_id, false));
+  delete parallel;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
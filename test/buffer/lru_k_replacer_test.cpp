@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/trace_replay_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access six frames once and unpin them. Frame 1 is then accessed a second time.
+  for (frame_id_t frame_id = 1; frame_id <= 6; ++frame_id) {
+    lru_k_replacer.RecordAccess(frame_id);
+    lru_k_replacer.Unpin(frame_id);
+  }
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+  lru_k_replacer.RecordAccess(1);
+
+  // Scenario: frames with a single access have an infinite k-distance and go first, oldest first.
+  // Frame 1 has two accesses and is kept although its first access is the oldest of all.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: pinned frames are not victimized.
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Pin(3);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: among frames with k accesses, the one with the oldest k-th most recent access goes first.
+  lru_k_replacer.RecordAccess(2);  // 2: t1
+  lru_k_replacer.RecordAccess(3);  // 3: t2
+  lru_k_replacer.RecordAccess(3);  // 3: t2 t3
+  lru_k_replacer.RecordAccess(2);  // 2: t1 t4
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(5);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  // Scenario: OLTP traffic cycles over a hot set that fits in the pool, interrupted by large sequential scans
+  // over pages that are never read again. LRU lets every scan flush the hot set, LRU-K keeps it.
+  const size_t num_frames = 100;
+  const page_id_t hot_pages = 80;
+  const page_id_t scan_length = 500;
+  std::vector<page_id_t> trace;
+  page_id_t next_scan_page = hot_pages;
+  for (int round = 0; round < 20; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      for (page_id_t page_id = 0; page_id < hot_pages; ++page_id) {
+        trace.push_back(page_id);
+      }
+    }
+    for (page_id_t i = 0; i < scan_length; ++i) {
+      trace.push_back(next_scan_page++);
+    }
+  }
+
+  LRUReplacer lru_replacer(num_frames);
+  LRUKReplacer lru_k_replacer(num_frames, 2);
+  double lru_hit_ratio = ReplayTrace(&lru_replacer, num_frames, trace).HitRatio();
+  double lru_k_hit_ratio = ReplayTrace(&lru_k_replacer, num_frames, trace).HitRatio();
+  printf("lru hit ratio %.4f, lru-k hit ratio %.4f\n", lru_hit_ratio, lru_k_hit_ratio);
+  EXPECT_GT(lru_k_hit_ratio, lru_hit_ratio);
+}
+
+TEST(LRUKReplacerTest, BufferPoolTest) {
+  // Scenario: a page fetched repeatedly survives a scan that is larger than the buffer pool.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRUK);
+
+  page_id_t hot_page_id;
+  Page *hot_page = bpm->NewPage(&hot_page_id);
+  ASSERT_NE(nullptr, hot_page);
+  snprintf(hot_page->GetData(), PAGE_SIZE, "hot");
+  EXPECT_TRUE(bpm->UnpinPage(hot_page_id, true));
+  ASSERT_EQ(hot_page, bpm->FetchPage(hot_page_id));
+  EXPECT_TRUE(bpm->UnpinPage(hot_page_id, false));
+
+  page_id_t page_id;
+  for (size_t i = 0; i < 4 * buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // The hot page never left its frame.
+  EXPECT_EQ(hot_page_id, hot_page->GetPageId());
+  EXPECT_EQ(hot_page, bpm->FetchPage(hot_page_id));
+  EXPECT_EQ(0, strcmp(hot_page->GetData(), "hot"));
+  EXPECT_TRUE(bpm->UnpinPage(hot_page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -16,18 +16,18 @@
 #include <unordered_map>
 
 #include "../test/buffer/counter.h"
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 namespace bustub {
 
 // Add callback functions on BufferPoolManager
-class MockBufferPoolManager : public BufferPoolManager {
+class MockBufferPoolManager : public BufferPoolManagerInstance {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (MockBufferPoolManager::*)(enum CallbackType type, FuncType func_type);
 
   MockBufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr)
-      : BufferPoolManager(pool_size, disk_manager, log_manager) {}
+      : BufferPoolManagerInstance(pool_size, disk_manager, log_manager) {}
 
   void counter_callback(enum CallbackType type, FuncType func_type) {
     if (type == CallbackType::BEFORE) {
@@ -126,7 +126,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   Page *FetchPageImpl(page_id_t page_id) {
     counter.AddCount(FuncType::FetchPage);
-    return BufferPoolManager::FetchPageImpl(page_id);
+    return BufferPoolManagerInstance::FetchPageImpl(page_id);
   }
 
   /**
@@ -137,7 +137,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool UnpinPageImpl(page_id_t page_id, bool is_dirty) {
     counter.AddCount(FuncType::UnpinPage);
-    return BufferPoolManager::UnpinPageImpl(page_id, is_dirty);
+    return BufferPoolManagerInstance::UnpinPageImpl(page_id, is_dirty);
   }
 
   /**
@@ -147,7 +147,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool FlushPageImpl(page_id_t page_id) {
     counter.AddCount(FuncType::FlushPage);
-    return BufferPoolManager::FlushPageImpl(page_id);
+    return BufferPoolManagerInstance::FlushPageImpl(page_id);
   }
 
   /**
@@ -157,7 +157,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   Page *NewPageImpl(page_id_t *page_id) {
     counter.AddCount(FuncType::NewPage);
-    return BufferPoolManager::NewPageImpl(page_id);
+    return BufferPoolManagerInstance::NewPageImpl(page_id);
   }
 
   /**
@@ -167,7 +167,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool DeletePageImpl(page_id_t page_id) {
     counter.AddCount(FuncType::DeletePage);
-    return BufferPoolManager::DeletePageImpl(page_id);
+    return BufferPoolManagerInstance::DeletePageImpl(page_id);
   }
 
   /**
@@ -175,7 +175,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   void FlushAllPagesImpl() {
     counter.AddCount(FuncType::FlushAllPages);
-    BufferPoolManager::FlushAllPagesImpl();
+    BufferPoolManagerInstance::FlushAllPagesImpl();
   }
 
   // For grading. Do not modify!
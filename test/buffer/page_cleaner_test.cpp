@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_cleaner_test.cpp
+//
+// Identification: test/buffer/page_cleaner_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Fills the pool with dirty, unpinned pages whose contents name their page id. */
+std::vector<page_id_t> FillDirty(BufferPoolManager *bpm, size_t num_pages) {
+  std::vector<page_id_t> page_ids(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_ids[i]);
+    EXPECT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_ids[i]);
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+  return page_ids;
+}
+
+/** Waits until the page cleaner has written back at least num_pages pages. */
+bool WaitForCleaner(BufferPoolManager *bpm, uint64_t num_pages) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetPageCleanerStats().pages_cleaned_ < num_pages) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+/** Evicts every page of the pool by creating as many new ones. */
+void Churn(BufferPoolManager *bpm, size_t num_pages) {
+  page_id_t page_id;
+  for (size_t i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+void ExpectContents(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids) {
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+}  // namespace
+
+TEST(PageCleanerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRUK, ReplacerType::ARC}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+
+    // Scenario: without a cleaner, every dirty victim is written back by the thread that needs its frame.
+    std::vector<page_id_t> page_ids = FillDirty(bpm, buffer_pool_size);
+    Churn(bpm, buffer_pool_size);
+    PageCleanerStats stats = bpm->GetPageCleanerStats();
+    EXPECT_EQ(0, stats.pages_cleaned_);
+    EXPECT_EQ(buffer_pool_size, stats.sync_victim_flushes_);
+    EXPECT_EQ(0, stats.avoided_victim_flushes_);
+
+    // Scenario: the cleaner writes back the dirty pages while they sit in the replacer, so evicting them is free.
+    page_ids = FillDirty(bpm, buffer_pool_size);
+    bpm->RunPageCleaner(buffer_pool_size);
+    ASSERT_TRUE(WaitForCleaner(bpm, buffer_pool_size));
+    bpm->StopPageCleaner();
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_FALSE(bpm->GetPages()[i].IsDirty());
+      EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+    }
+    // New pages are dirty until written, so filling the pool again had to write back the ones created by Churn.
+    stats = bpm->GetPageCleanerStats();
+    EXPECT_EQ(buffer_pool_size, stats.pages_cleaned_);
+    EXPECT_EQ(2 * buffer_pool_size, stats.sync_victim_flushes_);
+    Churn(bpm, buffer_pool_size);
+    stats = bpm->GetPageCleanerStats();
+    EXPECT_EQ(2 * buffer_pool_size, stats.sync_victim_flushes_);
+    EXPECT_EQ(buffer_pool_size, stats.avoided_victim_flushes_);
+
+    // Scenario: the pages the cleaner wrote come back intact.
+    ExpectContents(bpm, page_ids);
+
+    // Scenario: pinned pages are left alone.
+    Page *pinned = bpm->FetchPage(page_ids[0]);
+    ASSERT_NE(nullptr, pinned);
+    ASSERT_TRUE(bpm->UnpinPage(page_ids[0], true));
+    pinned = bpm->FetchPage(page_ids[0]);
+    bpm->RunPageCleaner(buffer_pool_size);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bpm->StopPageCleaner();
+    EXPECT_TRUE(pinned->IsDirty());
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[0], false));
+
+    disk_manager->ShutDown();
+    remove("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+TEST(PageCleanerTest, FlushAllTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: flushing a pool of dirty pages with adjacent ids writes them with one vectored write.
+  std::vector<page_id_t> page_ids = FillDirty(bpm, buffer_pool_size);
+  int writes = disk_manager->GetNumWrites();
+  int write_calls = disk_manager->GetNumWriteCalls();
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+  EXPECT_EQ(write_calls + 1, disk_manager->GetNumWriteCalls());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_FALSE(bpm->GetPages()[i].IsDirty());
+  }
+
+  // Scenario: clean pages are not written again, and come back intact once evicted.
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+  Churn(bpm, buffer_pool_size);
+  EXPECT_EQ(0, bpm->GetPageCleanerStats().sync_victim_flushes_);
+  ExpectContents(bpm, page_ids);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(PageCleanerTest, ConcurrencyTest) {
+  // Scenario: writers keep dirtying and evicting pages while the cleaner runs. No update may be lost, and every frame
+  // ends up unpinned and evictable.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 24;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, buffer_pool_size / 2, disk_manager, nullptr, ReplacerType::CLOCK);
+  bpm->RunPageCleaner(buffer_pool_size / 2);
+
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      for (size_t i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(&page_id);
+        while (page == nullptr) {
+          std::this_thread::yield();
+          page = bpm->NewPage(&page_id);
+        }
+        page_ids[tid].push_back(page_id);
+        ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+      }
+      for (size_t round = 0; round < 20; ++round) {
+        for (page_id_t page_id : page_ids[tid]) {
+          Page *page = bpm->FetchPage(page_id);
+          while (page == nullptr) {
+            std::this_thread::yield();
+            page = bpm->FetchPage(page_id);
+          }
+          page->WLatch();
+          snprintf(page->GetData(), PAGE_SIZE, "page %d round %zu", page_id, round);
+          page->WUnlatch();
+          ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // The workload may finish before the cleaner gets a CPU; the pool is still dirty, so its next pass has work.
+  std::this_thread::sleep_for(2 * page_cleaner_interval);
+  bpm->StopPageCleaner();
+
+  char expected[PAGE_SIZE];
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    for (page_id_t page_id : page_ids[tid]) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(expected, PAGE_SIZE, "page %d round %d", page_id, 19);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  PageCleanerStats stats = bpm->GetPageCleanerStats();
+  EXPECT_GT(stats.pages_cleaned_, 0);
+  printf("cleaned %" PRIu64 ", synchronous victim flushes %" PRIu64 ", avoided %" PRIu64 "\n", stats.pages_cleaned_,
+         stats.sync_victim_flushes_, stats.avoided_victim_flushes_);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
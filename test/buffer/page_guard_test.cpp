@@ -0,0 +1,255 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/buffer/page_guard_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+namespace {
+
+Page *FindFrame(BufferPoolManagerInstance *bpm, page_id_t page_id) {
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    if (bpm->GetPages()[i].GetPageId() == page_id) {
+      return &bpm->GetPages()[i];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * Drops guard after checking that another thread cannot take the given latch on frame while the guard is held.
+ * @return true if the other thread was blocked until the guard was dropped
+ */
+template <class Guard>
+bool BlocksUntilDropped(Page *frame, Guard *guard, bool write) {
+  std::atomic<bool> acquired{false};
+  std::thread other([&] {
+    if (write) {
+      frame->WLatch();
+      acquired = true;
+      frame->WUnlatch();
+    } else {
+      frame->RLatch();
+      acquired = true;
+      frame->RUnlatch();
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  bool blocked = !acquired;
+  guard->Drop();
+  other.join();
+  return blocked && acquired;
+}
+
+/** Reads the first byte of a page through a read guard, bailing out early on odd page ids. */
+bool ReadEven(BufferPoolManager *bpm, page_id_t page_id, char *out) {
+  ReadPageGuard guard = bpm->FetchPageRead(page_id);
+  if (!guard.IsValid() || page_id % 2 == 1) {
+    return false;
+  }
+  *out = guard.As<Page>()->GetData()[0];
+  return true;
+}
+
+}  // namespace
+
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: a guard from NewPageGuarded holds the pin until it goes out of scope.
+  page_id_t page_id;
+  {
+    BasicPageGuard guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(page_id, guard.PageId());
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+    snprintf(guard.AsMut<Page>()->GetData(), PAGE_SIZE, "hello");
+  }
+  Page *frame = FindFrame(bpm, page_id);
+  ASSERT_NE(nullptr, frame);
+  EXPECT_EQ(0, frame->GetPinCount());
+  EXPECT_TRUE(frame->IsDirty());
+  ASSERT_TRUE(bpm->FlushPage(page_id));
+  EXPECT_FALSE(frame->IsDirty());
+
+  // Scenario: flushing a page that the caller holds write-latched skips it instead of waiting for the caller, and the
+  // page is written once the guard is gone.
+  {
+    WritePageGuard writer = bpm->FetchPageWrite(page_id);
+    snprintf(writer.AsMut<Page>()->GetData(), PAGE_SIZE, "hello");
+    EXPECT_FALSE(bpm->FlushPage(page_id));
+    bpm->FlushAllPages();
+  }
+  EXPECT_TRUE(frame->IsDirty());
+  ASSERT_TRUE(bpm->FlushPage(page_id));
+  EXPECT_FALSE(frame->IsDirty());
+
+  // Scenario: moving a guard transfers the pin, and Drop releases it exactly once.
+  {
+    BasicPageGuard guard = bpm->FetchPageBasic(page_id);
+    BasicPageGuard moved = std::move(guard);
+    EXPECT_FALSE(guard.IsValid());  // NOLINT
+    EXPECT_EQ(1, frame->GetPinCount());
+    moved.Drop();
+    EXPECT_EQ(0, frame->GetPinCount());
+    moved.Drop();
+    EXPECT_EQ(0, frame->GetPinCount());
+  }
+  EXPECT_FALSE(frame->IsDirty());
+
+  // Scenario: move assignment releases the pin the target held before taking over the other one.
+  page_id_t other_id;
+  {
+    BasicPageGuard guard = bpm->NewPageGuarded(&other_id);
+    guard = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(page_id, guard.PageId());
+    EXPECT_EQ(0, FindFrame(bpm, other_id)->GetPinCount());
+    EXPECT_EQ(1, frame->GetPinCount());
+  }
+  EXPECT_EQ(0, frame->GetPinCount());
+
+  // Scenario: a read guard holds the read latch, so other readers get in and writers do not.
+  {
+    ReadPageGuard reader = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp(reader.As<Page>()->GetData(), "hello"));
+    ReadPageGuard other_reader = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, frame->GetPinCount());
+    other_reader.Drop();
+    EXPECT_TRUE(BlocksUntilDropped(frame, &reader, true));
+  }
+  EXPECT_EQ(0, frame->GetPinCount());
+
+  // Scenario: a write guard holds the write latch, and only dirties the page when it is written through.
+  {
+    WritePageGuard writer = bpm->FetchPageWrite(page_id);
+    EXPECT_TRUE(BlocksUntilDropped(frame, &writer, false));
+  }
+  EXPECT_FALSE(frame->IsDirty());
+  {
+    WritePageGuard writer = bpm->FetchPageWrite(page_id);
+    snprintf(writer.AsMut<Page>()->GetData(), PAGE_SIZE, "world");
+  }
+  EXPECT_TRUE(frame->IsDirty());
+  EXPECT_EQ(0, frame->GetPinCount());
+
+  // Scenario: early returns do not leak pins, so the whole pool can still be reused afterwards.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    BasicPageGuard guard = bpm->NewPageGuarded(&page_ids.emplace_back());
+    ASSERT_TRUE(guard.IsValid());
+    guard.AsMut<Page>()->GetData()[0] = static_cast<char>('a' + i);
+  }
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    char c = 0;
+    EXPECT_EQ(page_ids[i] % 2 == 0, ReadEven(bpm, page_ids[i], &c));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+  std::vector<BasicPageGuard> pinned;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    pinned.push_back(bpm->FetchPageBasic(page_ids[i]));
+    ASSERT_TRUE(pinned.back().IsValid());
+    EXPECT_EQ(static_cast<char>('a' + i), pinned.back().As<Page>()->GetData()[0]);
+  }
+  EXPECT_FALSE(bpm->FetchPageBasic(page_ids.back()).IsValid());
+  pinned.clear();
+  EXPECT_TRUE(bpm->FetchPageBasic(page_ids.back()).IsValid());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(PageGuardTest, OptimisticReadTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t page_id;
+  bpm->NewPageGuarded(&page_id).Drop();
+
+  // Scenario: a read section that saw no writer succeeds the first time, and returns what the reader returned.
+  BasicPageGuard reader = bpm->FetchPageBasic(page_id);
+  int runs = 0;
+  EXPECT_EQ(0, reader.OptimisticRead<Page>([&](const Page *page) { return ++runs - 1; }));
+  EXPECT_EQ(1, runs);
+
+  // Scenario: a writer that latches the page while a section runs makes it run again.
+  runs = 0;
+  int seen = reader.OptimisticRead<int>([&](const int *data) {
+    if (runs++ == 0) {
+      WritePageGuard writer = bpm->FetchPageWrite(page_id);
+      *writer.AsMut<int>() = 42;
+    }
+    return *data;
+  });
+  EXPECT_EQ(2, runs);
+  EXPECT_EQ(42, seen);
+
+  // Scenario: concurrent readers never return a half-written page. The writer keeps two counters equal, but only
+  // between its write latch sections.
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (int i = 1; i <= 20000; ++i) {
+      WritePageGuard guard = bpm->FetchPageWrite(page_id);
+      auto *counters = guard.AsMut<int>();
+      counters[0] = i;
+      std::this_thread::yield();
+      counters[1] = i;
+    }
+    done = true;
+  });
+  std::vector<std::thread> readers;
+  std::atomic<int> torn{0};
+  for (int t = 0; t < 2; ++t) {
+    readers.emplace_back([&] {
+      BasicPageGuard guard = bpm->FetchPageBasic(page_id);
+      while (!done) {
+        auto counters = guard.OptimisticRead<int>([](const int *data) { return std::make_pair(data[0], data[1]); });
+        if (counters.first != counters.second) {
+          torn++;
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &thread : readers) {
+    thread.join();
+  }
+  EXPECT_EQ(0, torn);
+  reader.Drop();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
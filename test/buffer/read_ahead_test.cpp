@@ -0,0 +1,275 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_test.cpp
+//
+// Identification: test/buffer/read_ahead_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "buffer/prefetch_tracker.h"
+#include "buffer/read_ahead.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+bool IsResident(BufferPoolManagerInstance *bpm, page_id_t page_id) {
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    if (bpm->GetPages()[i].GetPageId() == page_id && bpm->GetPages()[i].GetPinCount() >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @return which of page_ids are resident */
+std::vector<bool> Residency(BufferPoolManagerInstance *bpm, const std::vector<page_id_t> &page_ids) {
+  std::vector<bool> resident;
+  for (page_id_t page_id : page_ids) {
+    resident.push_back(IsResident(bpm, page_id));
+  }
+  return resident;
+}
+
+/** Waits until every page in page_ids has been loaded by the prefetch thread. */
+bool WaitForResident(BufferPoolManagerInstance *bpm, const std::vector<page_id_t> &page_ids) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  for (page_id_t page_id : page_ids) {
+    while (!IsResident(bpm, page_id)) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  return true;
+}
+
+/** Creates num_pages pages whose contents name their page id, leaving only the last pool_size of them resident. */
+std::vector<page_id_t> CreatePages(BufferPoolManager *bpm, size_t num_pages) {
+  std::vector<page_id_t> page_ids(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(&page_ids[i]);
+    EXPECT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_ids[i]);
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+  return page_ids;
+}
+
+}  // namespace
+
+TEST(ReadAheadTest, PrefetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids = CreatePages(bpm, 3 * buffer_pool_size);
+
+  // Scenario: prefetched pages are loaded in the background, unpinned, and fetched as hits with their contents.
+  std::vector<page_id_t> cold(page_ids.begin(), page_ids.begin() + 5);
+  for (page_id_t page_id : cold) {
+    EXPECT_FALSE(IsResident(bpm, page_id));
+  }
+  bpm->PrefetchPages(cold);
+  ASSERT_TRUE(WaitForResident(bpm, cold));
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : cold) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: pages that were never allocated are not cached, so NewPage can still hand them out.
+  bpm->PrefetchPages({static_cast<page_id_t>(page_ids.size()), page_ids[5]});
+  ASSERT_TRUE(WaitForResident(bpm, {page_ids[5]}));
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(static_cast<page_id_t>(page_ids.size()), page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: a prefetch never evicts a pinned page.
+  std::vector<Page *> pinned;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    pinned.push_back(bpm->FetchPage(page_ids[10 + i]));
+    ASSERT_NE(nullptr, pinned.back());
+  }
+  bpm->PrefetchPages({page_ids[0]});
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(page_ids[10 + i], pinned[i]->GetPageId());
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[10 + i], false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(ReadAheadTest, DetectionTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 20;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids = CreatePages(bpm, 4 * buffer_pool_size);
+
+  // Scenario: a single move does not start read-ahead, a second move with the same stride does.
+  ReadAhead read_ahead(bpm);
+  read_ahead.OnPage(0);
+  read_ahead.OnPage(2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(IsResident(bpm, 4));
+  read_ahead.OnPage(4);
+  std::vector<page_id_t> ahead;
+  for (size_t i = 1; i <= READ_AHEAD_PAGES; ++i) {
+    ahead.push_back(static_cast<page_id_t>(4 + 2 * i));
+  }
+  ASSERT_TRUE(WaitForResident(bpm, ahead));
+  EXPECT_FALSE(IsResident(bpm, 5));
+
+  // Scenario: breaking the stride stops read-ahead until a new stride is confirmed.
+  read_ahead.OnPage(40);
+  read_ahead.OnPage(41);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(IsResident(bpm, 42));
+  read_ahead.OnPage(42);
+  EXPECT_TRUE(WaitForResident(bpm, {43, 44, 45, 46, 47, 48, 49, 50}));
+
+  // Scenario: with a ring, the window is kept to half of it.
+  BufferAccessStrategy strategy(4);
+  ReadAhead ring_read_ahead(bpm, &strategy);
+  ring_read_ahead.OnPage(0);
+  ring_read_ahead.OnPage(1);
+  ring_read_ahead.OnPage(2);
+  ASSERT_TRUE(WaitForResident(bpm, {3, 4}));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(IsResident(bpm, 5));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(ReadAheadTest, TableScanTest) {
+  // Scenario: a cold scan of a table much larger than the pool, with read-ahead into the scan's ring, returns every
+  // tuple in order. The strategy outlives the scan but is destroyed while prefetches may still be queued.
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(4, 8, disk_manager);
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, txn);
+
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 200)});
+  const int num_tuples = 2000;
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(150, 'x'))}, &schema);
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, txn));
+  }
+
+  for (size_t ring_size : {0, 4, 32}) {
+    auto strategy = ring_size == 0 ? nullptr : std::make_unique<BufferAccessStrategy>(ring_size);
+    int expected = 0;
+    for (auto it = table->Begin(txn, strategy.get()); it != table->End(); ++it) {
+      ASSERT_EQ(expected++, it->GetValue(&schema, 0).GetAs<int32_t>());
+      if (expected == num_tuples / 2) {
+        break;
+      }
+    }
+    EXPECT_EQ(num_tuples / 2, expected);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete table;
+  delete txn;
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(ReadAheadTest, PrefetchTrackerTest) {
+  // Scenario: once the scan reaches a page, the requests queued up to the one for that page are skipped.
+  PrefetchTracker tracker;
+  size_t first = tracker.Begin(5);
+  size_t second = tracker.Begin(6);
+  size_t third = tracker.Begin(7);
+  tracker.Reach(6);
+  EXPECT_FALSE(tracker.IsWanted(first));
+  EXPECT_FALSE(tracker.IsWanted(second));
+  EXPECT_TRUE(tracker.IsWanted(third));
+
+  // Scenario: pages that were never queued do not move the tracker on.
+  tracker.Reach(9);
+  EXPECT_TRUE(tracker.IsWanted(third));
+
+  // Scenario: request numbers keep increasing once every request is done.
+  tracker.Finish();
+  tracker.Finish();
+  tracker.Finish();
+  size_t fourth = tracker.Begin(8);
+  EXPECT_GT(fourth, third);
+  EXPECT_TRUE(tracker.IsWanted(fourth));
+  tracker.Finish();
+}
+
+TEST(ReadAheadTest, QuiesceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 20;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids = CreatePages(bpm, 4 * buffer_pool_size);
+
+  // Scenario: once a scan's read-ahead is destroyed, nothing it queued is loaded any more.
+  {
+    ReadAhead read_ahead(bpm);
+    for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+      read_ahead.OnPage(page_id);
+    }
+  }
+  std::vector<bool> resident = Residency(bpm, page_ids);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(resident, Residency(bpm, page_ids));
+
+  // Scenario: StopPrefetcher drops the queued warm-up reads, and a later prefetch starts the thread again.
+  bpm->WarmUp(std::vector<page_id_t>(page_ids.begin(), page_ids.begin() + buffer_pool_size));
+  bpm->StopPrefetcher();
+  resident = Residency(bpm, page_ids);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(resident, Residency(bpm, page_ids));
+  bpm->PrefetchPages({page_ids[0]});
+  EXPECT_TRUE(WaitForResident(bpm, {page_ids[0]}));
+
+  // Scenario: after StopPrefetcher, the disk manager can go before the pool.
+  bpm->WarmUp(page_ids);
+  bpm->StopPrefetcher();
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  // Check values from RFC 3720, which specifies CRC-32C for iSCSI.
+  const std::string digits = "123456789";
+  EXPECT_EQ(0xE3069283, Crc32c::Compute(digits.data(), digits.size()));
+  EXPECT_EQ(0xE3069283, Crc32c::ExtendPortable(0, digits.data(), digits.size()));
+  std::vector<char> zeros(32, 0);
+  EXPECT_EQ(0x8A9136AA, Crc32c::Compute(zeros.data(), zeros.size()));
+  std::vector<char> ones(32, static_cast<char>(0xFF));
+  EXPECT_EQ(0x62A8AB43, Crc32c::Compute(ones.data(), ones.size()));
+  EXPECT_EQ(0, Crc32c::Compute(nullptr, 0));
+
+  // Extending in pieces gives the checksum of the whole.
+  EXPECT_EQ(0xE3069283, Crc32c::Extend(Crc32c::Compute(digits.data(), 4), digits.data() + 4, digits.size() - 4));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, PortableMatchesHardwareTest) {
+  std::mt19937 gen(0);
+  std::vector<char> data(PAGE_SIZE + 7);
+  for (char &c : data) {
+    c = static_cast<char>(gen());
+  }
+  // Every length and alignment up to a word past the 8-byte blocks of the main loop.
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t length = 0; length < 24; ++length) {
+      EXPECT_EQ(Crc32c::ExtendPortable(0, data.data() + offset, length),
+                Crc32c::Compute(data.data() + offset, length));
+    }
+  }
+  EXPECT_EQ(Crc32c::ExtendPortable(0, data.data() + 3, PAGE_SIZE), Crc32c::Compute(data.data() + 3, PAGE_SIZE));
+}
+
+TEST(Crc32cTest, DISABLED_PageChecksumBenchmark) {
+  const int num_pages = 100000;
+  std::vector<char> page(PAGE_SIZE, 'x');
+  uint32_t crc = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_pages; ++i) {
+    crc ^= Crc32c::Compute(page.data(), PAGE_DATA_SIZE);
+  }
+  std::chrono::duration<double, std::nano> hardware = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_pages; ++i) {
+    crc ^= Crc32c::ExtendPortable(0, page.data(), PAGE_DATA_SIZE);
+  }
+  std::chrono::duration<double, std::nano> portable = std::chrono::steady_clock::now() - start;
+  printf("%10s %14s %10s\n", "impl", "ns per page", "GB/s");
+  printf("%10s %14.0f %10.2f\n", Crc32c::IsHardwareAccelerated() ? "hardware" : "tables", hardware.count() / num_pages,
+         num_pages * PAGE_DATA_SIZE / hardware.count());
+  printf("%10s %14.0f %10.2f\n", "tables", portable.count() / num_pages, num_pages * PAGE_DATA_SIZE / portable.count());
+  // Each loop folds in an even number of equal checksums, which cancel out; using them keeps the loops in the binary.
+  EXPECT_EQ(0, crc);
+}
+
+}  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trace_replay_util.h
+//
+// Identification: test/include/buffer/trace_replay_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+/** Outcome of replaying a page access trace against a replacer. */
+struct TraceReplayResult {
+  size_t hits_{0};
+  size_t misses_{0};
+  double ns_per_access_{0};
+
+  double HitRatio() const { return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / (hits_ + misses_); }
+};
+
+/**
+ * Replays a trace of page ids against a simulated buffer pool of num_frames frames driven by replacer. Every access
+ * makes the same replacer calls as a FetchPage / UnpinPage pair on BufferPoolManagerInstance: a hit pins, records the
+ * access and unpins; a miss takes a free frame or a victim, reports the eviction and the load, and unpins.
+ */
+inline TraceReplayResult ReplayTrace(Replacer *replacer, size_t num_frames, const std::vector<page_id_t> &trace) {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_pages(num_frames, INVALID_PAGE_ID);
+  size_t free_frames = num_frames;
+  TraceReplayResult result;
+
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id : trace) {
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      result.hits_++;
+      replacer->Pin(it->second);
+      replacer->RecordAccess(it->second);
+      replacer->Unpin(it->second);
+      continue;
+    }
+
+    result.misses_++;
+    frame_id_t frame_id;
+    if (free_frames > 0) {
+      frame_id = static_cast<frame_id_t>(--free_frames);
+    } else {
+      if (!replacer->Victim(&frame_id)) {
+        throw Exception("replacer has no victim although no frame is pinned");
+      }
+      replacer->RecordEviction(frame_id, frame_pages[frame_id]);
+      page_table.erase(frame_pages[frame_id]);
+    }
+    frame_pages[frame_id] = page_id;
+    page_table[page_id] = frame_id;
+    replacer->RecordLoad(frame_id, page_id);
+    replacer->Unpin(frame_id);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  result.ns_per_access_ = trace.empty() ? 0 : elapsed.count() / trace.size();
+  return result;
+}
+
+/**
+ * Generates a trace of length accesses drawn from a Zipf(theta) distribution over num_pages pages. Popularity ranks
+ * are shuffled over page ids so that hot pages are not adjacent.
+ */
+inline std::vector<page_id_t> MakeZipfianTrace(size_t num_pages, size_t length, double theta, uint32_t seed = 15445) {
+  std::vector<double> cdf(num_pages);
+  double sum = 0;
+  for (size_t i = 0; i < num_pages; ++i) {
+    sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+    cdf[i] = sum;
+  }
+  std::vector<page_id_t> rank_to_page(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    rank_to_page[i] = static_cast<page_id_t>(i);
+  }
+  std::mt19937 rng(seed);
+  std::shuffle(rank_to_page.begin(), rank_to_page.end(), rng);
+  std::uniform_real_distribution<double> uniform(0, sum);
+  std::vector<page_id_t> trace(length);
+  for (auto &page_id : trace) {
+    size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+    page_id = rank_to_page[std::min(rank, num_pages - 1)];
+  }
+  return trace;
+}
+
+/** Writes a trace as one page id per line. */
+inline void SaveTrace(const std::string &path, const std::vector<page_id_t> &trace) {
+  std::ofstream out(path);
+  for (page_id_t page_id : trace) {
+    out << page_id << '\n';
+  }
+}
+
+/** Reads a trace of whitespace separated page ids, e.g. one written by SaveTrace. */
+inline std::vector<page_id_t> LoadTrace(const std::string &path) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    throw Exception("cannot open trace file " + path);
+  }
+  std::vector<page_id_t> trace;
+  page_id_t page_id;
+  while (in >> page_id) {
+    trace.push_back(page_id);
+  }
+  return trace;
+}
+
+}  // namespace bustub
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  }
+};
+
+namespace {
+
+/** Commits num_commits transactions from each of num_threads threads, each waiting for its commit record. */
+void RunCommitters(LogManager *log_manager, int num_threads, int num_commits) {
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < num_threads; ++thread) {
+    threads.emplace_back([=] {
+      for (int i = 0; i < num_commits; ++i) {
+        LogRecord log_record(thread * num_commits + i, INVALID_LSN, LogRecordType::COMMIT);
+        lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+        log_manager->Flush(lsn);
+        ASSERT_GE(log_manager->GetPersistentLSN(), lsn);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  const int num_threads = 16;
+  const int num_commits = 50;
+  {
+    DiskManager disk_manager("test.db");
+    LogManager log_manager(&disk_manager);
+    log_manager.RunFlushThread();
+    EXPECT_TRUE(enable_logging);
+
+    // Scenario: every commit returns once its record is durable, and concurrent commits share syncs.
+    RunCommitters(&log_manager, num_threads, num_commits);
+    EXPECT_EQ(num_threads * num_commits - 1, log_manager.GetPersistentLSN());
+    EXPECT_LT(disk_manager.GetNumFlushes(), num_threads * num_commits);
+
+    // Scenario: records that nobody waits for are written when the flush thread stops.
+    LogRecord log_record(0, INVALID_LSN, LogRecordType::BEGIN);
+    lsn_t lsn = log_manager.AppendLogRecord(&log_record);
+    log_manager.StopFlushThread();
+    EXPECT_FALSE(enable_logging);
+    EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+    disk_manager.ShutDown();
+  }
+
+  // Scenario: the log holds every record once, in LSN order.
+  DiskManager disk_manager("test.db");
+  std::vector<char> log(20 * (num_threads * num_commits + 1));
+  ASSERT_TRUE(disk_manager.ReadLog(log.data(), static_cast<int>(log.size()), 0));
+  for (lsn_t lsn = 0; lsn <= num_threads * num_commits; ++lsn) {
+    int32_t header[5];
+    std::memcpy(header, log.data() + lsn * sizeof(header), sizeof(header));
+    EXPECT_EQ(20, header[0]);
+    EXPECT_EQ(lsn, header[1]);
+  }
+  char past_end;
+  EXPECT_FALSE(disk_manager.ReadLog(&past_end, 1, static_cast<int>(log.size())));
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, NoFlushThreadTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+
+  // Scenario: a record that cannot fit in the log buffer is rejected instead of waiting for room forever.
+  Schema schema({Column("a", TypeId::VARCHAR, LOG_BUFFER_SIZE)});
+  Tuple tuple({ValueFactory::GetVarcharValue(std::string(LOG_BUFFER_SIZE, 'x'))}, &schema);
+  LogRecord large(0, INVALID_LSN, LogRecordType::INSERT, RID(0, 0), tuple);
+  EXPECT_THROW(log_manager.AppendLogRecord(&large), Exception);
+
+  // Scenario: without a flush thread, a full buffer is written by the appender and Flush writes the rest.
+  const int header_size = 20;
+  const int num_records = 2 * LOG_BUFFER_SIZE / header_size;
+  lsn_t lsn = INVALID_LSN;
+  for (int i = 0; i < num_records; ++i) {
+    LogRecord log_record(i, INVALID_LSN, LogRecordType::BEGIN);
+    lsn = log_manager.AppendLogRecord(&log_record);
+  }
+  EXPECT_NE(INVALID_LSN, log_manager.GetPersistentLSN());
+  EXPECT_LT(log_manager.GetPersistentLSN(), lsn);
+  log_manager.Flush(lsn);
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+
+  // Scenario: a record appended after the flush thread stopped is written by Flush.
+  log_manager.RunFlushThread();
+  log_manager.StopFlushThread();
+  LogRecord late(0, INVALID_LSN, LogRecordType::COMMIT);
+  lsn = log_manager.AppendLogRecord(&late);
+  log_manager.Flush(lsn);
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+
+  std::vector<char> log(header_size * (num_records + 1));
+  ASSERT_TRUE(disk_manager.ReadLog(log.data(), static_cast<int>(log.size()), 0));
+  char past_end;
+  EXPECT_FALSE(disk_manager.ReadLog(&past_end, 1, static_cast<int>(log.size())));
+  disk_manager.ShutDown();
+}
+
+TEST_F(LogManagerTest, DISABLED_GroupCommitBenchmark) {
+  const int commits_per_round = 2048;
+  printf("%10s %14s %10s %16s\n", "committers", "commits/s", "syncs", "commits per sync");
+  for (int num_threads : {1, 8, 64}) {
+    remove("test.log");
+    DiskManager disk_manager("test.db");
+    LogManager log_manager(&disk_manager);
+    log_manager.RunFlushThread();
+    auto start = std::chrono::steady_clock::now();
+    RunCommitters(&log_manager, num_threads, commits_per_round / num_threads);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    log_manager.StopFlushThread();
+    const int syncs = disk_manager.GetNumFlushes();
+    printf("%10d %14.0f %10d %16.1f\n", num_threads, commits_per_round / elapsed.count(), syncs,
+           static_cast<double>(commits_per_round) / syncs);
+    if (num_threads == 1) {
+      // A lone committer has nobody to share a sync with.
+      EXPECT_EQ(commits_per_round, syncs);
+    }
+    disk_manager.ShutDown();
+  }
+}
+
+}  // namespace bustub
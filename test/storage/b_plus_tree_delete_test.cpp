@@ -5,10 +5,13 @@
 #include <algorithm>
 #include <cstdio>
 #include <chrono>
+#include <map>
 #include <random>
+#include <string>
+#include <utility>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 
@@ -21,7 +24,7 @@ TEST(BPlusTreeTests, DeleteTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -101,7 +104,7 @@ TEST(BPlusTreeTests, DeleteTest2) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -214,7 +217,7 @@ TEST(BPlusTreeTests, LeafPageMoveLastToFrontOf) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(5, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *leaf_page = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(leaf_ptr);
   BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *recipient_page = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(recipient_ptr);
@@ -252,7 +255,7 @@ TEST(BPlusTreeTests, LeafPageMoveAllTo) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(5, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *leaf_page = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(leaf_ptr);
   BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *recipient_page = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(recipient_ptr);
@@ -299,7 +302,7 @@ TEST(BPlusTreeTests, LeafPageMoveFirstToEndOf) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(5, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *leaf_page = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(leaf_ptr);
   BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *recipient_page = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(recipient_ptr);
@@ -415,7 +418,7 @@ TEST(BPlusTreeTests, InternalPageMoveAllTo) {
 
   page_id_t page_id;
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(5, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   std::vector<int64_t> left_keys = {1, 2};
   std::vector<int64_t> right_keys = {5, 7, 9};
@@ -454,7 +457,7 @@ TEST(BPlusTreeTests, InternalPageMoveFirstToEndOf) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(5, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   std::vector<int64_t> left_keys = {1, 2};
   std::vector<int64_t> right_keys = {5, 7, 9, 11};
@@ -535,7 +538,7 @@ TEST(BPlusTreeTests, InternalPageMoveLastToFrontOf) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(5, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   std::vector<int64_t> left_keys = {1, 2, 3, 4};
   std::vector<int64_t> right_keys = {6, 7};
@@ -618,7 +621,7 @@ TEST(BPlusTreeTests, BPlusTreeRedistribute) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(5, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
 
@@ -686,7 +689,7 @@ TEST(BPlusTreeTests, CoalesceTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(20, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 6);
   GenericKey<8> index_key;
@@ -745,7 +748,7 @@ TEST(BPlusTreeTests, RedistributeTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(20, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 6);
   GenericKey<8> index_key;
@@ -806,7 +809,7 @@ TEST(BPlusTreeTests, DeleteTestBig) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(20, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 10, 11);
   GenericKey<8> index_key;
@@ -865,4 +868,162 @@ TEST(BPlusTreeTests, DeleteTestBig) {
   remove("test.log");
 }
 
+
+TEST(BPlusTreeTests, DeletePageReuseTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(20, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 10, 11);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  auto highest_page_id = [&] {
+    page_id_t highest = INVALID_PAGE_ID;
+    for (page_id_t id = 0; id < 10000; ++id) {
+      if (disk_manager->IsAllocated(id)) {
+        highest = id;
+      }
+    }
+    return highest;
+  };
+
+  // Scenario: the pages a tree frees when it shrinks hold it when it grows again, so the file does not grow.
+  page_id_t highest = INVALID_PAGE_ID;
+  for (int round = 0; round < 3; ++round) {
+    for (int64_t key = 1; key <= 2000; ++key) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    if (round == 0) {
+      highest = highest_page_id();
+    }
+    EXPECT_EQ(highest, highest_page_id());
+    for (int64_t key = 1; key <= 2000; ++key) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+    EXPECT_GT(disk_manager->GetNumFreePages(), 100);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DeleteUnpinTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(20, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  // Scenario: removing every other key and then the rest redistributes and coalesces leaves and internal pages
+  // alike, and each of them leaves the pages it latched unpinned.
+  const int64_t num_keys = 1000;
+  for (int64_t key = 1; key <= num_keys; ++key) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  for (int64_t start : {2, 1}) {
+    for (int64_t key = start; key <= num_keys; key += 2) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+      Page &page = bpm->GetPages()[i];
+      if (page.GetPageId() != INVALID_PAGE_ID) {
+        EXPECT_EQ(page.GetPageId() == HEADER_PAGE_ID ? 1 : 0, page.GetPinCount());
+      }
+    }
+    std::vector<RID> rids;
+    for (int64_t key = 1; key <= num_keys; key += 2) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(start == 2, tree.GetValue(index_key, &rids));
+    }
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DeleteVersionTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(1000, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  const int64_t num_keys = 500;
+  for (int64_t key = 1; key <= num_keys; ++key) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  // The contents of each internal page that lookups read, and its version. Parent ids are left out, as lookups do not
+  // read them.
+  auto snapshot = [&] {
+    std::map<page_id_t, std::pair<std::string, uint64_t>> pages;
+    for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+      Page &page = bpm->GetPages()[i];
+      std::string data(page.GetData(), PAGE_SIZE);
+      auto *node = reinterpret_cast<BPlusTreePage *>(data.data());
+      if (page.GetPageId() != INVALID_PAGE_ID && page.GetPageId() != HEADER_PAGE_ID && !node->IsLeafPage()) {
+        node->SetParentPageId(INVALID_PAGE_ID);
+        pages[page.GetPageId()] = {data, page.ReadVersion()};
+      }
+    }
+    return pages;
+  };
+
+  // Scenario: every remove that redistributes or coalesces into an internal page moves its version, so that a lookup
+  // reading it optimistically notices the change.
+  for (int64_t key = 1; key <= num_keys; key += 3) {
+    auto before = snapshot();
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+    for (const auto &[id, page] : snapshot()) {
+      auto it = before.find(id);
+      if (it != before.end() && it->second.first != page.first) {
+        EXPECT_NE(it->second.second, page.second) << "page " << id << " changed without its version";
+      }
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -10,14 +10,55 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return the number of pages of file_name that are in the page cache */
+size_t CachedPages(const std::string &file_name, size_t num_pages) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  void *data = mmap(nullptr, num_pages * PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+  std::vector<unsigned char> resident((num_pages * PAGE_SIZE + getpagesize() - 1) / getpagesize());
+  size_t cached = 0;
+  if (data != MAP_FAILED && mincore(data, num_pages * PAGE_SIZE, resident.data()) == 0) {
+    for (unsigned char page : resident) {
+      cached += page & 1;
+    }
+    munmap(data, num_pages * PAGE_SIZE);
+  }
+  close(fd);
+  return cached * getpagesize() / PAGE_SIZE;
+}
+
+/** Writes back and drops the pages of file_name from the page cache, as if they had been pushed out by other data. */
+void DropCachedPages(const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+}  // namespace
+
 class DiskManagerTest : public ::testing::Test {
  protected:
   // This function is called before every test.
@@ -43,18 +84,396 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
 
   dm.ReadPage(0, buf);  // tolerate empty read
 
+  // The checksum trailer of data belongs to the write, so only the page contents are compared.
   dm.WritePage(0, data);
   dm.ReadPage(0, buf);
-  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(std::memcmp(buf, data, PAGE_DATA_SIZE), 0);
 
   std::memset(buf, 0, sizeof(buf));
   dm.WritePage(5, data);
   dm.ReadPage(5, buf);
-  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(std::memcmp(buf, data, PAGE_DATA_SIZE), 0);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadWritePagesTest) {
+  char data[8][PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Two runs of adjacent pages, given out of order, take one write call each.
+  std::vector<page_id_t> page_ids = {3, 1, 7, 2, 6};
+  std::vector<std::pair<page_id_t, char *>> writes;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    std::memset(data[i], 'a' + page_ids[i], PAGE_SIZE);
+    writes.emplace_back(page_ids[i], data[i]);
+  }
+  dm.WritePages(&writes);
+  EXPECT_EQ(5, dm.GetNumWrites());
+  EXPECT_EQ(2, dm.GetNumWriteCalls());
+
+  for (page_id_t page_id : page_ids) {
+    std::memset(data[0], 0, PAGE_SIZE);
+    ASSERT_TRUE(dm.ReadPage(page_id, data[0]));
+    std::memset(buf, 'a' + page_id, PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(buf, data[0], PAGE_DATA_SIZE), 0);
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreePageBitmapTest) {
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::string db_file("test.db");
+  auto dm = std::make_unique<DiskManager>(db_file);
+  for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+    ASSERT_EQ(page_id, dm->AllocatePage());
+    std::memset(data, 'a' + page_id, PAGE_SIZE);
+    dm->WritePage(page_id, data);
+  }
+
+  // Scenario: deallocated pages are reused before the file grows, the lowest first.
+  dm->DeallocatePage(3);
+  dm->DeallocatePage(7);
+  dm->DeallocatePage(7);
+  EXPECT_EQ(2, dm->GetNumFreePages());
+  EXPECT_FALSE(dm->IsAllocated(3));
+  EXPECT_TRUE(dm->IsAllocated(4));
+  EXPECT_EQ(3, dm->AllocatePage());
+  EXPECT_EQ(7, dm->AllocatePage());
+  EXPECT_EQ(0, dm->GetNumFreePages());
+  EXPECT_EQ(10, dm->AllocatePage());
+
+  // Scenario: an allocator of every other page skips the ids of the other one, which finds them free.
+  EXPECT_EQ(11, dm->AllocatePage(INVALID_PAGE_ID, 2, 1));
+  EXPECT_EQ(13, dm->AllocatePage(INVALID_PAGE_ID, 2, 1));
+  EXPECT_EQ(1, dm->GetNumFreePages());
+  EXPECT_EQ(12, dm->AllocatePage(INVALID_PAGE_ID, 2, 0));
+  EXPECT_EQ(14, dm->AllocatePage(INVALID_PAGE_ID, 2, 0));
+
+  // Scenario: the bitmap survives a restart, and pages keep their data around it.
+  dm->DeallocatePage(5);
+  std::memset(data, 'z', PAGE_SIZE);
+  dm->WritePage(14, data);
+  dm->ShutDown();
+  dm = std::make_unique<DiskManager>(db_file);
+  EXPECT_EQ(1, dm->GetNumFreePages());
+  EXPECT_FALSE(dm->IsAllocated(5));
+  EXPECT_TRUE(dm->IsAllocated(14));
+  for (page_id_t page_id : {0, 4, 9}) {
+    dm->ReadPage(page_id, buf);
+    EXPECT_EQ(std::string(PAGE_DATA_SIZE, 'a' + page_id), std::string(buf, PAGE_DATA_SIZE));
+  }
+  EXPECT_EQ(5, dm->AllocatePage());
+  EXPECT_EQ(15, dm->AllocatePage());
+
+  // Scenario: pages on both sides of the second bitmap page keep their data.
+  for (page_id_t page_id : {16319, 16320}) {
+    std::memset(data, page_id % 2 == 0 ? 'e' : 'o', PAGE_SIZE);
+    dm->WritePage(page_id, data);
+  }
+  for (page_id_t page_id : {16319, 16320}) {
+    EXPECT_TRUE(dm->ReadPage(page_id, buf));
+    EXPECT_EQ(std::string(PAGE_DATA_SIZE, page_id % 2 == 0 ? 'e' : 'o'), std::string(buf, PAGE_DATA_SIZE));
+  }
+  dm->ShutDown();
+  dm = std::make_unique<DiskManager>(db_file);
+  EXPECT_TRUE(dm->IsAllocated(16320));
+  EXPECT_EQ(16321, dm->AllocatePage());
+
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ExtentAllocationTest) {
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  const auto extent_size = static_cast<page_id_t>(EXTENT_SIZE);
+
+  // Scenario: two tables that grow in turns each get extents of their own, so that their pages are adjacent.
+  std::vector<page_id_t> pages[2] = {{dm.AllocatePage()}, {dm.AllocatePage()}};
+  for (int i = 0; i < 2 * extent_size + 1; ++i) {
+    for (auto &table : pages) {
+      table.push_back(dm.AllocatePage(table.back()));
+    }
+  }
+  for (auto &table : pages) {
+    int breaks = 0;
+    for (size_t i = 1; i < table.size(); ++i) {
+      breaks += table[i] == table[i - 1] + 1 ? 0 : 1;
+    }
+    // Into the first extent, and then into the next one whenever an extent fills up.
+    EXPECT_EQ(3, breaks);
+    EXPECT_EQ(0, table[1] % extent_size);
+  }
+
+  // Scenario: pages allocated without a hint fill the pages skipped to get to the first extent, and then the file grows
+  // past the six extents instead of taking the unused pages of the last two.
+  for (page_id_t page_id = 2; page_id < extent_size; ++page_id) {
+    EXPECT_EQ(page_id, dm.AllocatePage());
+  }
+  EXPECT_EQ(7 * extent_size, dm.AllocatePage());
+
+  // Scenario: the extents of a dropped table are reused whole by the next table that grows.
+  const page_id_t first_extent = pages[0][1];
+  for (page_id_t dropped : pages[0]) {
+    dm.DeallocatePage(dropped);
+  }
+  const page_id_t new_table = dm.AllocatePage();
+  EXPECT_EQ(pages[0][0], new_table);
+  EXPECT_EQ(first_extent, dm.AllocatePage(new_table));
+  EXPECT_EQ(first_extent + 1, dm.AllocatePage(first_extent));
+
+  // Scenario: an allocator of every other page gets extents of its own ids.
+  const page_id_t odd = dm.AllocatePage(INVALID_PAGE_ID, 2, 1);
+  page_id_t last = dm.AllocatePage(odd, 2, 1);
+  EXPECT_EQ(1, last % (2 * extent_size));
+  for (int i = 0; i < 10; ++i) {
+    const page_id_t next = dm.AllocatePage(last, 2, 1);
+    EXPECT_EQ(last + 2, next);
+    last = next;
+  }
 
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ExtentRestartTest) {
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = std::make_unique<DiskManager>(db_file);
+  const auto extent_size = static_cast<page_id_t>(EXTENT_SIZE);
+
+  // Scenario: two tables have grown a few pages into extents of their own, the second one at the end of the file.
+  std::vector<page_id_t> pages[2] = {{dm->AllocatePage()}, {dm->AllocatePage()}};
+  for (auto &table : pages) {
+    for (int i = 0; i < 3; ++i) {
+      table.push_back(dm->AllocatePage(table.back()));
+    }
+    for (page_id_t page_id : table) {
+      dm->WritePage(page_id, data);
+    }
+  }
+  EXPECT_EQ(extent_size, pages[0][1]);
+  EXPECT_EQ(2 * extent_size, pages[1][1]);
+
+  // Scenario: after a restart both tables keep filling their extents, and pages without a hint stay out of them.
+  dm->ShutDown();
+  dm = std::make_unique<DiskManager>(db_file);
+  for (auto &table : pages) {
+    EXPECT_EQ(table.back() + 1, dm->AllocatePage(table.back()));
+  }
+  for (page_id_t page_id = 2; page_id < extent_size; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+  }
+  EXPECT_EQ(3 * extent_size, dm->AllocatePage());
+
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_ConcurrentReadBenchmark) {
+  const int num_pages = 2048;
+  const int reads_per_thread = 20000;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::vector<char> data(static_cast<size_t>(num_pages) * PAGE_SIZE);
+  std::vector<std::pair<page_id_t, char *>> writes;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    char *page_data = data.data() + static_cast<size_t>(page_id) * PAGE_SIZE;
+    std::memcpy(page_data, &page_id, sizeof(page_id));
+    writes.emplace_back(page_id, page_data);
+  }
+  dm.WritePages(&writes);
+
+  // Random page reads from several threads at once. The file is in the page cache after the writes, so this measures
+  // how well reads at different offsets proceed in parallel rather than the disk.
+  printf("%8s %14s %10s\n", "threads", "reads/s", "speedup");
+  double single_thread = 0;
+  for (int num_threads : {1, 2, 4, 8}) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        std::mt19937 gen(tid);
+        char buf[PAGE_SIZE];
+        for (int i = 0; i < reads_per_thread; ++i) {
+          page_id_t page_id = static_cast<page_id_t>(gen() % num_pages);
+          dm.ReadPage(page_id, buf);
+          page_id_t stamp;
+          std::memcpy(&stamp, buf, sizeof(stamp));
+          EXPECT_EQ(page_id, stamp);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double reads_per_second = num_threads * reads_per_thread / elapsed.count();
+    if (num_threads == 1) {
+      single_thread = reads_per_second;
+    }
+    printf("%8d %14.0f %9.1fx\n", num_threads, reads_per_second, reads_per_second / single_thread);
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::string db_file("test.db");
+  auto dm = std::make_unique<DiskManager>(db_file);
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    std::memset(data, 'a' + page_id, PAGE_SIZE);
+    dm->WritePage(page_id, data);
+  }
+
+  // Scenario: a byte flipped on disk behind the back of the disk manager fails the read of its page only.
+  dm->ShutDown();
+  int fd = open(db_file.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  // Page 2 is the fourth page of the file, behind the first bitmap page.
+  char corrupt = 'X';
+  ASSERT_EQ(1, pwrite(fd, &corrupt, 1, 3 * PAGE_SIZE + 100));
+  close(fd);
+  dm = std::make_unique<DiskManager>(db_file);
+  EXPECT_FALSE(dm->ReadPage(2, buf));
+  EXPECT_EQ(1, dm->GetNumChecksumFailures());
+  for (page_id_t page_id : {0, 1, 3}) {
+    EXPECT_TRUE(dm->ReadPage(page_id, buf));
+    EXPECT_EQ(std::string(PAGE_DATA_SIZE, 'a' + page_id), std::string(buf, PAGE_DATA_SIZE));
+  }
+
+  // Scenario: a page that was never written reads as zeros without failing, whether past the end of the file or in a
+  // hole of it.
+  EXPECT_TRUE(dm->ReadPage(100, buf));
+  dm->WritePage(200, data);
+  EXPECT_TRUE(dm->ReadPage(100, buf));
+  EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(buf, PAGE_SIZE));
+
+  // Scenario: a page written to the slot of another page fails, as a misdirected write would.
+  fd = open(db_file.c_str(), O_RDWR);
+  ASSERT_EQ(PAGE_SIZE, pread(fd, buf, PAGE_SIZE, 2 * PAGE_SIZE));
+  ASSERT_EQ(PAGE_SIZE, pwrite(fd, buf, PAGE_SIZE, 5 * PAGE_SIZE));
+  close(fd);
+  EXPECT_FALSE(dm->ReadPage(4, buf));
+  EXPECT_EQ(2, dm->GetNumChecksumFailures());
+
+  // Scenario: the buffer pool does not hand out a page that fails its checksum, and keeps working.
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(2, dm.get());
+  EXPECT_EQ(nullptr, bpm->FetchPage(2));
+  std::vector<Page *> pages = bpm->FetchPages({3, 2});
+  EXPECT_NE(nullptr, pages[0]);
+  EXPECT_EQ(nullptr, pages[1]);
+  bpm->UnpinPage(3, false);
+  for (page_id_t page_id : {0, 1}) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ('a' + page_id, page->GetData()[0]);
+  }
+  bpm.reset();
+
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  std::string db_file("test.db");
+  disk_manager_direct_io = true;
+  auto dm = DiskManager(db_file);
+  disk_manager_direct_io = false;
+  // The test runs on a file system that supports O_DIRECT, not on tmpfs.
+  EXPECT_TRUE(dm.UsesDirectIo());
+
+  // Scenario: aligned buffers are transferred as they are, and unaligned ones are copied through an aligned buffer.
+  std::unique_ptr<char, decltype(&std::free)> aligned(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, 3 * PAGE_SIZE)),
+                                                      &std::free);
+  std::vector<char> unaligned(3 * PAGE_SIZE + 1);
+  for (char *data : {aligned.get(), unaligned.data() + 1}) {
+    for (int i = 0; i < 3; ++i) {
+      std::memset(data + i * PAGE_SIZE, 'a' + i, PAGE_SIZE);
+    }
+    int bounced_before = dm.GetNumBouncedWrites();
+    dm.WritePage(0, data);
+    std::vector<std::pair<page_id_t, char *>> writes = {{2, data + PAGE_SIZE}, {1, data + 2 * PAGE_SIZE}};
+    dm.WritePages(&writes);
+    EXPECT_EQ(data == aligned.get() ? bounced_before : bounced_before + 2, dm.GetNumBouncedWrites());
+    std::memset(data, 0, 3 * PAGE_SIZE);
+    for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+      dm.ReadPage(page_id, data + page_id * PAGE_SIZE);
+    }
+    for (char expected : {'a', 'c', 'b'}) {
+      EXPECT_EQ(std::string(PAGE_DATA_SIZE, expected), std::string(data, PAGE_DATA_SIZE));
+      data += PAGE_SIZE;
+    }
+  }
+
+  // Scenario: reading past the end of the file still yields zeros.
+  std::memset(aligned.get(), 1, PAGE_SIZE);
+  dm.ReadPage(10, aligned.get());
+  EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(aligned.get(), PAGE_SIZE));
+
+  // Scenario: the pages do not linger in the page cache.
+  EXPECT_EQ(0, CachedPages(db_file, 3));
+
+  dm.ShutDown();
+}
+
+TEST_F(DiskManagerTest, DISABLED_DirectIoBenchmark) {
+  const size_t num_pages = 16384;
+  const size_t buffer_pool_size = 1024;
+  const int num_fetches = 10000;
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    std::vector<char> data(PAGE_SIZE * 256);
+    for (page_id_t begin = 0; begin < static_cast<page_id_t>(num_pages); begin += 256) {
+      std::vector<std::pair<page_id_t, char *>> writes;
+      for (page_id_t page_id = begin; page_id < begin + 256; ++page_id) {
+        writes.emplace_back(page_id, data.data() + (page_id - begin) * PAGE_SIZE);
+      }
+      dm.WritePages(&writes);
+    }
+    dm.ShutDown();
+  }
+
+  // Random fetches through a buffer pool sixteen times smaller than the data. The data is dropped from the page cache
+  // first, so every miss goes to the device, as it would for data larger than memory. The footprint is the buffer pool
+  // plus the pages of the file that the kernel caches besides; with a dataset larger than memory, the cached copies
+  // crowd out other hot data.
+  printf("%8s %14s %14s %14s %14s\n", "mode", "miss mean us", "miss p99 us", "cached pages", "footprint MB");
+  size_t cached_pages[2];
+  for (bool direct_io : {false, true}) {
+    DropCachedPages(db_file);
+    disk_manager_direct_io = direct_io;
+    auto dm = DiskManager(db_file);
+    disk_manager_direct_io = false;
+    auto bpm = BufferPoolManagerInstance(buffer_pool_size, &dm);
+    std::mt19937 gen(0);
+    for (int i = 0; i < num_fetches; ++i) {
+      page_id_t page_id = static_cast<page_id_t>(gen() % num_pages);
+      ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+      bpm.UnpinPage(page_id, false);
+    }
+    BufferPoolStatsSnapshot stats = bpm.GetStats();
+    cached_pages[direct_io] = CachedPages(db_file, num_pages);
+    printf("%8s %14.1f %14.1f %14zu %14.1f\n", dm.UsesDirectIo() ? "direct" : "buffered",
+           stats.fetch_miss_latency_.MeanNs() / 1000, stats.fetch_miss_latency_.PercentileNs(0.99) / 1000.0,
+           cached_pages[direct_io], (buffer_pool_size + cached_pages[direct_io]) * PAGE_SIZE / 1048576.0);
+    dm.ShutDown();
+  }
+  // Without the page cache, a page is held once, in the buffer pool.
+  EXPECT_LT(cached_pages[1], cached_pages[0]);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::TestWithParam<bool> {
+ protected:
+  // Every test runs once with io_uring and once with the thread pool.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    disk_scheduler_io_uring = GetParam();
+  }
+
+  void TearDown() override {
+    disk_scheduler_io_uring = true;
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  DiskManager dm("test.db");
+  auto scheduler = std::make_unique<DiskScheduler>(&dm);
+  if (!GetParam()) {
+    EXPECT_FALSE(scheduler->UsesIoUring());
+  }
+
+  // Scenario: a page written through the scheduler reads back intact.
+  std::strncpy(data, "A test string.", sizeof(data));
+  auto promise1 = DiskScheduler::CreatePromise();
+  auto future1 = promise1.get_future();
+  auto promise2 = DiskScheduler::CreatePromise();
+  auto future2 = promise2.get_future();
+  scheduler->Schedule({true, data, 0, std::move(promise1)});
+  ASSERT_TRUE(future1.get());
+  scheduler->Schedule({false, buf, 0, std::move(promise2)});
+  ASSERT_TRUE(future2.get());
+  EXPECT_EQ(0, std::memcmp(buf, data, PAGE_DATA_SIZE));
+
+  // Scenario: a page past the end of the file reads as zeros.
+  std::memset(buf, 1, sizeof(buf));
+  auto promise3 = DiskScheduler::CreatePromise();
+  auto future3 = promise3.get_future();
+  scheduler->Schedule({false, buf, 100, std::move(promise3)});
+  ASSERT_TRUE(future3.get());
+  EXPECT_EQ(0, std::memcmp(buf, std::vector<char>(PAGE_SIZE, 0).data(), sizeof(buf)));
+
+  // Scenario: a batch of writes goes out as one vectored write per run of adjacent pages.
+  std::vector<char> pages(6 * PAGE_SIZE);
+  std::vector<std::pair<page_id_t, char *>> writes;
+  for (page_id_t page_id : {5, 1, 3, 2, 6, 7}) {
+    char *page_data = pages.data() + writes.size() * PAGE_SIZE;
+    snprintf(page_data, PAGE_SIZE, "page %d", page_id);
+    writes.emplace_back(page_id, page_data);
+  }
+  int writes_before = dm.GetNumWrites();
+  int write_calls_before = dm.GetNumWriteCalls();
+  ASSERT_TRUE(scheduler->ScheduleWrites(&writes).get());
+  EXPECT_EQ(writes_before + 6, dm.GetNumWrites());
+  EXPECT_EQ(write_calls_before + 2, dm.GetNumWriteCalls());
+  std::vector<DiskRequest> reads;
+  std::vector<std::future<bool>> done;
+  std::vector<char> read_back(6 * PAGE_SIZE);
+  for (page_id_t page_id = 1; page_id <= 7; ++page_id) {
+    if (page_id != 4) {
+      reads.push_back({false, read_back.data() + done.size() * PAGE_SIZE, page_id, DiskScheduler::CreatePromise()});
+      done.push_back(reads.back().callback_.get_future());
+    }
+  }
+  scheduler->Schedule(&reads);
+  for (size_t i = 0; i < done.size(); ++i) {
+    ASSERT_TRUE(done[i].get());
+    EXPECT_STREQ(writes[i].second, read_back.data() + i * PAGE_SIZE);
+  }
+
+  // Scenario: the scheduler finishes what is in flight before it goes away.
+  auto promise4 = DiskScheduler::CreatePromise();
+  auto future4 = promise4.get_future();
+  scheduler->Schedule({true, data, 9, std::move(promise4)});
+  scheduler.reset();
+  EXPECT_EQ(std::future_status::ready, future4.wait_for(std::chrono::seconds(0)));
+  EXPECT_TRUE(future4.get());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, QueueDepthTest) {
+  const int num_pages = 64;
+  const size_t depth = 4;
+  DiskManager dm("test.db");
+  std::vector<char> data(static_cast<size_t>(num_pages) * PAGE_SIZE);
+  std::vector<std::pair<page_id_t, char *>> writes;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    char *page_data = data.data() + static_cast<size_t>(page_id) * PAGE_SIZE;
+    std::memcpy(page_data, &page_id, sizeof(page_id));
+    writes.emplace_back(page_id, page_data);
+  }
+  dm.WritePages(&writes);
+
+  // Scenario: a batch larger than the queue depth is read back intact, with no more than depth reads in flight.
+  DiskScheduler scheduler(&dm, depth);
+  std::vector<char> bufs(static_cast<size_t>(num_pages) * PAGE_SIZE);
+  std::vector<DiskRequest> reads;
+  std::vector<std::future<bool>> done;
+  for (page_id_t page_id = num_pages - 1; page_id >= 0; --page_id) {
+    reads.push_back({false, bufs.data() + static_cast<size_t>(page_id) * PAGE_SIZE, page_id,
+                     DiskScheduler::CreatePromise()});
+    done.push_back(reads.back().callback_.get_future());
+  }
+  scheduler.Schedule(&reads);
+  for (auto &read : done) {
+    ASSERT_TRUE(read.get());
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    page_id_t stamp;
+    std::memcpy(&stamp, bufs.data() + static_cast<size_t>(page_id) * PAGE_SIZE, sizeof(stamp));
+    EXPECT_EQ(page_id, stamp);
+  }
+  EXPECT_LE(scheduler.GetMaxInFlight(), depth);
+
+  dm.ShutDown();
+}
+
+TEST_P(DiskSchedulerTest, DISABLED_QueueDepthBenchmark) {
+  const int num_pages = 2048;
+  const int num_reads = 20000;
+  DiskManager dm("test.db");
+  std::vector<char> data(static_cast<size_t>(num_pages) * PAGE_SIZE);
+  std::vector<std::pair<page_id_t, char *>> writes;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    char *page_data = data.data() + static_cast<size_t>(page_id) * PAGE_SIZE;
+    std::memcpy(page_data, &page_id, sizeof(page_id));
+    writes.emplace_back(page_id, page_data);
+  }
+  dm.WritePages(&writes);
+
+  // Random page reads submitted from one thread in batches as large as the queue depth. The file is in the page cache
+  // after the writes, so this measures the overhead of the scheduler more than the disk, which only a device that
+  // needs a deep queue rewards.
+  printf("%8s %8s %14s %10s\n", "backend", "depth", "reads/s", "in flight");
+  for (size_t depth : {static_cast<size_t>(1), DISK_SCHEDULER_QUEUE_DEPTH}) {
+    DiskScheduler scheduler(&dm, depth);
+    std::mt19937 gen(0);
+    std::vector<char> bufs(depth * PAGE_SIZE);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_reads; i += static_cast<int>(depth)) {
+      std::vector<DiskRequest> reads;
+      std::vector<std::future<bool>> done;
+      std::vector<page_id_t> page_ids;
+      for (size_t j = 0; j < depth; ++j) {
+        page_ids.push_back(static_cast<page_id_t>(gen() % num_pages));
+        reads.push_back({false, bufs.data() + j * PAGE_SIZE, page_ids.back(), DiskScheduler::CreatePromise()});
+        done.push_back(reads.back().callback_.get_future());
+      }
+      scheduler.Schedule(&reads);
+      for (size_t j = 0; j < depth; ++j) {
+        ASSERT_TRUE(done[j].get());
+        page_id_t stamp;
+        std::memcpy(&stamp, bufs.data() + j * PAGE_SIZE, sizeof(stamp));
+        EXPECT_EQ(page_ids[j], stamp);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%8s %8zu %14.0f %10zu\n", scheduler.UsesIoUring() ? "io_uring" : "threads", depth,
+           num_reads / elapsed.count(), scheduler.GetMaxInFlight());
+  }
+
+  dm.ShutDown();
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, DiskSchedulerTest, ::testing::Bool());
+
+}  // namespace bustub
@@ -0,0 +1,217 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/lock_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** A tuple of about 1000 bytes, so that four fit in a page. */
+Tuple MakeTuple(const Schema &schema, int i) {
+  return Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(900, 'x'))}, &schema);
+}
+
+}  // namespace
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, txn);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 1000)});
+
+  // Scenario: an insert into a table of hundreds of pages goes straight to the last page, instead of fetching every
+  // page before it.
+  std::vector<RID> rids(800);
+  for (int i = 0; i < 400; ++i) {
+    ASSERT_TRUE(table->InsertTuple(MakeTuple(schema, i), &rids[i], txn));
+  }
+  bpm->ResetStats();
+  for (int i = 400; i < 800; ++i) {
+    ASSERT_TRUE(table->InsertTuple(MakeTuple(schema, i), &rids[i], txn));
+  }
+  BufferPoolStatsSnapshot stats = bpm->GetStats();
+  EXPECT_LE(stats.hits_ + stats.misses_, 4 * 400);
+  EXPECT_GE(rids[799].GetPageId() - rids[0].GetPageId(), 190);
+
+  // Scenario: a deleted tuple leaves room that the next insert fills.
+  ASSERT_TRUE(table->MarkDelete(rids[5], txn));
+  table->ApplyDelete(rids[5], txn);
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(MakeTuple(schema, 5), &rid, txn));
+  EXPECT_EQ(rids[5].GetPageId(), rid.GetPageId());
+
+  // Scenario: a table opened with its free space map, or without it after a crash, finds the room that a delete left.
+  const page_id_t first_page_id = table->GetFirstPageId();
+  const page_id_t free_space_map_page_id = table->GetFreeSpaceMapPageId();
+  for (page_id_t map_page_id : {free_space_map_page_id, INVALID_PAGE_ID}) {
+    const page_id_t page_id = rids[100].GetPageId();
+    ASSERT_TRUE(table->MarkDelete(rids[100], txn));
+    table->ApplyDelete(rids[100], txn);
+    delete table;
+    table = new TableHeap(bpm, lock_manager, nullptr, first_page_id, map_page_id);
+    ASSERT_TRUE(table->InsertTuple(MakeTuple(schema, 100), &rids[100], txn));
+    EXPECT_EQ(page_id, rids[100].GetPageId());
+  }
+
+  // Scenario: a map that lost the pages added last, like one that was not written back before a crash, does not make
+  // the next page that is added replace them.
+  size_t num_tuples = 0;
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    num_tuples++;
+  }
+  TableFreeSpaceMap stale_map(bpm);
+  ASSERT_TRUE(stale_map.AddTablePage(first_page_id, 0));
+  delete table;
+  table = new TableHeap(bpm, lock_manager, nullptr, first_page_id, stale_map.GetFirstPageId());
+  ASSERT_TRUE(table->InsertTuple(MakeTuple(schema, 800), &rid, txn));
+  EXPECT_GT(rid.GetPageId(), rids[799].GetPageId());
+  size_t num_tuples_after = 0;
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    num_tuples_after++;
+  }
+  EXPECT_EQ(num_tuples + 1, num_tuples_after);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete table;
+  delete txn;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(TableHeapTest, FreeSpaceBucketTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, txn);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 100)});
+
+  // Scenario: small inserts write the free space map only when they move their page to another bucket. Each insert
+  // reads a map page and the table page, and a few in a bucket also write the map page.
+  const int num_tuples = 60;
+  bpm->ResetStats();
+  for (int i = 0; i < num_tuples; ++i) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(8, 'x'))}, &schema);
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, txn));
+    EXPECT_EQ(table->GetFirstPageId(), rid.GetPageId());
+  }
+  BufferPoolStatsSnapshot stats = bpm->GetStats();
+  EXPECT_LE(stats.hits_ + stats.misses_, 2 * num_tuples + num_tuples / 3);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete table;
+  delete txn;
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(TableHeapTest, ExtentTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *txn = new Transaction(0);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 1000)});
+
+  // Scenario: two tables filled in turns each lie in extents of their own, so that a scan of one of them moves to the
+  // adjacent page almost every time.
+  TableHeap tables[2] = {{bpm, nullptr, nullptr, txn}, {bpm, nullptr, nullptr, txn}};
+  for (int i = 0; i < 400; ++i) {
+    for (auto &table : tables) {
+      RID rid;
+      ASSERT_TRUE(table.InsertTuple(MakeTuple(schema, i), &rid, txn));
+    }
+  }
+  for (auto &table : tables) {
+    std::vector<page_id_t> page_ids;
+    for (auto it = table.Begin(txn); it != table.End(); ++it) {
+      if (page_ids.empty() || page_ids.back() != it->GetRid().GetPageId()) {
+        page_ids.push_back(it->GetRid().GetPageId());
+      }
+    }
+    EXPECT_EQ(100, page_ids.size());
+    int breaks = 0;
+    for (size_t i = 1; i < page_ids.size(); ++i) {
+      breaks += page_ids[i] == page_ids[i - 1] + 1 ? 0 : 1;
+    }
+    // From the first page into the first extent, and into the second one.
+    EXPECT_EQ(2, breaks);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete txn;
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(TableHeapTest, ConcurrentInsertTest) {
+  // Scenario: concurrent inserters each get their tuples in, and a scan sees every one of them once.
+  const std::string db_name = "test.db";
+  const int num_threads = 8;
+  const int tuples_per_thread = 200;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, txn);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 1000)});
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      Transaction thread_txn(tid + 1);
+      for (int i = 0; i < tuples_per_thread; ++i) {
+        RID rid;
+        EXPECT_TRUE(table->InsertTuple(MakeTuple(schema, tid * tuples_per_thread + i), &rid, &thread_txn));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<int> values;
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    EXPECT_TRUE(values.insert(it->GetValue(&schema, 0).GetAs<int32_t>()).second);
+  }
+  EXPECT_EQ(num_threads * tuples_per_thread, values.size());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete table;
+  delete txn;
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub